@@ -0,0 +1,45 @@
+import gzip
+import os
+import zlib
+
+
+WEB_UI_SOURCE = os.path.join("web", "index.html")
+WEB_UI_HEADER = os.path.join("src", "web_ui.h")
+
+
+def compress_web_ui(path):
+    with open(path, "rb") as f:
+        html = f.read()
+    # mtime=0 keeps the output byte-identical between builds of the same page
+    return html, gzip.compress(html, compresslevel=9, mtime=0)
+
+
+def generate_web_ui_header(html, compressed):
+    content_hash = "%08x" % (zlib.crc32(html) & 0xFFFFFFFF)
+    rows = []
+    for i in range(0, len(compressed), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in compressed[i:i + 16]) + ",")
+
+    header_content = f'''#ifndef WEB_UI_H
+#define WEB_UI_H
+
+// Generated by embed_web_ui.py from {WEB_UI_SOURCE.replace(os.sep, "/")} - do not edit.
+
+#include <Arduino.h>
+
+#define WEB_UI_CONTENT_HASH "{content_hash}"
+
+const size_t WEB_UI_GZ_LEN = {len(compressed)};
+const uint8_t WEB_UI_GZ[] PROGMEM = {{
+{chr(10).join(rows)}
+}};
+
+#endif // WEB_UI_H
+'''
+    with open(WEB_UI_HEADER, "w") as f:
+        f.write(header_content)
+
+
+html, compressed = compress_web_ui(WEB_UI_SOURCE)
+print(f"web ui: {len(html)} bytes, {len(compressed)} bytes gzipped")
+generate_web_ui_header(html, compressed)
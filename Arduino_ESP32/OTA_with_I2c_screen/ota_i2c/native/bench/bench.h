@@ -0,0 +1,46 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdio>
+
+// Tiny benchmark registry for the native build. Each bench_*.cpp registers
+// cases with BENCH_CASE; bench_main runs all of them or those whose name
+// contains the filter given on the command line.
+namespace Bench {
+    typedef void (*CaseFunc)();
+
+    // Directory given with -d for cases that write images or logs; nullptr
+    // when none was given
+    const char* dumpDir();
+
+    struct Registrar {
+        Registrar(const char* name, CaseFunc fn);
+    };
+
+    // Host wall-clock time of fn() averaged over iterations, in nanoseconds.
+    template<typename F>
+    double timeNs(unsigned long iterations, F&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    // Prints "  <label>: <ns> ns/op" in the common report format.
+    template<typename F>
+    double measure(const char* label, unsigned long iterations, F&& fn) {
+        double ns = timeNs(iterations, fn);
+        printf("  %-40s %12.1f ns/op\n", label, ns);
+        return ns;
+    }
+}
+
+#define BENCH_CASE(name) \
+    static void bench_##name(); \
+    static Bench::Registrar bench_registrar_##name(#name, bench_##name); \
+    static void bench_##name()
+
+#endif // BENCH_H
@@ -0,0 +1,69 @@
+#include <Arduino.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "motion_controller.h"
+#include "pin_manager.h"
+#include "server_manager.h"
+#include "stepper_manager.h"
+
+// Server-side cost of one stepper command over REST vs. the /ws command
+// channel: request parsing, posting to the motion mailbox, applying it (the
+// motion task's poll(), run inline here) and the response/ack. Network
+// round trips (TCP handshake per POST vs. one frame on an open socket) are
+// not part of this number; measure them on hardware with tools/ws_latency.py.
+
+BENCH_CASE(command_latency) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    MotionController motion(stepper);
+    PinManager pinManager(display);
+    ControlSignalHandler signals(display, stepper);
+    HomingSequence homing(motion, signals);
+    ServerManager server(display, motion, pinManager, signals, homing);
+    stepper.init();
+    server.init();
+    AsyncWebSocketClient* client = server.webSocket().connect();
+    client->keepFrames(false);
+
+    const unsigned long commands = 20000;
+    size_t restBytes = 0;
+    long position = 0;
+
+    Bench::measure("REST POST /stepper/move", commands, [&] {
+        AsyncWebServerRequest request(HTTP_POST, "/stepper/move");
+        request.addParam("position", String(++position));
+        server.dispatch(request);
+        motion.poll();
+        restBytes = request.response()->content().size();
+    });
+    printf("  %-40s %12zu bytes\n", "  response body", restBytes);
+
+    Bench::measure("REST POST /stepper/speed", commands, [&] {
+        AsyncWebServerRequest request(HTTP_POST, "/stepper/speed");
+        request.addParam("speed", String(4000 + (++position & 1023)));
+        server.dispatch(request);
+        motion.poll();
+    });
+
+    char message[96];
+    unsigned long id = 0;
+    unsigned long long before = client->bytesSent();
+    Bench::measure("WS {\"cmd\":\"move\"} with ack", commands, [&] {
+        snprintf(message, sizeof(message), "{\"id\":%lu,\"cmd\":\"move\",\"position\":%ld}", ++id, ++position);
+        server.webSocket().receiveText(client, message);
+        motion.poll();
+    });
+    printf("  %-40s %12.1f bytes\n", "  ack frame", (double)(client->bytesSent() - before) / commands);
+
+    Bench::measure("WS {\"cmd\":\"speed\"} fire-and-forget", commands, [&] {
+        snprintf(message, sizeof(message), "{\"cmd\":\"speed\",\"speed\":%ld}", 4000 + (++position & 1023));
+        server.webSocket().receiveText(client, message);
+        motion.poll();
+    });
+
+    Bench::measure("WS jog/jogStop pair", commands / 2, [&] {
+        server.webSocket().receiveText(client, "{\"id\":1,\"cmd\":\"jog\",\"dir\":1}");
+        server.webSocket().receiveText(client, "{\"id\":2,\"cmd\":\"jogStop\"}");
+        motion.poll();
+    });
+}
@@ -0,0 +1,445 @@
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <esp_partition.h>
+#include "bench.h"
+#include "config_schema.h"
+#include "config_store.h"
+#include "display_manager.h"
+#include "flash_controller.h"
+#include "homing_sequence.h"
+#include "led_control.h"
+#include "motion_controller.h"
+#include "pin_manager.h"
+#include "server_manager.h"
+#include "stepper_manager.h"
+
+// Settings writes through ConfigStore, each flushed at once, against the
+// EEPROM commit they replace. "busy" is the time the flash chip would have been busy, from the
+// datasheet-typical figures in esp_partition.h; a sector switch includes a
+// 45 ms erase, so the maximum is what a caller waits for once every
+// sector-full of writes.
+//
+// The power-cut test replays one fixed sequence of writes with the power
+// failing after every possible number of programmed bytes (an erase counts
+// as one byte per erased byte), remounts the partition and checks that every
+// value reads back as last written, except the write that was in progress,
+// which must read back either entirely old or entirely new. A second write
+// and remount after recovery checks that the log is still usable.
+//
+// config_write_behind drives the web handlers through ten seconds of
+// settings changes (a burst of pin-form saves, an LED pin change together
+// with another setting, then an LED pin change every 100 ms) with the ota task's
+// FlashController::service() every 50 ms, against flushing after every
+// change. "handler stall" is flash busy time inside the handlers.
+
+namespace {
+    struct Write {
+        uint16_t address;
+        uint8_t length;
+        uint8_t data[32];
+    };
+
+    // A mix of the writes the firmware makes: LED pin, pin set, homing
+    // section, each with the header it reseals
+    std::vector<Write> makeWorkload(size_t count) {
+        const struct { uint16_t address; uint8_t length; } FIELDS[] = {
+            {0, ConfigSchema::LedPin::OFFSET + ConfigSchema::LedPin::SIZE},
+            {0, ConfigSchema::Pins::OFFSET + ConfigSchema::Pins::SIZE},
+            {0, ConfigSchema::Homing::OFFSET + ConfigSchema::Homing::SIZE},
+            {100, 4},
+        };
+        std::vector<Write> writes(count);
+        for (Write& w : writes) {
+            const auto& field = FIELDS[rand() % 4];
+            w.address = field.address;
+            w.length = field.length;
+            for (uint8_t& b : w.data) b = rand();
+        }
+        return writes;
+    }
+
+    unsigned long long flashWork(const NativeFlash::Stats& s) {
+        return s.bytesProgrammed + (unsigned long long)s.erases * SPI_FLASH_SEC_SIZE;
+    }
+
+    bool imageMatches(const ConfigStore& store, const uint8_t* expected) {
+        uint8_t image[ConfigStore::IMAGE_SIZE];
+        return store.read(0, image, sizeof(image)) && memcmp(image, expected, sizeof(image)) == 0;
+    }
+}
+
+BENCH_CASE(config_store_write) {
+    const unsigned long WRITES = 5000;
+
+    // What FlashController::write<int32_t>() did before: put + commit of the whole image
+    EEPROM.begin(FlashController::TOTAL_FLASH_SIZE);
+    EEPROM.resetStats();
+    int32_t value = 0;
+    Bench::measure("EEPROM put() + commit()", WRITES, [&] {
+        EEPROM.put(100, ++value);
+        EEPROM.commit();
+    });
+    printf("  %-40s %12.1f bytes/write\n", "  image committed", (double)EEPROM.bytesCommitted() / WRITES);
+
+    NativeFlash::reset();
+    ConfigStore store;
+    store.begin();
+    NativeFlash::resetStats();
+    unsigned long long maxBusy = 0, busyBefore = 0;
+    Bench::measure("ConfigStore::write() + flush(), int32_t", WRITES, [&] {
+        ++value;
+        store.write(100, &value, sizeof(value));
+        store.flush();
+        unsigned long long busy = NativeFlash::stats().busyUs;
+        if (busy - busyBefore > maxBusy) maxBusy = busy - busyBefore;
+        busyBefore = busy;
+    });
+    NativeFlash::Stats flash = NativeFlash::stats();
+    ConfigStore::Stats stats = store.getStats();
+    printf("  %-40s %12.1f bytes/write\n", "  programmed", (double)flash.bytesProgrammed / WRITES);
+    printf("  %-40s %12.1f us/write (max %llu)\n", "  busy", (double)flash.busyUs / WRITES, maxBusy);
+    printf("  %-40s %12lu (%lu writes per erase)\n", "  sector erases", flash.erases,
+           flash.erases ? WRITES / flash.erases : 0);
+    printf("  %-40s %12lu (%lu sectors)\n", "  most erased sector", flash.maxSectorErases,
+           (unsigned long)(0x10000 / SPI_FLASH_SEC_SIZE));
+    printf("  %-40s %12u\n", "  compactions", (unsigned)stats.compactions);
+
+    Bench::measure("ConfigStore::write(), unchanged", WRITES, [&] {
+        store.write(100, &value, sizeof(value));
+    });
+    Bench::measure("ConfigStore::write(), staged only", WRITES, [&] {
+        ++value;
+        store.write(100, &value, sizeof(value));
+    });
+    store.flush();
+    Bench::measure("Transaction, 7 x stage() + commit()", WRITES, [&] {
+        ConfigStore::Transaction transaction(store);
+        for (int i = 0; i < 7; i++) transaction.stage(ConfigSchema::Pins::OFFSET + i, (int8_t)(value + i));
+        transaction.commit();
+        ++value;
+    });
+    store.flush();
+    int32_t readBack;
+    Bench::measure("ConfigStore::read(), int32_t", WRITES * 10, [&] {
+        store.read(100, &readBack, sizeof(readBack));
+    });
+
+    NativeFlash::resetStats();
+    Bench::measure("remount (begin())", 100, [&] {
+        ConfigStore mounted;
+        mounted.begin();
+    });
+}
+
+BENCH_CASE(config_store_power_cut) {
+    const size_t WRITES = 600;
+    srand(20);
+    std::vector<Write> workload = makeWorkload(WRITES);
+
+    // Flash work of the whole sequence after the initial format
+    NativeFlash::reset();
+    {
+        ConfigStore store;
+        store.begin();
+        NativeFlash::resetStats();
+        for (const Write& w : workload) store.write(w.address, w.data, w.length) && store.flush();
+    }
+    unsigned long long total = flashWork(NativeFlash::stats());
+
+    unsigned long cuts = 0, landed = 0, lost = 0, inErase = 0, mismatches = 0, unusable = 0;
+    for (unsigned long long cut = 0; cut < total; cut++) {
+        NativeFlash::reset();
+        uint8_t committed[ConfigStore::IMAGE_SIZE];
+        memset(committed, 0xFF, sizeof(committed));
+        const Write* inFlight = nullptr;
+        {
+            ConfigStore store;
+            store.begin();
+            NativeFlash::resetStats();
+            NativeFlash::cutPowerAfter(cut);
+            for (const Write& w : workload) {
+                if (!store.write(w.address, w.data, w.length) || !store.flush()) {
+                    inFlight = &w;
+                    break;
+                }
+                memcpy(committed + w.address, w.data, w.length);
+            }
+        }
+        if (!inFlight) continue;
+        cuts++;
+        if (flashWork(NativeFlash::stats()) < cut) inErase++;  // A cut erase is not counted, a cut program is
+        NativeFlash::restorePower();
+
+        // Reboot
+        ConfigStore store;
+        if (!store.begin()) {
+            unusable++;
+            continue;
+        }
+        uint8_t image[ConfigStore::IMAGE_SIZE];
+        store.read(0, image, sizeof(image));
+        size_t from = inFlight->address, to = inFlight->address + inFlight->length;
+        bool ok = memcmp(image, committed, from) == 0 &&
+                  memcmp(image + to, committed + to, sizeof(image) - to) == 0;
+        if (memcmp(image + from, inFlight->data, inFlight->length) == 0) {
+            landed++;
+            memcpy(committed + from, inFlight->data, inFlight->length);
+        } else if (memcmp(image + from, committed + from, inFlight->length) == 0) {
+            lost++;
+        } else {
+            ok = false;
+        }
+
+        // The recovered log takes further writes
+        uint8_t marker[4] = {(uint8_t)cut, (uint8_t)(cut >> 8), (uint8_t)(cut >> 16), 0x5A};
+        if (!store.write(100, marker, sizeof(marker)) || !store.flush()) ok = false;
+        memcpy(committed + 100, marker, sizeof(marker));
+        ConfigStore again;
+        if (!again.begin() || !imageMatches(again, committed)) ok = false;
+
+        if (!ok) {
+            mismatches++;
+            if (mismatches <= 5) printf("  MISMATCH after a cut at byte %llu\n", cut);
+        }
+    }
+
+    printf("  %zu writes, %llu bytes of flash work, power cut after each of them\n", WRITES, total);
+    printf("  %-40s %12lu\n", "cuts during a write", cuts);
+    printf("  %-40s %12lu\n", "  of which inside an erase", inErase);
+    printf("  %-40s %12lu\n", "in-flight write kept", landed);
+    printf("  %-40s %12lu\n", "in-flight write rolled back", lost);
+    printf("  %-40s %12lu\n", "unmountable", unusable);
+    printf("  %-40s %12lu%s\n", "mismatches", mismatches, mismatches ? "  MISMATCH" : "");
+}
+
+BENCH_CASE(config_write_behind) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    MotionController motion(stepper);
+    PinManager pinManager(display);
+    ControlSignalHandler signals(display, stepper);
+    HomingSequence homing(motion, signals);
+    ServerManager server(display, motion, pinManager, signals, homing);
+    FlashController::init();
+    stepper.init();
+    server.init();
+
+    const char* MODES[] = {"flush per change", "write-behind"};
+    printf("  %-18s %8s %8s %10s %8s %14s\n", "", "changes", "commits", "programmed", "erases", "handler stall");
+    for (int mode = 0; mode < 2; mode++) {
+        bool writeBehind = mode == 1;
+        FlashController::flush();
+        NativeFlash::resetStats();
+        ConfigStore::Stats before = FlashController::store().getStats();
+        unsigned long changes = 0;
+        unsigned long long stallUs = 0;
+        int8_t ledPin = 2;
+
+        auto change = [&](auto&& apply) {
+            unsigned long long busy = NativeFlash::stats().busyUs;
+            apply();
+            if (!writeBehind) FlashController::flush();  // What every save used to cost its caller
+            stallUs += NativeFlash::stats().busyUs - busy;
+            changes++;
+        };
+        auto postLedPin = [&] {
+            AsyncWebServerRequest request(HTTP_POST, "/led/pin");
+            ledPin = ledPin % 30 + 2;
+            request.addParam("pin", String((int)ledPin));
+            server.dispatch(request);
+        };
+
+        for (int tick = 0; tick < 200; tick++) {  // 10 s of the ota task at 50 ms
+            if (tick >= 10 && tick < 15) {
+                change([&] {
+                    AsyncWebServerRequest request(HTTP_POST, "/pins/config");
+                    const char* names[] = {"stepperStepPin", "stepperDirPin", "stepperEnablePin", "displaySdaPin",
+                                           "displaySclPin", "displayResetPin", "ledPin"};
+                    for (int i = 0; i < 7; i++) request.addParam(names[i], String(12 + i + tick % 3));
+                    server.dispatch(request);
+                });
+            }
+            if (tick == 40) change(postLedPin);
+            if (tick == 40) {
+                ConfigSchema::HomingSection section = {20000 + mode, 0};
+                change([&] { FlashController::set<ConfigSchema::Homing>(section); });
+            }
+            if (tick >= 60 && tick % 2 == 0) change(postLedPin);
+
+            NativeClock::advanceMicros(50000);
+            FlashController::service();
+        }
+        FlashController::flush();
+
+        ConfigStore::Stats after = FlashController::store().getStats();
+        NativeFlash::Stats flash = NativeFlash::stats();
+        char stall[24];
+        snprintf(stall, sizeof(stall), "%.1f ms", stallUs / 1000.0);
+        printf("  %-18s %8lu %8u %10llu %8lu %14s\n", MODES[mode], changes, after.flushes - before.flushes,
+               flash.bytesProgrammed, flash.erases, stall);
+    }
+}
+
+// The cached pin configuration: a GET /pins/config is a copy of JSON built
+// once per change, and changes made through another page (the LED pin) are
+// still seen. "after a change" alternates POST /led/pin and GET, so every
+// GET rebuilds the cache.
+BENCH_CASE(config_cache) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    MotionController motion(stepper);
+    PinManager pinManager(display);
+    ControlSignalHandler signals(display, stepper);
+    HomingSequence homing(motion, signals);
+    ServerManager server(display, motion, pinManager, signals, homing);
+    pinManager.init();
+    stepper.init();
+    server.init();
+
+    size_t bytes = 0;
+    uint32_t reloads = pinManager.reloads();
+    Bench::measure("GET /pins/config", 20000, [&] {
+        AsyncWebServerRequest request(HTTP_GET, "/pins/config");
+        server.dispatch(request);
+        bytes = request.response()->content().size();
+    });
+    printf("  %-40s %12zu bytes, %u reloads\n", "  response", bytes, pinManager.reloads() - reloads);
+    Bench::measure("PinManager::loadConfig()", 100000, [&] { pinManager.loadConfig(); });
+    Bench::measure("LedControl::getLedPin()", 100000, [&] { LedControl::getLedPin(); });
+
+    int pin = 2;
+    bool seen = true;
+    reloads = pinManager.reloads();
+    const int CHANGES = 2000;
+    double ns = Bench::timeNs(CHANGES, [&] {
+        AsyncWebServerRequest post(HTTP_POST, "/led/pin");
+        pin = pin % 30 + 2;
+        post.addParam("pin", String(pin));
+        server.dispatch(post);
+        AsyncWebServerRequest get(HTTP_GET, "/pins/config");
+        server.dispatch(get);
+        const std::vector<uint8_t>& body = get.response()->content();
+        String expected = String("\"ledPin\":") + String(pin) + "}";
+        if (std::string(body.begin(), body.end()).find(expected.c_str()) == std::string::npos) seen = false;
+    });
+    printf("  %-40s %12.1f ns/op\n", "POST /led/pin + GET /pins/config", ns);
+    printf("  %-40s %12u reloads for %d changes, %s\n", "  after a change", pinManager.reloads() - reloads, CHANGES,
+           seen ? "every change seen" : "MISMATCH: stale JSON served");
+    FlashController::flush();
+}
+
+// Boot-time validation of the settings blob: ConfigSchema::load() on each
+// kind of image a device can have, with the outcome and the values it
+// produced checked, and the typed read that replaced the per-field ones.
+// "old boot reads" is what init used to cost: the LED pin, each pin of the
+// set and the homing record read one call each.
+BENCH_CASE(config_schema) {
+    typedef ConfigSchema::Layout Layout;
+    typedef ConfigSchema::V1 V1;
+    const size_t SIZE = ConfigStore::IMAGE_SIZE;
+
+    Layout current = ConfigSchema::defaults();
+    current.pins.ledPin = 5;
+    current.homing.travel = 12345;
+    ConfigSchema::seal(current);
+
+    struct Image {
+        const char* name;
+        uint8_t bytes[SIZE];
+        ConfigSchema::Result expected;
+        int8_t ledPin;
+        int32_t travel;
+    };
+    std::vector<Image> images(6);
+    for (Image& image : images) memset(image.bytes, 0xFF, SIZE);
+
+    images[0].name = "current";
+    memcpy(images[0].bytes, &current, sizeof(current));
+    images[0].expected = ConfigSchema::VALID;
+    images[0].ledPin = 5;
+    images[0].travel = 12345;
+
+    // Version 1: the old address map, LED pin 7 and a homing record
+    images[1].name = "version 1";
+    for (size_t i = V1::LED_PIN; i <= V1::DISPLAY_RESET_PIN; i++) images[1].bytes[i] = 7 + i - V1::LED_PIN;
+    uint32_t v1Homing[4] = {V1::HOMING_MAGIC, 23456, 0, 0};
+    memcpy(images[1].bytes + V1::HOMING, v1Homing, sizeof(v1Homing));
+    images[1].expected = ConfigSchema::MIGRATED;
+    images[1].ledPin = 7;
+    images[1].travel = 23456;
+
+    // Written by a version that had no homing section yet
+    images[2].name = "shorter";
+    Layout shorter = current;
+    memcpy(images[2].bytes, &shorter, sizeof(shorter));
+    uint16_t shortLength = ConfigSchema::Homing::OFFSET;
+    uint32_t shortCrc = ConfigStore::crc32(images[2].bytes + sizeof(ConfigSchema::Header),
+                                           shortLength - sizeof(ConfigSchema::Header));
+    memcpy(images[2].bytes + offsetof(ConfigSchema::Header, length), &shortLength, sizeof(shortLength));
+    memcpy(images[2].bytes + offsetof(ConfigSchema::Header, crc), &shortCrc, sizeof(shortCrc));
+    images[2].expected = ConfigSchema::MIGRATED;
+    images[2].ledPin = 5;
+    images[2].travel = 0;
+
+    // Written by a later version with a section this one does not know
+    images[3].name = "longer";
+    memcpy(images[3].bytes, &current, sizeof(current));
+    uint16_t longLength = sizeof(Layout) + 16;
+    uint16_t longVersion = ConfigSchema::VERSION + 1;
+    memset(images[3].bytes + sizeof(Layout), 0x5A, 16);
+    uint32_t longCrc = ConfigStore::crc32(images[3].bytes + sizeof(ConfigSchema::Header),
+                                          longLength - sizeof(ConfigSchema::Header));
+    memcpy(images[3].bytes + offsetof(ConfigSchema::Header, version), &longVersion, sizeof(longVersion));
+    memcpy(images[3].bytes + offsetof(ConfigSchema::Header, length), &longLength, sizeof(longLength));
+    memcpy(images[3].bytes + offsetof(ConfigSchema::Header, crc), &longCrc, sizeof(longCrc));
+    images[3].expected = ConfigSchema::MIGRATED;
+    images[3].ledPin = 5;
+    images[3].travel = 12345;
+
+    images[4].name = "corrupt";
+    memcpy(images[4].bytes, &current, sizeof(current));
+    images[4].bytes[ConfigSchema::LedPin::OFFSET] ^= 0x10;
+    images[4].expected = ConfigSchema::DEFAULTED;
+    images[4].ledPin = ConfigSchema::DEFAULT_PINS.ledPin;
+    images[4].travel = 0;
+
+    images[5].name = "blank";
+    images[5].expected = ConfigSchema::DEFAULTED;
+    images[5].ledPin = ConfigSchema::DEFAULT_PINS.ledPin;
+    images[5].travel = 0;
+
+    printf("  blob: %zu bytes (header %zu, pins %zu at %zu, homing %zu at %zu, position %zu at %zu)\n",
+           sizeof(Layout), sizeof(ConfigSchema::Header), ConfigSchema::Pins::SIZE, ConfigSchema::Pins::OFFSET,
+           ConfigSchema::Homing::SIZE, ConfigSchema::Homing::OFFSET, ConfigSchema::Position::SIZE,
+           ConfigSchema::Position::OFFSET);
+    for (const Image& image : images) {
+        Layout out;
+        ConfigSchema::Result result = ConfigSchema::DEFAULTED;
+        char label[48];
+        snprintf(label, sizeof(label), "load(), %s", image.name);
+        Bench::measure(label, 100000, [&] { result = ConfigSchema::load(image.bytes, SIZE, out); });
+
+        // Whatever came in, what comes out must load as current
+        uint8_t stored[SIZE];
+        memcpy(stored, image.bytes, SIZE);
+        memcpy(stored, &out, sizeof(out));
+        Layout again;
+        bool ok = result == image.expected && out.pins.ledPin == image.ledPin &&
+                  out.homing.travel == image.travel &&
+                  ConfigSchema::load(stored, SIZE, again) == ConfigSchema::VALID;
+        printf("  %-40s %12s%s\n", "  result", ConfigSchema::resultName(result), ok ? "" : "  MISMATCH");
+    }
+
+    FlashController::init();
+    ConfigSchema::PinConfig pins;
+    ConfigSchema::HomingSection homing;
+    int8_t ledPin;
+    Bench::measure("FlashController::get<Pins>()", 100000, [&] { FlashController::get<ConfigSchema::Pins>(pins); });
+    Bench::measure("old boot reads (9 x read)", 100000, [&] {
+        FlashController::get<ConfigSchema::LedPin>(ledPin);
+        for (int i = 0; i < 7; i++) FlashController::store().read(ConfigSchema::Pins::OFFSET + i, &ledPin, 1);
+        FlashController::get<ConfigSchema::Homing>(homing);
+    });
+}
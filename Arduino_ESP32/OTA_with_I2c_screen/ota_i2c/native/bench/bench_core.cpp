@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "flash_controller.h"
+#include "motion_controller.h"
+#include "pin_manager.h"
+#include "server_manager.h"
+#include "stepper_manager.h"
+
+// Baseline timings of the paths that run on every loop()/page hit.
+
+BENCH_CASE(stepper_speed_query) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    stepper.init();
+    stepper.moveTo(100000);
+
+    Bench::measure("getCurrentPosition()", 100000, [&] {
+        NativeClock::advanceMicros(10);
+        stepper.getCurrentPosition();
+    });
+    Bench::measure("getCurrentSpeed()", 100000, [&] {
+        NativeClock::advanceMicros(10);
+        stepper.getCurrentSpeed();
+    });
+}
+
+BENCH_CASE(server_pages) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    MotionController motion(stepper);
+    PinManager pinManager(display);
+    ControlSignalHandler signals(display, stepper);
+    HomingSequence homing(motion, signals);
+    ServerManager server(display, motion, pinManager, signals, homing);
+    FlashController::init();
+    stepper.init();
+    server.init();
+
+    const char* pages[] = {"/", "/led", "/pins", "/system"};
+    String etag;
+    for (const char* page : pages) {
+        size_t bytes = 0;
+        char label[48];
+        snprintf(label, sizeof(label), "GET %s", page);
+        Bench::measure(label, 2000, [&] {
+            AsyncWebServerRequest request(HTTP_GET, page);
+            server.dispatch(request);
+            bytes = request.response()->content().size();
+            etag = request.response()->header("ETag")->value();
+        });
+        printf("  %-40s %12zu bytes\n", "  response size", bytes);
+    }
+
+    int code = 0;
+    Bench::measure("GET / (If-None-Match)", 2000, [&] {
+        AsyncWebServerRequest request(HTTP_GET, "/");
+        request.addHeader("If-None-Match", etag);
+        server.dispatch(request);
+        code = request.response()->code();
+    });
+    printf("  %-40s %12d\n", "  status", code);
+}
+
+BENCH_CASE(server_broadcast) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    MotionController motion(stepper);
+    PinManager pinManager(display);
+    ControlSignalHandler signals(display, stepper);
+    HomingSequence homing(motion, signals);
+    ServerManager server(display, motion, pinManager, signals, homing);
+    stepper.init();
+    server.init();
+    AsyncWebSocketClient* client = server.webSocket().connect();
+    client->keepFrames(false);
+
+    const unsigned long ticks = 10000;
+    Bench::measure("broadcastStatus() with 1 client", ticks, [&] {
+        NativeClock::advanceMicros(250000);
+        server.broadcastStatus();
+    });
+    printf("  %-40s %12.1f bytes/frame\n", "WebSocket payload", (double)client->bytesSent() / client->framesSent());
+}
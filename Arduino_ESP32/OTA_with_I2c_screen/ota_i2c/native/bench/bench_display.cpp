@@ -0,0 +1,279 @@
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "bench.h"
+#include "control_signal_handler.h"
+#include "display_manager.h"
+#include "motion_controller.h"
+#include "ssd1306_emulator.h"
+#include "stepper_manager.h"
+
+// I2C traffic per update of typical status screens: every call pushing the
+// whole frame (what display() used to do) against the retained text layer
+// transferring only the changed pages/columns. Time on the bus assumes 9
+// clocks per byte plus ~20 per transaction (start, address, stop).
+
+namespace {
+    struct Traffic {
+        double bytes;
+        double transactions;
+    };
+
+    double busMs(const Traffic& t, uint32_t clock) {
+        return (t.bytes * 9 + t.transactions * 20) * 1000.0 / clock;
+    }
+
+    // Calls draw(i, display) for i in [0, updates) and returns the average
+    // traffic per call, after the first screen
+    template <typename Draw>
+    Traffic run(DisplayManager& display, int updates, Draw draw) {
+        draw(-1, display);
+        Wire.resetStats();
+        for (int i = 0; i < updates; i++) draw(i, display);
+        return {(double)Wire.bytesWritten() / updates, (double)Wire.transactions() / updates};
+    }
+}
+
+BENCH_CASE(display_update) {
+    const int UPDATES = 200;
+    struct Screen {
+        const char* label;
+        void (*draw)(int i, DisplayManager& display);
+    };
+    const Screen SCREENS[] = {
+        {"same 4-line status", [](int, DisplayManager& d) {
+            d.displayLines({"WiFi Connected!", "10.0.1.234", "OTA: esp32-servo-tester", "Hash: 5a6b548"});
+        }},
+        {"OTA progress, per percent", [](int i, DisplayManager& d) {
+            char text[32];
+            sprintf(text, "Progress: %d%%", i < 0 ? 0 : i % 101);
+            d.displayText(text);
+        }},
+        {"status, uptime ticking", [](int i, DisplayManager& d) {
+            d.displayLines({"WiFi Connected!", "10.0.1.234", "Uptime: " + String(1000 + i) + " s", "Heap: 182340"});
+        }},
+        {"position readout", [](int i, DisplayManager& d) {
+            d.displayText(("Position: " + String(12000 + i * 37)).c_str());
+        }},
+        {"switch alerts, alternating", [](int i, DisplayManager& d) {
+            d.displayLines({"Limit Switch", (i & 1) ? "END_SWITCH" : "HOME_SWITCH", "Activated!"});
+        }},
+        {"different screens", [](int i, DisplayManager& d) {
+            if (i & 1) d.displayLines({"WiFi Setup Mode", "Connect to:", "ESP32-Setup"});
+            else d.displayLines({"HTTP server started", "10.0.1.234"});
+        }},
+    };
+
+    // Every update a full frame, as the driver's display() sends it
+    Adafruit_SSD1306 raw(128, 64);
+    raw.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    Wire.resetStats();
+    raw.display();
+    Traffic full = {(double)Wire.bytesWritten(), (double)Wire.transactions()};
+
+    printf("  %-28s %10s %8s %10s %10s %10s\n", "bytes and ms per update", "bytes", "trans", "100 kHz",
+           "400 kHz", "1 MHz");
+    printf("  %-28s %10.0f %8.0f %10.2f %10.2f %10.2f\n", "full frame (before)", full.bytes, full.transactions,
+           busMs(full, 100000), busMs(full, 400000), busMs(full, 1000000));
+    for (const Screen& screen : SCREENS) {
+        DisplayManager display(128, 64);
+        display.init();
+        Traffic t = run(display, UPDATES, screen.draw);
+        printf("  %-28s %10.1f %8.1f %10.2f %10.2f %10.2f\n", screen.label, t.bytes, t.transactions,
+               busMs(t, 100000), busMs(t, 400000), busMs(t, 1000000));
+    }
+
+    DisplayManager display(128, 64);
+    display.init();
+    int i = 0;
+    Bench::measure("displayLines(4 lines), unchanged", 100000, [&] {
+        display.displayLines({"WiFi Connected!", "10.0.1.234", "OTA: esp32-servo-tester", "Hash: 5a6b548"});
+    });
+    Bench::measure("displayLines(4 lines), one line changed", 20000, [&] {
+        display.displayLines({"WiFi Connected!", "10.0.1.234", "Uptime: " + String(++i) + " s", "Heap: 182340"});
+    });
+}
+
+BENCH_CASE(display_async) {
+    // What a caller pays per call, drawing itself vs posting to the display
+    // task; bus time assumes two transactions per transfer
+    char text[32];
+    int n = 0;
+    for (int async = 0; async < 2; async++) {
+        DisplayManager display(128, 64);
+        display.init();
+        if (async) display.startAsync();
+        Bench::measure(async ? "displayText(), posted" : "displayText(), drawn by the caller", 20000, [&] {
+            sprintf(text, "Progress: %d%%", ++n % 101);
+            display.displayText(text);
+        });
+        if (!async) {
+            DisplayManager::Stats stats = display.getStats();
+            printf("  %-40s %12.1f us/call at 400 kHz\n", "  + time on the bus (device)",
+                   (stats.bytes * 9 + stats.transfers * 40) * 1e6 / 400000.0 / stats.requested);
+        }
+    }
+
+    // An OTA upload on the virtual clock: a progress frame for every 1460-byte
+    // chunk (~700 KB/s), the odd switch alert and web text in between, and the
+    // display task rendering every 50 ms
+    DisplayManager display(128, 64);
+    display.init();
+    display.startAsync();
+    const unsigned long CHUNK_US = 2000;
+    const unsigned long IMAGE_CHUNKS = 1024 * 1024 / 1460;
+    for (unsigned long chunk = 0; chunk < IMAGE_CHUNKS; chunk++) {
+        sprintf(text, "Progress: %lu%%", chunk * 100 / IMAGE_CHUNKS);
+        display.displayText(text);
+        if (chunk % 97 == 0) display.displayLines({"Limit Switch", "END_SWITCH", "Activated!"});
+        if (chunk % 211 == 0) display.displayText("Hello from the web");
+        NativeClock::advanceMicros(CHUNK_US);
+        if (micros() / 50000 != (micros() - CHUNK_US) / 50000) display.render();
+    }
+    display.render();
+
+    DisplayManager::Stats stats = display.getStats();
+    printf("  1 MB OTA upload, %lu chunks over %.1f s:\n", IMAGE_CHUNKS, IMAGE_CHUNKS * CHUNK_US / 1e6);
+    printf("  %-40s %12u\n", "  frames requested", stats.requested);
+    printf("  %-40s %12u\n", "  frames rendered", stats.rendered);
+    printf("  %-40s %12u\n", "  frames unchanged", stats.unchanged);
+    printf("  %-40s %12u\n", "  frames coalesced", stats.requested - stats.rendered - stats.unchanged);
+    printf("  %-40s %12u\n", "  I2C bytes", stats.bytes);
+    printf("  %-40s %12.1f ms at 400 kHz\n", "  I2C time (device)", (stats.bytes * 9 + stats.transfers * 40) / 400.0);
+}
+
+BENCH_CASE(display_dashboard) {
+    // The display task's work per second of a 10 s move at each dashboard
+    // interval: reading the snapshot (published state only), formatting it and
+    // drawing what changed. CPU is host time; bus time is estimated for the
+    // device at 400 kHz.
+    const uint32_t INTERVALS[] = {50, 100, 250, 1000};
+    const unsigned long SECONDS = 10;
+
+    printf("  %-24s %10s %10s %12s %12s %12s\n", "dashboard interval", "frames/s", "drawn/s", "CPU us/s",
+           "I2C bytes/s", "bus ms/s");
+    for (uint32_t interval : INTERVALS) {
+        NativeGpio::reset();
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        MotionController motion(stepper);
+        ControlSignalHandler signals(display, stepper);
+        display.init();
+        stepper.init();
+        signals.init();
+        signals.addLimitSwitch(18, "HOME_SWITCH", false);
+        signals.addLimitSwitch(19, "END_SWITCH", false);
+        display.startAsync();
+        display.setMode(DisplayManager::MODE_DASHBOARD);
+        display.setDashboardInterval(interval);
+        MotionCommand move = {MotionCommand::MOVE_TO, 80000, 0, 0, 0};
+        motion.post(MotionController::PRODUCER_LOCAL, move);
+
+        // Measured after the "Stepper initialized" message has had its hold time
+        const unsigned long HOLD_MS = DisplayManager::MESSAGE_HOLD_MS;
+        std::chrono::steady_clock::duration busy(0);
+        DisplayManager::Stats before = {};
+        for (unsigned long ms = 0; ms < HOLD_MS + SECONDS * 1000; ms++) {
+            if (ms == HOLD_MS) {
+                before = display.getStats();
+                busy = std::chrono::steady_clock::duration(0);
+            }
+            motion.poll();
+            if (ms % 50 == 0) {
+                auto start = std::chrono::steady_clock::now();
+                if (display.dashboardDue()) {
+                    MotionStatus status = motion.status();
+                    DisplayManager::Dashboard d = {status.position, status.target, status.speed, status.running,
+                                                   signals.switchMask(), signals.triggeredMask(), true, -61,
+                                                   ESP.getFreeHeap()};
+                    display.postDashboard(d);
+                }
+                display.render();
+                busy += std::chrono::steady_clock::now() - start;
+            }
+            NativeClock::advanceMicros(1000);
+        }
+        DisplayManager::Stats stats = display.getStats();
+        double cpuUs = std::chrono::duration<double, std::micro>(busy).count() / SECONDS;
+        double bytes = (double)(stats.bytes - before.bytes) / SECONDS;
+        double transfers = (double)(stats.transfers - before.transfers) / SECONDS;
+        char label[32];
+        snprintf(label, sizeof(label), "%u ms", interval);
+        printf("  %-24s %10.1f %10.1f %12.1f %12.0f %12.2f\n", label,
+               (double)(stats.dashboards - before.dashboards) / SECONDS,
+               (double)(stats.rendered - before.rendered) / SECONDS, cpuUs, bytes,
+               (bytes * 9 + transfers * 40) / 400.0);
+    }
+}
+
+namespace {
+    // What DisplayManager's text layout should put on the panel, drawn into a
+    // plain framebuffer
+    void drawReference(Adafruit_SSD1306& ref, const std::vector<String>& lines) {
+        ref.clearDisplay();
+        ref.setTextSize(1);
+        ref.setTextColor(SSD1306_WHITE);
+        for (size_t i = 0; i < lines.size(); i++) {
+            ref.setCursor(0, i * 10);
+            ref.println(lines[i].c_str());
+        }
+    }
+}
+
+BENCH_CASE(display_screens) {
+    // Screens decoded by the SSD1306 emulator on the bus: after every update
+    // the panel must show exactly what a full redraw of the same text would,
+    // however little was transferred. The hash identifies each final screen
+    // (a changed hash is a changed screen); with -d <dir> each one is also
+    // written as <dir>/<name>.pbm.
+    struct Screen {
+        const char* name;
+        std::vector<std::vector<String>> updates;
+    };
+    std::vector<Screen> screens;
+    Screen ota = {"ota_progress", {{"OTA Update Start"}}};
+    for (int percent = 0; percent <= 100; percent++) ota.updates.push_back({"Progress: " + String(percent) + "%"});
+    ota.updates.push_back({"OTA Update Complete", "Gonna reset", "the device"});
+    screens.push_back(ota);
+    screens.push_back({"switch_alert", {{"Limit Switch", "HOME_SWITCH", "Activated!"},
+                                        {"Limit Switch", "END_SWITCH", "Activated!"}}});
+    screens.push_back({"connected", {{"WiFi Setup Mode", "Connect to:", "ESP32-Setup"},
+                                     {"WiFi Connected!", "10.0.1.234", "OTA: esp32-servo-tester", "Hash: 5a6b548"}}});
+    screens.push_back({"long_text", {{"A line of text longer than the 21 characters of one row wraps"}}});
+
+    printf("  %-16s %8s %10s %12s %10s %10s\n", "screen", "updates", "I2C bytes", "bus us", "hash", "panel");
+    for (const Screen& screen : screens) {
+        DisplayManager display(128, 64);
+        Ssd1306Emulator panel(128, 64);
+        panel.attach(Wire);
+        display.init();
+        Adafruit_SSD1306 ref(128, 64);
+        Wire.resetStats();
+
+        int mismatches = 0;
+        for (const std::vector<String>& lines : screen.updates) {
+            display.displayLines(lines);
+            drawReference(ref, lines);
+            if (!panel.matches(ref.getBuffer())) mismatches++;
+        }
+        printf("  %-16s %8zu %10llu %12.0f %10.8x %10s\n", screen.name, screen.updates.size(), Wire.bytesWritten(),
+               Wire.busMicros(), panel.imageHash(), mismatches ? "MISMATCH" : "ok");
+        if (Bench::dumpDir()) {
+            std::string path = std::string(Bench::dumpDir()) + "/" + screen.name + ".pbm";
+            if (!panel.writePbm(path.c_str())) printf("    cannot write %s\n", path.c_str());
+        }
+    }
+
+    // The dashboard, as the display task draws it
+    DisplayManager display(128, 64);
+    Ssd1306Emulator panel(128, 64);
+    panel.attach(Wire);
+    display.init();
+    display.startAsync();
+    display.setMode(DisplayManager::MODE_DASHBOARD);
+    DisplayManager::Dashboard d = {12345, 20000, 3200, true, 0x3, 0x2, true, -61, 182340};
+    display.postDashboard(d);
+    display.render();
+    printf("  %-16s %8d %10s %12s %10.8x %10s\n", "dashboard", 1, "", "", panel.imageHash(), panel.isOn() ? "ok" : "OFF");
+    if (Bench::dumpDir()) panel.writePbm((std::string(Bench::dumpDir()) + "/dashboard.pbm").c_str());
+}
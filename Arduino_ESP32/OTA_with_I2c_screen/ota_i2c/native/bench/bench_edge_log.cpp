@@ -0,0 +1,179 @@
+#include <vector>
+#include <Arduino.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "edge_log.h"
+#include "motion_controller.h"
+#include "pin_manager.h"
+#include "server_manager.h"
+#include "stepper_manager.h"
+
+// End-stop repeatability at several feed rates, on the virtual clock: the
+// motor runs into END_SWITCH (which bounces twice on closing) 20 times from
+// random distances, the signals task notices the debounced closing and posts
+// a stop, the motor backs off and the next approach starts. After each
+// approach the new edges are fetched incrementally from GET /switches/edges
+// and decoded. "log" is the position in the first closing edge the interrupt
+// recorded, "task" the position when the debounced event reached the signals
+// task; the spread (max - min) is what a repeatability test would see.
+// The switch closes at the same physical position every time, so any log
+// spread is capture error. Host esp_timer is wall-clock time while the
+// simulation runs on the virtual clock, so the time deltas are not shown.
+
+namespace {
+    const uint8_t END_PIN = 19;
+    const long END_EDGE = 6000;
+    const int APPROACHES = 20;
+    const unsigned long SUBSTEP_US = 5;   // Level resolution: < 0.1 step at 12800 steps/s
+    const unsigned long BOUNCE_US = 20;
+
+    struct Spread {
+        long min = 0x7fffffff;
+        long max = -0x7fffffff;
+        void add(long v) {
+            if (v < min) min = v;
+            if (v > max) max = v;
+        }
+    };
+
+    struct Download {
+        EdgeLog::Header header;
+        std::vector<EdgeLog::Record> records;
+        size_t bytes;
+    };
+
+    Download fetchEdges(ServerManager& server, uint32_t since) {
+        AsyncWebServerRequest request(HTTP_GET, "/switches/edges");
+        request.addParam("since", String(since), false);  // Query string
+        server.dispatch(request);
+        const std::vector<uint8_t>& body = request.response()->content();
+        Download d;
+        d.bytes = body.size();
+        memcpy(&d.header, body.data(), sizeof(d.header));
+        d.records.resize(d.header.count);
+        memcpy(d.records.data(), body.data() + sizeof(d.header), d.header.count * sizeof(EdgeLog::Record));
+        return d;
+    }
+}
+
+BENCH_CASE(edge_log_repeatability) {
+    const float SPEEDS[] = {1600, 6400, 12800};
+    srand(11);
+
+    printf("  END_SWITCH closes at %ld, %d approaches per feed rate\n", END_EDGE, APPROACHES);
+    printf("  %-14s %8s %8s %8s %8s %8s %8s %10s\n", "steps/s", "log min", "log max", "task min", "task max",
+           "edges", "bytes", "overwrites");
+    for (float speed : SPEEDS) {
+        NativeGpio::reset();
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        MotionController motion(stepper);
+        PinManager pinManager(display);
+        ControlSignalHandler signals(display, stepper);
+        HomingSequence homing(motion, signals);
+        ServerManager server(display, motion, pinManager, signals, homing);
+        stepper.init();
+        signals.init();
+        server.init();
+        signals.addLimitSwitch(END_PIN, "END_SWITCH", false);
+        NativeGpio::setLevel(END_PIN, false);
+
+        long taskPosition = 0;
+        bool closed = false;
+        EventBus::SubscriberId reaction = EventBus::instance().subscribe(
+            "bench", EventBus::maskOf(EventBus::INPUT_CHANGED), [&](const EventBus::Event& event) {
+                if (!event.value) return;
+                taskPosition = stepper.getCurrentPosition();
+                closed = true;
+                MotionCommand stop = {MotionCommand::STOP, 0, 0, 0, 0};
+                motion.post(MotionController::PRODUCER_LOCAL, stop);
+            });
+
+        MotionCommand setSpeed = {MotionCommand::SET_SPEED, 0, speed, 0, 0};
+        motion.post(MotionController::PRODUCER_LOCAL, setSpeed);
+
+        Spread log, task;
+        uint32_t since = 0;
+        unsigned long edges = 0, bytes = 0, overwrites = 0;
+        bool level = false;
+        unsigned long bounceAt = 0;
+        int bounces = 0;
+        for (int run = 0; run < APPROACHES; run++) {
+            // Random distance and a random phase against the task ticks
+            NativeClock::advanceMicros(rand() % 2000);
+            MotionCommand move = {MotionCommand::MOVE_TO, 100000, 0, 0, 0};
+            motion.post(MotionController::PRODUCER_LOCAL, move);
+            closed = false;
+            bool backingOff = false;
+            for (unsigned long tick = 0; tick < 60000; tick++) {
+                motion.poll();
+                if (tick % 2 == 0) {
+                    signals.handle();
+                    EventBus::instance().dispatch(reaction);
+                }
+                if (closed && !backingOff && !stepper.isRunning()) {
+                    MotionCommand back = {MotionCommand::MOVE_TO, (int32_t)(END_EDGE - 600 - rand() % 1500), 0, 0, 0};
+                    motion.post(MotionController::PRODUCER_LOCAL, back);
+                    backingOff = true;
+                } else if (backingOff && !stepper.isRunning() && !signals.isLimitSwitchTriggered("END_SWITCH")) {
+                    break;
+                }
+                for (unsigned long us = 0; us < 1000; us += SUBSTEP_US) {
+                    NativeClock::advanceMicros(SUBSTEP_US);
+                    unsigned long now = micros();
+                    bool atSwitch = stepper.getCurrentPosition() >= END_EDGE;
+                    if (atSwitch != level && bounces == 0) {
+                        level = atSwitch;
+                        NativeGpio::setLevel(END_PIN, level);
+                        if (level) {
+                            bounces = 4;  // open, close, open, close
+                            bounceAt = now + BOUNCE_US;
+                        }
+                    } else if (bounces > 0 && now >= bounceAt) {
+                        bounces--;
+                        NativeGpio::setLevel(END_PIN, bounces % 2 == 0);
+                        bounceAt = now + BOUNCE_US;
+                    }
+                }
+            }
+
+            Download d = fetchEdges(server, since);
+            if (d.header.firstSequence != since) overwrites++;
+            since = d.header.nextSequence;
+            edges += d.records.size();
+            bytes += d.bytes;
+            for (const EdgeLog::Record& r : d.records) {
+                if (r.flags & EdgeLog::FLAG_ACTIVE) {
+                    log.add(r.position);
+                    break;
+                }
+            }
+            task.add(taskPosition);
+        }
+        EventBus::instance().unsubscribe(reaction);
+
+        char label[16];
+        snprintf(label, sizeof(label), "%.0f", speed);
+        printf("  %-14s %8ld %8ld %8ld %8ld %8lu %8lu %10lu\n", label, log.min, log.max, task.min, task.max, edges,
+               bytes, overwrites);
+        printf("  %-14s %17ld %17ld\n", "  spread", log.max - log.min, task.max - task.min);
+    }
+}
+
+BENCH_CASE(edge_log_cost) {
+    EdgeLog log;
+    uint32_t n = 0;
+    Bench::measure("record()", 1000000, [&] { log.record(19, n & 1, n & 1, n); n++; });
+
+    static uint8_t buffer[EdgeLog::MAX_ENCODED_SIZE];
+    volatile size_t sink = 0;
+    Bench::measure("encode(), full ring (256 edges)", 100000, [&] {
+        sink = log.encode(0, buffer, sizeof(buffer));
+    });
+    uint32_t recent = log.nextSequence() - 16;
+    Bench::measure("encode(), last 16 edges", 1000000, [&] {
+        sink = log.encode(recent, buffer, sizeof(buffer));
+    });
+    printf("  %-40s %12zu bytes (%zu + %zu per edge)\n", "  full ring", EdgeLog::MAX_ENCODED_SIZE,
+           sizeof(EdgeLog::Header), sizeof(EdgeLog::Record));
+}
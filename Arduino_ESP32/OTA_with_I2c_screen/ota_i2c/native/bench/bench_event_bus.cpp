@@ -0,0 +1,141 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <Arduino.h>
+#include "bench.h"
+#include "event_bus.h"
+
+// EventBus cost per publish and per delivered event, multi-threaded
+// throughput with producers and subscribers on real threads (as ISRs and
+// tasks would be), and dispatch latency on the virtual clock for subscribers
+// polled at the firmware's task periods.
+
+BENCH_CASE(event_bus_cost) {
+    EventBus bus;
+    Bench::measure("publish(), no subscriber", 1000000, [&] { bus.publish(EventBus::INPUT_CHANGED, 1, 1); });
+
+    uint32_t seen = 0;
+    EventBus::SubscriberId one = bus.subscribe("one", EventBus::ALL, [&seen](const EventBus::Event&) { seen++; });
+    Bench::measure("publish() + dispatch(), 1 subscriber", 1000000, [&] {
+        bus.publish(EventBus::INPUT_CHANGED, 1, 1);
+        bus.dispatch(one);
+    });
+
+    // Four subscribers, only two of which want the event type
+    EventBus::SubscriberId others[3];
+    others[0] = bus.subscribe("match", EventBus::maskOf(EventBus::INPUT_CHANGED), [&seen](const EventBus::Event&) { seen++; });
+    others[1] = bus.subscribe("other", EventBus::maskOf(EventBus::OTA_PROGRESS), [&seen](const EventBus::Event&) { seen++; });
+    others[2] = bus.subscribe("other", EventBus::maskOf(EventBus::WIFI_STATE), [&seen](const EventBus::Event&) { seen++; });
+    Bench::measure("publish() + 4 x dispatch(), 2 filtered", 1000000, [&] {
+        bus.publish(EventBus::INPUT_CHANGED, 1, 1);
+        bus.dispatch(one);
+        for (EventBus::SubscriberId id : others) bus.dispatch(id);
+    });
+    Bench::measure("dispatch() with nothing pending", 1000000, [&] { bus.dispatch(one); });
+}
+
+namespace {
+    const int PRODUCERS = 3;
+
+    struct Consumer {
+        EventBus::SubscriberId id;
+        int32_t next[PRODUCERS];
+        uint32_t outOfOrder;
+    };
+
+    // Three producers publish perEach events, in bursts with a pause between
+    // (pauseUs 0: flat out); two subscribers drain on their own threads. Each
+    // producer numbers its events, so a subscriber can tell a drop (gap) from
+    // a torn or repeated read (out of order). Flat out, the ring is lapped
+    // long before a subscriber gets the CPU; delivered + dropped still adds up
+    // to everything published.
+    void runThreads(const char* label, int perEach, int burst, int pauseUs) {
+        EventBus bus;
+        Consumer consumers[2] = {};
+        for (Consumer& c : consumers) {
+            Consumer* self = &c;
+            c.id = bus.subscribe("bench", EventBus::ALL, [self](const EventBus::Event& event) {
+                if (event.value < self->next[event.source]) self->outOfOrder++;
+                self->next[event.source] = event.value + 1;
+            });
+        }
+
+        std::atomic<bool> done(false);
+        std::vector<std::thread> threads;
+        for (Consumer& c : consumers) {
+            threads.emplace_back([&bus, &done, &c] {
+                while (!done.load(std::memory_order_acquire)) {
+                    if (bus.dispatch(c.id) == 0) std::this_thread::yield();
+                }
+                bus.dispatch(c.id);
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; p++) {
+            producers.emplace_back([&bus, p, perEach, burst, pauseUs] {
+                for (int32_t i = 0; i < perEach; i++) {
+                    bus.publish(EventBus::INPUT_CHANGED, p, i);
+                    if (pauseUs && i % burst == burst - 1) std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+                }
+            });
+        }
+        for (auto& t : producers) t.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        done.store(true, std::memory_order_release);
+        for (auto& t : threads) t.join();
+
+        for (int i = 0; i < 2; i++) {
+            EventBus::Stats stats = bus.getStats(consumers[i].id);
+            printf("  %-34s %10.2f %10u %10u %12u\n", i == 0 ? label : "", PRODUCERS * perEach / seconds / 1e6,
+                   stats.delivered, stats.dropped, consumers[i].outOfOrder);
+        }
+    }
+}
+
+BENCH_CASE(event_bus_threads) {
+    printf("  %-34s %10s %10s %10s %12s\n", "3 producers, 2 subscribers", "M ev/s", "delivered", "dropped",
+           "out of order");
+    runThreads("flat out, 300000 each", 300000, 1, 0);
+    runThreads("bursts of 32 every 200 us", 20000, 32, 200);
+}
+
+BENCH_CASE(event_bus_latency) {
+    // Events every 0.5-3 ms of virtual time; each subscriber is dispatched
+    // at its task's period, as in main.cpp
+    EventBus bus;
+    struct Poller {
+        const char* label;
+        unsigned long periodUs;
+        EventBus::SubscriberId id;
+    };
+    Poller pollers[] = {
+        {"motion (1 ms)", 1000, -1},
+        {"signals (2 ms)", 2000, -1},
+        {"telemetry (10 ms)", 10000, -1},
+        {"display / ota (50 ms)", 50000, -1},
+    };
+    for (Poller& p : pollers) p.id = bus.subscribe(p.label, EventBus::ALL, [](const EventBus::Event&) {});
+
+    srand(7);
+    unsigned long nextEvent = 0;
+    for (unsigned long us = 0; us < 10000000; us += 50) {
+        NativeClock::setMicros(us);
+        if (us >= nextEvent) {
+            bus.publish(EventBus::INPUT_CHANGED, 0, 1);
+            nextEvent = us + 500 + rand() % 2500;
+        }
+        for (Poller& p : pollers) {
+            if (us % p.periodUs == 0) bus.dispatch(p.id);
+        }
+    }
+
+    printf("  %-24s %10s %10s %12s %12s\n", "subscriber", "delivered", "dropped", "latency avg", "latency max");
+    for (Poller& p : pollers) {
+        EventBus::Stats stats = bus.getStats(p.id);
+        printf("  %-24s %10u %10u %10lluus %10uus\n", p.label, stats.delivered, stats.dropped,
+               stats.delivered ? (unsigned long long)(stats.totalLatencyUs / stats.delivered) : 0ULL,
+               stats.maxLatencyUs);
+    }
+}
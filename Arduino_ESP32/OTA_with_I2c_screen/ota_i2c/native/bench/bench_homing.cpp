@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include "bench.h"
+#include "control_signal_handler.h"
+#include "display_manager.h"
+#include "flash_controller.h"
+#include "homing_sequence.h"
+#include "motion_controller.h"
+#include "stepper_manager.h"
+
+// A full homing run on the virtual clock: HOME_SWITCH closes below one
+// physical position and END_SWITCH above another, the switch levels follow
+// the motor every 50 us, the motion task runs at 1 ms and the signals task
+// (switches + homing) at 2 ms, as on the device. The reference error is where
+// the homed frame puts the physical HOME_SWITCH edge (ideally 0); the travel
+// error compares the measured travel with the true distance between the edges.
+
+namespace {
+    const uint8_t HOME_PIN = 18;
+    const uint8_t END_PIN = 19;
+    const long HOME_EDGE = -12000;     // Physical positions, motor starts at 0
+    const long END_EDGE = 28000;
+    const unsigned long TIMEOUT_MS = 120000;
+
+    struct Result {
+        HomingSequence::Status status;
+        long referenceError;
+        long travelError;
+    };
+
+    Result runHoming(const HomingSequence::Settings& settings) {
+        NativeGpio::reset();
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        MotionController motion(stepper);
+        ControlSignalHandler signals(display, stepper);
+        HomingSequence homing(motion, signals);
+        stepper.init();
+        signals.init();
+        signals.addLimitSwitch(HOME_PIN, "HOME_SWITCH", false, LimitSwitch::ACTION_STOP_DIRECTION, -1);
+        signals.addLimitSwitch(END_PIN, "END_SWITCH", false, LimitSwitch::ACTION_STOP_DIRECTION, 1);
+        NativeGpio::setLevel(HOME_PIN, false);
+        NativeGpio::setLevel(END_PIN, false);
+        homing.begin();
+        homing.start(settings);
+
+        // Only clock advances move the motor; position jumps inside poll()
+        // are SET_POSITION re-referencing the logical frame
+        long physical = 0;
+        bool homeLevel = false, endLevel = false;
+        for (unsigned long tick = 0; tick < TIMEOUT_MS; tick++) {
+            motion.poll();
+            if (tick % 2 == 0) {
+                signals.handle();
+                homing.update();
+                HomingSequence::Phase phase = homing.status().phase;
+                if (phase == HomingSequence::DONE || phase == HomingSequence::FAILED) break;
+            }
+            for (int sub = 0; sub < 20; sub++) {
+                long before = stepper.getCurrentPosition();
+                NativeClock::advanceMicros(50);
+                physical += stepper.getCurrentPosition() - before;
+                if ((physical <= HOME_EDGE) != homeLevel) {
+                    homeLevel = !homeLevel;
+                    NativeGpio::setLevel(HOME_PIN, homeLevel);
+                }
+                if ((physical >= END_EDGE) != endLevel) {
+                    endLevel = !endLevel;
+                    NativeGpio::setLevel(END_PIN, endLevel);
+                }
+            }
+        }
+
+        Result r;
+        r.status = homing.status();
+        long offset = stepper.getCurrentPosition() - physical;
+        r.referenceError = HOME_EDGE + offset;
+        r.travelError = r.status.travel - (END_EDGE - HOME_EDGE);
+        return r;
+    }
+}
+
+BENCH_CASE(homing_sequence) {
+    FlashController::init();
+    struct Case {
+        const char* label;
+        float fast;
+        float slow;
+        bool measure;
+    };
+    const Case CASES[] = {
+        {"1600 / 200, measure", 1600, 200, true},
+        {"3200 / 400, measure", 3200, 400, true},
+        {"6400 / 800, measure", 6400, 800, true},
+        {"6400 / 6400, measure", 6400, 6400, true},
+        {"6400 / 800, stored travel", 6400, 800, false},
+    };
+
+    printf("  HOME_SWITCH edge at %ld, END_SWITCH edge at %ld (true travel %ld)\n", HOME_EDGE, END_EDGE,
+           END_EDGE - HOME_EDGE);
+    printf("  %-28s %7s %7s %7s %7s %7s %8s %7s %7s\n", "fast / slow steps/s", "fast", "back", "slow", "travel",
+           "return", "total ms", "ref err", "trv err");
+    for (const Case& c : CASES) {
+        HomingSequence::Settings settings = HomingSequence::defaults();
+        settings.fastSpeed = c.fast;
+        settings.slowSpeed = c.slow;
+        settings.measureTravel = c.measure;
+        Result r = runHoming(settings);
+        const uint32_t* ms = r.status.phaseMs;
+        printf("  %-28s %7lu %7lu %7lu %7lu %7lu %8lu %7ld %7ld%s\n", c.label,
+               (unsigned long)ms[HomingSequence::FAST_APPROACH], (unsigned long)ms[HomingSequence::BACK_OFF],
+               (unsigned long)ms[HomingSequence::SLOW_APPROACH], (unsigned long)ms[HomingSequence::MEASURE_TRAVEL],
+               (unsigned long)ms[HomingSequence::RETURN], (unsigned long)r.status.elapsedMs, r.referenceError,
+               r.travelError, r.status.homed ? "" : "  NOT HOMED");
+        if (r.status.error) printf("    error: %s\n", r.status.error);
+    }
+}
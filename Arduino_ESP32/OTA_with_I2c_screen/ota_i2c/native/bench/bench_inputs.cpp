@@ -0,0 +1,163 @@
+#include <memory>
+#include <vector>
+#include <Arduino.h>
+#include "bench.h"
+#include "control_signal_handler.h"
+#include "display_manager.h"
+#include "input_sampler.h"
+#include "stepper_manager.h"
+
+// Per-tick cost of debouncing 2, 16 and 32 inputs. The baseline is the
+// previous per-object scheme: a vector of shared_ptr switches, each doing its
+// own millis() and digitalRead() once its interrupt flagged a change. "quiet"
+// is a tick with no interrupt activity, "all flagged" one where every input
+// saw an edge (for polled inputs without an interrupt, every tick). Host
+// digitalRead() is an array access, so the device gap is wider than shown.
+
+namespace {
+    // What LimitSwitch::update() used to do
+    struct PerObjectSwitch {
+        uint8_t pin;
+        bool activeLow;
+        bool triggered = false;
+        bool stateChanged = false;
+        unsigned long lastDebounceTime = 0;
+
+        PerObjectSwitch(uint8_t pin, bool activeLow) : pin(pin), activeLow(activeLow) {}
+
+        bool update() {
+            bool activated = false;
+            if (stateChanged) {
+                unsigned long now = millis();
+                if (now - lastDebounceTime > 50) {
+                    bool state = digitalRead(pin);
+                    if (activeLow) state = !state;
+                    if (state != triggered) {
+                        triggered = state;
+                        activated = state;
+                    }
+                    lastDebounceTime = now;
+                    stateChanged = false;
+                }
+            }
+            return activated;
+        }
+    };
+
+    const char* const SWITCH_IDS[] = {
+        "IN0", "IN1", "IN2", "IN3", "IN4", "IN5", "IN6", "IN7", "IN8", "IN9", "IN10",
+        "IN11", "IN12", "IN13", "IN14", "IN15", "IN16", "IN17", "IN18", "IN19", "IN20",
+        "IN21", "IN22", "IN23", "IN24", "IN25", "IN26", "IN27", "IN28", "IN29", "IN30", "IN31",
+    };
+}
+
+BENCH_CASE(input_debounce) {
+    const uint8_t COUNTS[] = {2, 16, 32};
+    const unsigned long ITERATIONS = 200000;
+
+    printf("  %-40s %12s %12s %12s\n", "ns per tick", "2 inputs", "16 inputs", "32 inputs");
+    double perObjectQuiet[3], perObjectFlagged[3], samplerQuiet[3], samplerToggling[3], handlerQuiet[3];
+    for (int c = 0; c < 3; c++) {
+        uint8_t count = COUNTS[c];
+        NativeGpio::reset();
+
+        std::vector<std::shared_ptr<PerObjectSwitch>> switches;
+        InputSampler sampler;
+        for (uint8_t pin = 0; pin < count; pin++) {
+            pinMode(pin, INPUT_PULLUP);
+            switches.push_back(std::make_shared<PerObjectSwitch>(pin, true));
+            sampler.addPin(pin, true);
+        }
+
+        volatile int sink = 0;
+        perObjectQuiet[c] = Bench::timeNs(ITERATIONS, [&] {
+            for (const auto& sw : switches) sink += sw->update();
+        });
+        perObjectFlagged[c] = Bench::timeNs(ITERATIONS, [&] {
+            NativeClock::advanceMicros(51000);  // Past the 50 ms window every tick
+            for (const auto& sw : switches) sw->stateChanged = true;
+            for (const auto& sw : switches) sink += sw->update();
+        });
+        samplerQuiet[c] = Bench::timeNs(ITERATIONS, [&] { sink += (int)sampler.sample(); });
+
+        // Every input flips every SAMPLES ticks, so a quarter of the ticks
+        // queue count events; drained as the signals task would
+        unsigned long tick = 0;
+        samplerToggling[c] = Bench::timeNs(ITERATIONS, [&] {
+            if (++tick % InputSampler::SAMPLES == 0) {
+                for (uint8_t pin = 0; pin < count; pin++) NativeGpio::setLevel(pin, (tick / InputSampler::SAMPLES) & 1);
+            }
+            sampler.sample();
+            InputSampler::Event event;
+            while (sampler.popEvent(event)) sink += event.active;
+        });
+
+        NativeGpio::reset();
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        ControlSignalHandler signals(display, stepper);
+        signals.init();
+        for (uint8_t pin = 0; pin < count; pin++) signals.addLimitSwitch(pin, SWITCH_IDS[pin], true);
+        for (int i = 0; i < InputSampler::SAMPLES; i++) signals.handle();  // Settle the pull-ups
+        handlerQuiet[c] = Bench::timeNs(ITERATIONS, [&] { signals.handle(); });
+    }
+
+    printf("  %-40s %12.1f %12.1f %12.1f\n", "per-object update(), quiet", perObjectQuiet[0], perObjectQuiet[1],
+           perObjectQuiet[2]);
+    printf("  %-40s %12.1f %12.1f %12.1f\n", "per-object update(), all flagged", perObjectFlagged[0],
+           perObjectFlagged[1], perObjectFlagged[2]);
+    printf("  %-40s %12.1f %12.1f %12.1f\n", "InputSampler::sample(), quiet", samplerQuiet[0], samplerQuiet[1],
+           samplerQuiet[2]);
+    printf("  %-40s %12.1f %12.1f %12.1f\n", "InputSampler, all toggling + drain", samplerToggling[0],
+           samplerToggling[1], samplerToggling[2]);
+    printf("  %-40s %12.1f %12.1f %12.1f\n", "ControlSignalHandler::handle(), quiet", handlerQuiet[0],
+           handlerQuiet[1], handlerQuiet[2]);
+
+    // Contact bounce shorter than the debounce window: one event per press
+    NativeGpio::reset();
+    InputSampler sampler;
+    pinMode(5, INPUT_PULLUP);
+    sampler.addPin(5, true);
+    unsigned events = 0;
+    for (int press = 0; press < 100; press++) {
+        for (int bounce = 0; bounce < 3; bounce++) {
+            NativeGpio::setLevel(5, bounce & 1);
+            sampler.sample();
+        }
+        for (int hold = 0; hold < 10; hold++) {
+            NativeGpio::setLevel(5, press & 1);
+            sampler.sample();
+        }
+        InputSampler::Event event;
+        while (sampler.popEvent(event)) events++;
+    }
+    printf("  100 bouncing presses/releases -> %u debounced events\n", events);
+}
+
+BENCH_CASE(input_registry) {
+    // The last of 32 switches, looked up the way isLimitSwitchTriggered() did
+    // (strcmp over a vector of shared_ptr) and by handle
+    NativeGpio::reset();
+    std::vector<std::shared_ptr<LimitSwitch>> heap;
+    for (uint8_t pin = 0; pin < 32; pin++) heap.push_back(std::make_shared<LimitSwitch>(pin, SWITCH_IDS[pin]));
+
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    ControlSignalHandler signals(display, stepper);
+    signals.init();
+    for (uint8_t pin = 0; pin < 32; pin++) signals.addLimitSwitch(pin, SWITCH_IDS[pin], true);
+    ControlSignalHandler::SwitchHandle last = signals.findLimitSwitch("IN31");
+
+    volatile bool sink = false;
+    Bench::measure("strcmp scan, shared_ptr vector", 1000000, [&] {
+        for (const auto& sw : heap) {
+            if (strcmp(sw->getId(), "IN31") == 0) {
+                sink = sw->isTriggered();
+                break;
+            }
+        }
+    });
+    Bench::measure("isLimitSwitchTriggered(id)", 1000000, [&] { sink = signals.isLimitSwitchTriggered("IN31"); });
+    Bench::measure("isLimitSwitchTriggered(handle)", 1000000, [&] { sink = signals.isLimitSwitchTriggered(last); });
+    Bench::measure("getLastEdge(handle)", 1000000, [&] { sink = signals.getLastEdge(last).count; });
+}
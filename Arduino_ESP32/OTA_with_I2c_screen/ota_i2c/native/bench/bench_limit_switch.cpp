@@ -0,0 +1,120 @@
+#include <Arduino.h>
+#include "bench.h"
+#include "control_signal_handler.h"
+#include "display_manager.h"
+#include "motion_controller.h"
+#include "stepper_manager.h"
+
+// A switch closing (with contact bounce) under a motor cruising towards it,
+// simulated on the virtual clock with the motion task at 1 ms and the signals
+// task at 2 ms. Each interrupt action is compared with leaving the reaction
+// to a subscriber of the switch event on the signals task, which posts a stop
+// through the motion mailbox.
+// The ISR latches the stop and the next motion tick acts on it, so "action
+// us" is the rest of the tick the edge fell into; "at rest us" has the
+// signals task's 2 ms resolution.
+
+namespace {
+    const uint8_t SWITCH_PIN = 19;
+
+    struct Result {
+        LimitSwitch::StopReport report;
+        bool stopped;
+    };
+
+    Result runStop(LimitSwitch::Action action, StepperManager::ProfileMode mode) {
+        NativeGpio::reset();
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        MotionController motion(stepper);
+        ControlSignalHandler signals(display, stepper);
+        stepper.init();
+        stepper.setProfile(mode, 0);
+        signals.init();
+        signals.addLimitSwitch(SWITCH_PIN, "END_SWITCH", false, action, 1);
+        NativeGpio::setLevel(SWITCH_PIN, false);
+        EventBus::SubscriberId reaction = -1;
+        if (action == LimitSwitch::ACTION_REPORT) {
+            reaction = EventBus::instance().subscribe("bench", EventBus::maskOf(EventBus::INPUT_CHANGED),
+                                                      [&motion](const EventBus::Event& event) {
+                if (!event.value) return;
+                MotionCommand stop = {MotionCommand::STOP, 0, 0, 0, 0};
+                motion.post(MotionController::PRODUCER_LOCAL, stop);
+            });
+        }
+
+        MotionCommand move = {MotionCommand::MOVE_TO, 100000, 0, 0, 0};
+        motion.post(MotionController::PRODUCER_LOCAL, move);
+
+        // Cruise for a while, then close the switch partway through a tick
+        unsigned long tick = 0;
+        unsigned long edgeTick = 1500;
+        unsigned long edgeAt = 0;
+        while (tick < 4000) {
+            motion.poll();
+            if (tick % 2 == 0) {
+                signals.handle();
+                EventBus::instance().dispatch(reaction);
+            }
+            if (tick == edgeTick) {
+                NativeClock::advanceMicros(370);
+                edgeAt = stepper.getCurrentPosition();
+                for (int bounce = 0; bounce < 3; bounce++) {
+                    NativeGpio::setLevel(SWITCH_PIN, true);
+                    NativeClock::advanceMicros(40);
+                    NativeGpio::setLevel(SWITCH_PIN, false);
+                    NativeClock::advanceMicros(40);
+                }
+                NativeGpio::setLevel(SWITCH_PIN, true);
+                NativeClock::advanceMicros(630 - 240);
+            } else {
+                NativeClock::advanceMicros(1000);
+            }
+            tick++;
+            if (tick > edgeTick + 2 && !stepper.isRunning() && tick % 2 == 0) {
+                signals.handle();
+                break;
+            }
+        }
+
+        EventBus::instance().unsubscribe(reaction);
+
+        Result r;
+        r.report = {};
+        r.stopped = !stepper.isRunning();
+        if (action == LimitSwitch::ACTION_REPORT) {
+            // The task path has no ISR capture; measure it from the outside
+            long overrun = stepper.getCurrentPosition() - (long)edgeAt;
+            r.report.stops = 1;
+            r.report.stopUs = (tick - edgeTick) * 1000 - 370;
+            r.report.overrunSteps = overrun < 0 ? -overrun : overrun;
+        } else {
+            r.report = signals.getLastStop("END_SWITCH");
+        }
+        return r;
+    }
+}
+
+BENCH_CASE(limit_switch_stop) {
+    struct Case {
+        const char* label;
+        LimitSwitch::Action action;
+        StepperManager::ProfileMode mode;
+    };
+    const Case CASES[] = {
+        {"event subscriber -> mailbox stop", LimitSwitch::ACTION_REPORT, StepperManager::PROFILE_TRAPEZOID},
+        {"ISR forceStop", LimitSwitch::ACTION_FORCE_STOP, StepperManager::PROFILE_TRAPEZOID},
+        {"ISR stopDirection", LimitSwitch::ACTION_STOP_DIRECTION, StepperManager::PROFILE_TRAPEZOID},
+        {"ISR decelerate", LimitSwitch::ACTION_DECELERATE, StepperManager::PROFILE_TRAPEZOID},
+        {"ISR forceStop, S-curve move", LimitSwitch::ACTION_FORCE_STOP, StepperManager::PROFILE_SCURVE},
+        {"ISR decelerate, S-curve move", LimitSwitch::ACTION_DECELERATE, StepperManager::PROFILE_SCURVE},
+    };
+
+    printf("  cruising at 6400 steps/s, 30000 steps/s^2\n");
+    printf("  %-32s %10s %12s %10s\n", "reaction", "action us", "at rest us", "overrun");
+    for (const Case& c : CASES) {
+        Result r = runStop(c.action, c.mode);
+        printf("  %-32s %10lu %12lu %10ld%s\n", c.label, (unsigned long)r.report.actionUs,
+               (unsigned long)r.report.stopUs, (long)r.report.overrunSteps, r.stopped ? "" : "  STILL RUNNING");
+    }
+}
@@ -0,0 +1,167 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <Arduino.h>
+#include "bench.h"
+#include "logger.h"
+
+// What a log line costs its caller: Serial.printf() as the switch, LED, pin
+// and WebSocket code used to call it, against the Logger ring. On the ESP32
+// the printf cost is mostly waiting for the UART once its 128-byte FIFO is
+// full; the native Serial models that wait at 115200 baud without moving the
+// virtual clock, so it is reported next to the host time. "burst" writes 32
+// lines at once (a switch bouncing, a client connecting while homing), "every
+// 10 ms" one line per telemetry period.
+
+namespace {
+    const char* const SWITCH_ID = "HOME_SWITCH";
+    const int BURST = 32;
+
+    // Mean stall per call over count calls gapUs apart, from an idle UART
+    template<typename F>
+    double stallPerCall(int count, unsigned long gapUs, F&& fn) {
+        Serial.flush();
+        double before = Serial.txStallMicros();
+        for (int i = 0; i < count; i++) {
+            NativeClock::advanceMicros(gapUs);
+            fn();
+        }
+        return (Serial.txStallMicros() - before) / count;
+    }
+
+    template<typename F>
+    void row(const char* label, F&& fn) {
+        double ns = Bench::timeNs(200000, fn);
+        double burst = stallPerCall(BURST, 0, fn);
+        double steady = stallPerCall(BURST, 10000, fn);
+        Logger::drain();
+        printf("  %-36s %10.1f %12.1f %12.1f\n", label, ns, burst, steady);
+    }
+}
+
+BENCH_CASE(logger) {
+    printf("  %-36s %10s %12s %12s\n", "per call", "host ns", "stall us", "stall us");
+    printf("  %-36s %10s %12s %12s\n", "", "", "burst", "every 10 ms");
+    row("Serial.printf(), switch stop line", [] {
+        Serial.printf("Switch %s stopped the motor: engine told %lu us after the edge, at rest after %lu us, %ld steps past it\n",
+                      SWITCH_ID, 41UL, 5120UL, 3L);
+    });
+    row("Serial.printf() + flush(), LED init", [] {
+        Serial.printf("LED initialized on pin %d\n", 2);
+        Serial.flush();
+    });
+
+    Logger::startAsync();
+    row("LOG_INFO, switch stop line", [] {
+        LOG_INFO("Switch %s stopped the motor: engine told %lu us after the edge, at rest after %lu us, %ld steps past it",
+                 SWITCH_ID, 41UL, 5120UL, 3L);
+    });
+    row("LOG_INFO, short line", [] { LOG_INFO("LED initialized on pin %d", 2); });
+    row("LOG_DEBUG (compiled out)", [] { LOG_DEBUG("LedControl::on() called"); });
+    row("LOG_FROM_ISR", [] { LOG_FROM_ISR(LOG_LEVEL_INFO, "Edge at %ld", 1234); });
+
+    // The log task pays the UART instead, one ring's worth per 20 ms period
+    auto fill = [] {
+        for (int i = 0; i < BURST; i++) {
+            LOG_INFO("Switch %s stopped the motor: engine told %lu us after the edge, at rest after %lu us, %ld steps past it",
+                     SWITCH_ID, 41UL, 5120UL, (long)i);
+        }
+    };
+    double drainNs = (Bench::timeNs(2000, [&] { fill(); Logger::drain(); }) - Bench::timeNs(2000, fill)) / BURST;
+    Logger::drain();
+    fill();
+    Serial.flush();
+    double before = Serial.txStallMicros();
+    Logger::drain();
+    printf("  %-36s %10.1f %12.1f %12s\n", "Logger::drain(), per line (log task)", drainNs,
+           (Serial.txStallMicros() - before) / BURST, "-");
+    Logger::stopAsync();
+}
+
+namespace {
+    const int PRODUCERS = 3;
+
+    uint32_t check(int producer, long index) {
+        return ((uint32_t)producer * 2654435761u) ^ ((uint32_t)index * 40503u);
+    }
+
+    struct Reader {
+        long next[PRODUCERS + 1];
+        uint32_t outOfOrder;
+        uint32_t torn;
+    };
+
+    // Three tasks write numbered lines carrying a check value, in bursts with
+    // a pause between (pauseUs 0: flat out), and an "ISR" thread writes with
+    // writeFromIsr(); the log task drains on its own thread. The sink parses
+    // every line back: a bad check value or a line that does not parse is a
+    // torn read, a number going backwards a repeat. drained + dropped must add
+    // up to everything written.
+    void runThreads(const char* label, int perEach, int burst, int pauseUs) {
+        Reader reader = {};
+        Logger::setSink([&reader](Logger::Level, const char* line, size_t length) {
+            int producer;
+            long index;
+            unsigned long value;
+            bool intact = sscanf(line, "[T] P%d #%ld %lx", &producer, &index, &value) == 3 && producer >= 0 &&
+                          producer < PRODUCERS && value == check(producer, index) && strlen(line) == length;
+            if (!intact && sscanf(line, "I #%ld", &index) == 1) {
+                producer = PRODUCERS;
+                intact = true;
+            }
+            if (!intact) {
+                reader.torn++;
+                return;
+            }
+            if (index < reader.next[producer]) reader.outOfOrder++;
+            reader.next[producer] = index + 1;
+        });
+        Logger::Stats start = Logger::getStats();
+        Logger::startAsync();
+
+        std::atomic<bool> done(false);
+        std::thread drainer([&done] {
+            while (!done.load(std::memory_order_acquire)) {
+                if (Logger::drain() == 0) std::this_thread::yield();
+            }
+        });
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> writers;
+        for (int p = 0; p <= PRODUCERS; p++) {
+            writers.emplace_back([p, perEach, burst, pauseUs] {
+                for (long i = 0; i < perEach; i++) {
+                    if (p == PRODUCERS) {
+                        Logger::writeFromIsr(Logger::INFO, "I #%ld", i);
+                    } else {
+                        Logger::write(Logger::INFO, "T", "P%d #%ld %08lx", p, i, (unsigned long)check(p, i));
+                    }
+                    if (pauseUs && i % burst == burst - 1) std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+                }
+            });
+        }
+        for (auto& t : writers) t.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        done.store(true, std::memory_order_release);
+        drainer.join();
+        while (Logger::drain()) {}
+        Logger::stopAsync();
+        Logger::setSink(nullptr);
+
+        Logger::Stats stats = Logger::getStats();
+        uint32_t written = stats.written - start.written;
+        uint32_t drained = stats.drained - start.drained;
+        uint32_t dropped = stats.dropped - start.dropped;
+        bool ok = drained + dropped == written && reader.torn == 0 && reader.outOfOrder == 0;
+        printf("  %-30s %10.2f %10u %10u %10u %6u %6u%s\n", label, written / seconds / 1e6, written, drained, dropped,
+               reader.torn, reader.outOfOrder, ok ? "" : "  MISMATCH");
+    }
+}
+
+BENCH_CASE(logger_threads) {
+    printf("  %-30s %10s %10s %10s %10s %6s %6s\n", "3 tasks + 1 ISR, 1 drainer", "M lines/s", "written", "drained",
+           "dropped", "torn", "order");
+    runThreads("flat out, 100000 each", 100000, 1, 0);
+    runThreads("bursts of 8 every 200 us", 5000, 8, 200);
+}
@@ -0,0 +1,51 @@
+#include <cstring>
+#include <vector>
+#include <Arduino.h>
+#include "bench.h"
+
+namespace {
+    struct Case {
+        const char* name;
+        Bench::CaseFunc fn;
+    };
+
+    std::vector<Case>& cases() {
+        static std::vector<Case> registry;
+        return registry;
+    }
+
+    const char* g_dumpDir = nullptr;
+}
+
+const char* Bench::dumpDir() { return g_dumpDir; }
+
+Bench::Registrar::Registrar(const char* name, CaseFunc fn) {
+    cases().push_back({name, fn});
+}
+
+// Usage: program [-v] [-d dir] [filter]
+//   -v      keep firmware Serial output on stdout
+//   -d dir  let cases write files (e.g. display images) into dir
+//   filter  only run cases whose name contains this substring
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            g_dumpDir = argv[++i];
+        } else {
+            filter = argv[i];
+        }
+    }
+    Serial.setEcho(verbose);
+
+    for (const auto& c : cases()) {
+        if (filter && !strstr(c.name, filter)) continue;
+        printf("[%s]\n", c.name);
+        NativeClock::reset();
+        c.fn();
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <Arduino.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "motion_controller.h"
+#include "spsc_queue.h"
+#include "stepper_manager.h"
+
+// Stress tests for the motion mailbox with real threads: ordering and loss
+// on a bare SpscQueue, then every MotionController lane driven by its own
+// producer thread while a consumer thread stands in for the motion task.
+
+BENCH_CASE(spsc_queue_stress) {
+    const uint32_t items = 2000000;
+    static SpscQueue<uint32_t, 32> queue;
+    uint32_t outOfOrder = 0;
+    uint32_t received = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < items; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();  // Host may have fewer cores than threads
+            }
+        }
+    });
+    std::thread consumer([&] {
+        uint32_t expected = 0, value;
+        while (expected < items) {
+            if (!queue.pop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (value != expected) outOfOrder++;
+            expected = value + 1;
+            received++;
+        }
+    });
+    producer.join();
+    consumer.join();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("  %-40s %12.1f ns/item\n", "push+pop across threads", ns / items);
+    printf("  %-40s %12u / %u\n", "received", received, items);
+    printf("  %-40s %12u\n", "out of order", outOfOrder);
+    printf("  %-40s %12zu / %zu\n", "high water", queue.highWater(), queue.capacity());
+    printf("  %-40s %12u\n", "push() on full queue", queue.overflows());
+}
+
+BENCH_CASE(motion_mailbox_stress) {
+    DisplayManager display(128, 64);
+    StepperManager stepper(display);
+    MotionController motion(stepper);
+    stepper.init();
+
+    // Each producer owns one lane and retries when it is full, as a caller
+    // that must not lose a command would; the network handlers instead
+    // report "Motion queue full" to the client.
+    const uint32_t perProducer = 200000;
+    std::atomic<uint32_t> statusReads(0);
+    std::atomic<bool> done(false);
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread producers[MotionController::PRODUCER_COUNT];
+    for (int p = 0; p < MotionController::PRODUCER_COUNT; p++) {
+        producers[p] = std::thread([&, p] {
+            MotionCommand command = {MotionCommand::SET_SPEED, 0, 0.0f, 0.0f, 0};
+            for (uint32_t i = 0; i < perProducer; i++) {
+                command.real = 1000.0f + (i & 1023);
+                while (!motion.post((MotionController::Producer)p, command)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::thread consumer([&] {
+        while (!done.load()) {
+            motion.poll();
+            std::this_thread::yield();
+        }
+    });
+    // Telemetry stand-in: keep reading the published status meanwhile
+    std::thread reader([&] {
+        while (!done.load()) {
+            motion.status();
+            statusReads.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    });
+    for (auto& t : producers) t.join();
+
+    const uint32_t total = perProducer * MotionController::PRODUCER_COUNT;
+    while (motion.stats().processed < total &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    done = true;
+    consumer.join();
+    reader.join();
+
+    MotionController::Stats stats = motion.stats();
+    printf("  %-40s %12.1f ns/command\n", "post -> motion task", ns / total);
+    printf("  %-40s %12u / %u\n", "processed", stats.processed, total);
+    for (int p = 0; p < MotionController::PRODUCER_COUNT; p++) {
+        printf("  lane %d %-35s %12zu / %zu\n", p, "high water", stats.highWater[p], MotionController::QUEUE_CAPACITY);
+        printf("  lane %d %-35s %12u\n", p, "overflows", stats.overflows[p]);
+    }
+    printf("  %-40s %12u\n", "status() reads during run", statusReads.load());
+}
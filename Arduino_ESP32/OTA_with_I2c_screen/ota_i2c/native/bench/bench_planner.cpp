@@ -0,0 +1,71 @@
+#include <chrono>
+#include <Arduino.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "motion_controller.h"
+#include "stepper_manager.h"
+
+// Cycle time of an indexing job queued as segments, with and without
+// junction blending, simulated on the virtual clock with the motion task's
+// 1 ms tick. Host CPU per motion tick is reported as well.
+
+namespace {
+    // Eight stations out at varying feed rates, then a rapid return home
+    const MotionSegment JOB[] = {
+        {800, 6400, 0},   {1600, 6400, 0},  {2000, 2000, 0},  {2400, 2000, 0},
+        {4000, 8000, 0},  {5600, 8000, 0},  {6400, 4000, 0},  {8000, 6400, 0},
+        {0, 10000, 0},
+    };
+    const size_t JOB_SEGMENTS = sizeof(JOB) / sizeof(JOB[0]);
+
+    struct Result {
+        double cycleMs;
+        double hostNsPerTick;
+        long endPosition;
+    };
+
+    Result runJob(bool blending, int cycles) {
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        MotionController motion(stepper);
+        stepper.init();
+
+        MotionCommand blend = {MotionCommand::SET_BLENDING, blending ? 1 : 0, 0, 0, 0};
+        motion.post(MotionController::PRODUCER_LOCAL, blend);
+
+        Result r = {0, 0, 0};
+        double hostNs = 0;
+        unsigned long ticks = 0;
+        unsigned long start = millis();
+        for (int cycle = 0; cycle < cycles; cycle++) {
+            for (size_t i = 0; i < JOB_SEGMENTS; i++) {
+                MotionCommand command = {MotionCommand::QUEUE_SEGMENT, JOB[i].position, JOB[i].speed, JOB[i].accel, 0};
+                motion.post(MotionController::PRODUCER_LOCAL, command);
+            }
+            do {
+                auto t0 = std::chrono::steady_clock::now();
+                motion.poll();
+                hostNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+                ticks++;
+                MotionStatus status = motion.status();
+                if (status.queuedSegments == 0 && !status.running) break;
+                NativeClock::advanceMicros(1000);
+            } while (true);
+        }
+        r.cycleMs = (double)(millis() - start) / cycles;
+        r.hostNsPerTick = hostNs / ticks;
+        r.endPosition = stepper.getCurrentPosition();
+        return r;
+    }
+}
+
+BENCH_CASE(planner_blending) {
+    const int cycles = 5;
+    Result stopAndGo = runJob(false, cycles);
+    Result blended = runJob(true, cycles);
+
+    printf("  %-28s %12s %14s %12s\n", "mode", "cycle ms", "host ns/tick", "end pos");
+    printf("  %-28s %12.1f %14.1f %12ld\n", "stop at every segment", stopAndGo.cycleMs, stopAndGo.hostNsPerTick, stopAndGo.endPosition);
+    printf("  %-28s %12.1f %14.1f %12ld\n", "junction blending", blended.cycleMs, blended.hostNsPerTick, blended.endPosition);
+    printf("  %-28s %11.1f%%\n", "cycle time saved", 100.0 * (stopAndGo.cycleMs - blended.cycleMs) / stopAndGo.cycleMs);
+}
@@ -0,0 +1,199 @@
+#include <functional>
+#include <memory>
+#include <Arduino.h>
+#include "bench.h"
+#include "control_signal_handler.h"
+#include "display_manager.h"
+#include "flash_controller.h"
+#include "homing_sequence.h"
+#include "motion_controller.h"
+#include "position_memory.h"
+#include "stepper_manager.h"
+
+// Boot-to-ready after each kind of reset, on the rig of homing_sequence:
+// the axis (its physical position and the switches) outlives the firmware
+// objects, which are built again and initialised in setup()'s order for
+// every boot. "ready" is HomingSequence reporting homed; when PositionMemory
+// cannot restore the position that takes a homing run, timed on the virtual
+// clock. "frame" checks that a restored position puts the motor where it
+// physically is (the offset between the two must not change across the
+// reset). The OTA rows scramble RTC memory, as a new image with another
+// layout would, so only the flash copy written at shutdown can help.
+
+namespace {
+    const uint8_t HOME_PIN = 18;
+    const uint8_t END_PIN = 19;
+    const long HOME_EDGE = -12000;
+    const long END_EDGE = 28000;
+    const unsigned long TIMEOUT_MS = 120000;
+
+    struct Axis {
+        long physical = 0;
+        bool homeLevel = false;
+        bool endLevel = false;
+    };
+
+    struct Firmware {
+        DisplayManager display;
+        StepperManager stepper;
+        MotionController motion;
+        ControlSignalHandler signals;
+        HomingSequence homing;
+        unsigned long ticks = 0;
+
+        Firmware()
+            : display(128, 64), stepper(display), motion(stepper), signals(display, stepper),
+              homing(motion, signals) {}
+    };
+
+    std::unique_ptr<Firmware> boot(Axis& axis) {
+        NativeGpio::reset();
+        std::unique_ptr<Firmware> fw(new Firmware());
+        fw->stepper.init();
+        fw->signals.init();
+        fw->signals.addLimitSwitch(HOME_PIN, "HOME_SWITCH", false, LimitSwitch::ACTION_STOP_DIRECTION, -1);
+        fw->signals.addLimitSwitch(END_PIN, "END_SWITCH", false, LimitSwitch::ACTION_STOP_DIRECTION, 1);
+        NativeGpio::setLevel(HOME_PIN, axis.homeLevel);
+        NativeGpio::setLevel(END_PIN, axis.endLevel);
+        fw->homing.begin();
+        return fw;
+    }
+
+    // One motion tick (1 ms): the signals task every other one, the motor
+    // and the switch levels in 50 us steps
+    void tick(Firmware& fw, Axis& axis) {
+        fw.motion.poll();
+        if (fw.ticks++ % 2 == 0) {
+            fw.signals.handle();
+            fw.homing.update();
+        }
+        for (int sub = 0; sub < 20; sub++) {
+            long before = fw.stepper.getCurrentPosition();
+            NativeClock::advanceMicros(50);
+            axis.physical += fw.stepper.getCurrentPosition() - before;
+            if ((axis.physical <= HOME_EDGE) != axis.homeLevel) {
+                axis.homeLevel = !axis.homeLevel;
+                NativeGpio::setLevel(HOME_PIN, axis.homeLevel);
+            }
+            if ((axis.physical >= END_EDGE) != axis.endLevel) {
+                axis.endLevel = !axis.endLevel;
+                NativeGpio::setLevel(END_PIN, axis.endLevel);
+            }
+        }
+    }
+
+    // Milliseconds until homed, 0 if already; TIMEOUT_MS if it never was
+    unsigned long home(Firmware& fw, Axis& axis, bool measureTravel) {
+        if (fw.homing.status().homed) return 0;
+        HomingSequence::Settings settings = HomingSequence::defaults();
+        settings.measureTravel = measureTravel;
+        fw.homing.start(settings);
+        for (unsigned long ms = 1; ms < TIMEOUT_MS; ms++) {
+            tick(fw, axis);
+            HomingSequence::Status status = fw.homing.status();
+            if (status.phase == HomingSequence::DONE) return ms;
+            if (status.phase == HomingSequence::FAILED) break;
+        }
+        return TIMEOUT_MS;
+    }
+
+    void post(Firmware& fw, MotionCommand::Type type, int32_t value) {
+        MotionCommand command = {type, value, 0.0f, 0.0f, 0};
+        fw.motion.post(MotionController::PRODUCER_LOCAL, command);
+    }
+
+    void moveAndSettle(Firmware& fw, Axis& axis, int32_t position) {
+        post(fw, MotionCommand::MOVE_TO, position);
+        for (int ms = 0; ms < 20 || (fw.stepper.isRunning() && ms < 20000); ms++) tick(fw, axis);
+        for (int ms = 0; ms < 5; ms++) tick(fw, axis);
+    }
+}
+
+BENCH_CASE(position_memory) {
+    FlashController::init();
+    Axis axis;
+
+    // Cold start: the axis is wherever it is, nothing is trusted
+    ESP.powerCycle();
+    std::unique_ptr<Firmware> fw = boot(axis);
+    unsigned long fullMs = home(*fw, axis, true);
+    // Power-on again: a homing run with the stored travel
+    moveAndSettle(*fw, axis, 1000);
+    fw.reset();
+    ESP.powerCycle();
+    fw = boot(axis);
+    unsigned long storedMs = home(*fw, axis, false);
+    printf("  full homing (measure travel)            %8lu ms\n", fullMs);
+    printf("  homing with the stored travel           %8lu ms\n", storedMs);
+
+    unsigned long homingMs = 0, homings = 0;
+    printf("  %-30s %-11s %-11s %6s %6s %9s\n", "reset", "expected", "restored", "homed", "frame",
+           "ready ms");
+    auto row = [&](const char* label, int32_t restPosition, PositionMemory::Source expected,
+                   std::function<void()> reset) {
+        if (restPosition >= 0) moveAndSettle(*fw, axis, restPosition);
+        long offset = fw->stepper.getCurrentPosition() - axis.physical;
+        MotionStatus before = fw->motion.status();
+        reset();
+        fw.reset();  // The step engine stops with the CPU
+        fw = boot(axis);
+        PositionMemory::Snapshot snapshot;
+        PositionMemory::Source source = PositionMemory::restored(snapshot);
+        bool homed = fw->homing.status().homed;
+        bool frameKept = fw->stepper.getCurrentPosition() - axis.physical == offset &&
+                         fw->stepper.hasSoftLimits() == before.softLimits &&
+                         fw->stepper.getSoftMin() == before.softMin && fw->stepper.getSoftMax() == before.softMax;
+        unsigned long readyMs = home(*fw, axis, false);
+        if (source == PositionMemory::NONE) {
+            homingMs += readyMs;
+            homings++;
+        }
+        bool ok = source == expected && (source == PositionMemory::NONE || (homed && frameKept)) &&
+                  readyMs < TIMEOUT_MS;
+        printf("  %-30s %-11s %-11s %6s %6s %9lu%s\n", label, PositionMemory::sourceName(expected),
+               PositionMemory::sourceName(source), homed ? "yes" : "no",
+               source == PositionMemory::NONE ? "-" : (frameKept ? "kept" : "LOST"), readyMs,
+               ok ? "" : "  MISMATCH");
+    };
+
+    row("ESP.restart(), at rest", 9000, PositionMemory::RTC, [] { ESP.restart(); });
+    row("task watchdog, at rest", 3000, PositionMemory::RTC, [] { ESP.setResetReason(ESP_RST_TASK_WDT); });
+    row("panic, at rest", 15000, PositionMemory::RTC, [] { ESP.setResetReason(ESP_RST_PANIC); });
+    row("ESP.restart() while moving", -1, PositionMemory::NONE, [&] {
+        post(*fw, MotionCommand::MOVE_TO, 30000);
+        for (int ms = 0; ms < 300; ms++) tick(*fw, axis);
+        ESP.restart();
+    });
+    row("OTA (new RTC layout)", 5000, PositionMemory::FLASH, [] {
+        PositionMemory::saveToFlash();
+        FlashController::flush();
+        ESP.powerCycle();
+        ESP.setResetReason(ESP_RST_SW);
+    });
+    row("restart after it, RTC lost", 6000, PositionMemory::NONE, [] {
+        ESP.powerCycle();
+        ESP.setResetReason(ESP_RST_SW);
+    });
+    row("OTA while moving", -1, PositionMemory::NONE, [&] {
+        post(*fw, MotionCommand::MOVE_TO, 35000);
+        for (int ms = 0; ms < 300; ms++) tick(*fw, axis);
+        PositionMemory::saveToFlash();
+        FlashController::flush();
+        ESP.powerCycle();
+        ESP.setResetReason(ESP_RST_SW);
+    });
+    row("brownout, at rest", 7000, PositionMemory::NONE, [] { ESP.setResetReason(ESP_RST_BROWNOUT); });
+    row("EN pin, at rest", 8000, PositionMemory::NONE, [] { ESP.setResetReason(ESP_RST_EXT); });
+    row("power-on, at rest", 4000, PositionMemory::NONE, [] { ESP.powerCycle(); });
+
+    printf("  %-40s %8lu ms (mean of %lu; %lu ms measuring the travel)\n", "boot-to-ready saved by a restore",
+           homings ? homingMs / homings : 0, homings, fullMs);
+
+    Bench::measure("StepperManager::run(), at rest", 100000, [&] { fw->stepper.run(); });
+    Bench::measure("PositionMemory::atRest()", 100000, [&] { PositionMemory::atRest(1234, true, 50, 39950); });
+    PositionMemory::Snapshot snapshot;
+    ESP.setResetReason(ESP_RST_SW);
+    Bench::measure("PositionMemory::restore()", 10000, [&] { PositionMemory::restore(snapshot); });
+    fw.reset();
+    ESP.powerCycle();
+}
@@ -0,0 +1,39 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <native_tasks.h>
+#include "bench.h"
+#include "task_scheduler.h"
+
+// The firmware's task layout with synthetic loads, run on real threads for
+// two seconds of wall-clock time. Jitter here reflects the host OS scheduler,
+// not FreeRTOS, but the bookkeeping is the code that runs on the device.
+
+namespace {
+    void busyWaitUs(int64_t us) {
+        int64_t until = esp_timer_get_time() + us;
+        while (esp_timer_get_time() < until) {}
+    }
+}
+
+BENCH_CASE(task_scheduler) {
+    TaskScheduler::add({"motion", 1, 5, APP_CPU_NUM, 4096}, []() { busyWaitUs(20); });
+    TaskScheduler::add({"signals", 2, 4, APP_CPU_NUM, 4096}, []() { busyWaitUs(10); });
+    TaskScheduler::add({"telemetry", 10, 2, PRO_CPU_NUM, 6144}, []() { busyWaitUs(300); });
+    TaskScheduler::add({"display", 50, 1, APP_CPU_NUM, 4096}, []() { busyWaitUs(2000); });
+    TaskScheduler::add({"ota", 50, 1, PRO_CPU_NUM, 8192}, []() { busyWaitUs(50); });
+    TaskScheduler::start();
+    vTaskDelay(pdMS_TO_TICKS(2000));
+    NativeTasks::stopAll();
+
+    printf("  %-10s %6s %5s %4s %7s %9s %12s %12s %12s %12s\n", "task", "period", "prio", "core", "runs",
+           "overruns", "jitter avg", "jitter max", "exec avg", "exec max");
+    for (uint8_t i = 0; i < TaskScheduler::count(); i++) {
+        const TaskScheduler::TaskConfig& config = TaskScheduler::getConfig(i);
+        TaskScheduler::TaskStats stats = TaskScheduler::getStats(i);
+        printf("  %-10s %4ums %5u %4d %7u %9u %10lluus %10uus %10lluus %10uus\n", config.name,
+               (unsigned)config.periodMs, (unsigned)config.priority, (int)config.core, stats.runs, stats.overruns,
+               stats.runs ? (unsigned long long)(stats.totalJitterUs / stats.runs) : 0ULL, stats.maxJitterUs,
+               stats.runs ? (unsigned long long)(stats.totalExecUs / stats.runs) : 0ULL, stats.maxExecUs);
+    }
+    TaskScheduler::reset();
+}
@@ -0,0 +1,87 @@
+#include <chrono>
+#include <Arduino.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "scurve_profile.h"
+#include "stepper_manager.h"
+
+// Move time for a given distance with FastAccelStepper's trapezoid ramp and
+// with the jerk-limited S-curve profile, simulated on the virtual clock with
+// the motion task's 1 ms tick. Host cost of planning a move and of feeding
+// the command queue is reported as well.
+
+namespace {
+    const float SPEED = 6400;       // steps/s
+    const float ACCEL = 30000;      // steps/s^2
+    const float JERK = 2000000;     // steps/s^3
+
+    struct Result {
+        double moveMs;
+        long endPosition;
+    };
+
+    // busyCode: 100 ms into the move, the engine answers it to the next 20 queue entries
+    Result runMove(StepperManager::ProfileMode mode, float accel, long distance, int8_t busyCode = AQE_OK) {
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        stepper.init();
+        stepper.setSpeed(SPEED);
+        stepper.setAcceleration(accel);
+        stepper.setProfile(mode, JERK);
+
+        unsigned long start = millis();
+        stepper.moveTo(distance);
+        do {
+            NativeClock::advanceMicros(1000);
+            if (busyCode != AQE_OK && millis() - start == 100) FastAccelStepper::rejectEntries(busyCode, 20);
+            stepper.run();
+        } while (stepper.isRunning());
+        return {(double)(millis() - start), stepper.getCurrentPosition()};
+    }
+}
+
+BENCH_CASE(scurve_profile) {
+    const long DISTANCES[] = {200, 800, 3200, 12800};
+
+    printf("  speed %.0f steps/s, jerk %.0f steps/s^3\n", SPEED, JERK);
+    printf("  %-8s %14s %16s %16s %10s\n", "steps", "trap a=30k ms", "scurve a=30k ms", "scurve a=60k ms", "end pos");
+    for (long distance : DISTANCES) {
+        Result trapezoid = runMove(StepperManager::PROFILE_TRAPEZOID, ACCEL, distance);
+        Result scurve = runMove(StepperManager::PROFILE_SCURVE, ACCEL, distance);
+        Result scurveFast = runMove(StepperManager::PROFILE_SCURVE, 2 * ACCEL, distance);
+        bool exact = trapezoid.endPosition == distance && scurve.endPosition == distance &&
+                     scurveFast.endPosition == distance;
+        printf("  %-8ld %14.0f %16.0f %16.0f %10s\n", distance, trapezoid.moveMs, scurve.moveMs,
+               scurveFast.moveMs, exact ? "exact" : "MISSED");
+    }
+
+    // The engine refusing entries for a while must only delay the feed
+    const int8_t BUSY_CODES[] = {AQE_QUEUE_FULL, AQE_DIR_PIN_IS_BUSY, AQE_WAIT_FOR_ENABLE_PIN_ACTIVE, AQE_DEVICE_NOT_READY};
+    Result clean = runMove(StepperManager::PROFILE_SCURVE, ACCEL, 12800);
+    printf("  %-30s %10s %10s\n", "12800 steps, engine busy", "move ms", "end pos");
+    for (int8_t code : BUSY_CODES) {
+        Result busy = runMove(StepperManager::PROFILE_SCURVE, ACCEL, 12800, code);
+        char label[32];
+        snprintf(label, sizeof(label), "addQueueEntry() -> %d", code);
+        printf("  %-30s %10.0f %10s\n", label, busy.moveMs,
+               busy.endPosition == 12800 && busy.moveMs >= clean.moveMs ? "exact" : "MISSED");
+    }
+
+    static SCurveProfile profile;
+    double planNs = Bench::measure("plan 12800-step move", 200, [&] { profile.plan(12800, SPEED, ACCEL, JERK); });
+    printf("  %-40s %12u\n", "ramp table bytes", (unsigned)(profile.rampSteps() * sizeof(uint32_t)));
+
+    uint32_t steps = 0;
+    uint32_t entries = 0;
+    double feedNs = Bench::timeNs(20, [&] {
+        steps = 0;
+        entries = 0;
+        stepper_command_s cmd;
+        profile.plan(12800, SPEED, ACCEL, JERK);
+        while (profile.nextCommand(cmd)) {
+            steps += cmd.steps;
+            entries++;
+        }
+    });
+    printf("  %-40s %12.1f ns/step (%u entries)\n", "feed queue, integer only", (feedNs - planNs) / steps, (unsigned)entries);
+}
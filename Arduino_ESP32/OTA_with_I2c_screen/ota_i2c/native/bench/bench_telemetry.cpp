@@ -0,0 +1,87 @@
+#include <chrono>
+#include <Arduino.h>
+#include <WiFi.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "motion_controller.h"
+#include "pin_manager.h"
+#include "server_manager.h"
+#include "stepper_manager.h"
+
+// Bytes/s on the wire and host CPU spent in handleClient() per subscribed
+// client, for each telemetry format at each rate, while the motor shuttles
+// between two positions for 10 s of virtual time.
+
+namespace {
+    struct Result {
+        double bytesPerSecond;
+        double framesPerSecond;
+        double cpuUsPerSecond;
+    };
+
+    Result runTelemetry(const char* request, unsigned simSeconds = 10) {
+        DisplayManager display(128, 64);
+        StepperManager stepper(display);
+        MotionController motion(stepper);
+        PinManager pinManager(display);
+        ControlSignalHandler signals(display, stepper);
+        HomingSequence homing(motion, signals);
+        ServerManager server(display, motion, pinManager, signals, homing);
+        stepper.init();
+        server.init();
+
+        AsyncWebSocketClient* client = server.webSocket().connect();
+        client->keepFrames(false);
+        if (request) server.webSocket().receiveText(client, request);
+        unsigned long long bytesBefore = client->bytesSent();
+        unsigned long framesBefore = client->framesSent();
+
+        double cpuNs = 0;
+        long target = 8000;
+        for (unsigned long ms = 0; ms < simSeconds * 1000UL; ms++) {
+            NativeClock::advanceMicros(1000);
+            if (!stepper.isRunning()) {
+                target = -target;
+                stepper.moveTo(target);
+            }
+            motion.poll();  // Stands in for the motion task publishing status
+            if (ms % 500 == 0) {
+                WiFi.setRSSI(-50 - (ms / 500) % 7);
+                ESP.setFreeHeap(240000 - (ms / 500) % 13 * 32);
+            }
+            auto start = std::chrono::steady_clock::now();
+            server.handleClient();
+            cpuNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        Result r;
+        r.bytesPerSecond = (double)(client->bytesSent() - bytesBefore) / simSeconds;
+        r.framesPerSecond = (double)(client->framesSent() - framesBefore) / simSeconds;
+        r.cpuUsPerSecond = cpuNs / 1000.0 / simSeconds;
+        return r;
+    }
+}
+
+BENCH_CASE(telemetry_rates) {
+    const unsigned rates[] = {4, 10, 25, 50, 100};
+    const struct {
+        const char* name;
+        const char* format;
+        bool delta;
+    } modes[] = {
+        {"json", "json", false},
+        {"binary", "binary", false},
+        {"binary+delta", "binary", true},
+    };
+
+    printf("  %-14s %6s %10s %12s %14s\n", "format", "Hz", "frames/s", "bytes/s", "host us/s");
+    for (const auto& mode : modes) {
+        for (unsigned rate : rates) {
+            char request[96];
+            snprintf(request, sizeof(request), "{\"cmd\":\"telemetry\",\"format\":\"%s\",\"rate\":%u,\"delta\":%s}",
+                     mode.format, rate, mode.delta ? "true" : "false");
+            Result r = runTelemetry(request);
+            printf("  %-14s %6u %10.1f %12.1f %14.1f\n", mode.name, rate, r.framesPerSecond, r.bytesPerSecond, r.cpuUsPerSecond);
+        }
+    }
+}
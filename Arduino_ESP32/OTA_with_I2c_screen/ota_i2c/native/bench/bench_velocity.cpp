@@ -0,0 +1,100 @@
+#include <cmath>
+#include <cstdlib>
+#include <Arduino.h>
+#include <FastAccelStepper.h>
+#include "bench.h"
+#include "velocity_estimator.h"
+
+// Speed/acceleration estimates against the simulated engine's true speed over
+// a trapezoid move, with the motion task's 1 ms tick jittered by up to
+// +-200 us. The baseline is the old millis() differencing, shared by a 4 Hz
+// status broadcast and a 10 Hz poller that reset each other's reference.
+
+namespace {
+    // What StepperManager::getCurrentSpeed() used to do
+    struct MillisDifferencing {
+        long lastPosition = 0;
+        unsigned long lastTime = 0;
+        float speed = 0.0f;
+
+        float sample(long position) {
+            unsigned long now = millis();
+            if (lastTime > 0 && now > lastTime) speed = (position - lastPosition) / ((now - lastTime) / 1000.0f);
+            lastPosition = position;
+            lastTime = now;
+            return speed;
+        }
+    };
+
+    struct Error {
+        double sumSq = 0;
+        double max = 0;
+        unsigned long count = 0;
+
+        void add(double error) {
+            sumSq += error * error;
+            max = std::fmax(max, std::fabs(error));
+            count++;
+        }
+        double rms() const { return count ? std::sqrt(sumSq / count) : 0; }
+    };
+}
+
+BENCH_CASE(velocity_estimator) {
+    FastAccelStepperEngine engine;
+    FastAccelStepper* stepper = engine.stepperConnectToPin(13);
+    stepper->setSpeedInHz(6400);
+    stepper->setAcceleration(30000);
+    stepper->moveTo(20000);
+
+    VelocityEstimator estimator;
+    MillisDifferencing legacy;
+    float legacySpeed = 0;
+    Error estSpeed, estAccel, legacyError;
+    srand(1);
+
+    double lastTrue = 0;
+    unsigned long nextBroadcast = millis(), nextPoll = millis();
+    while (stepper->isRunning()) {
+        NativeClock::advanceMicros(800 + rand() % 401);
+        double trueSpeed = stepper->getCurrentSpeedInMilliHz() / 1000.0;
+        long position = stepper->getCurrentPosition();
+
+        // Skip the first window while the estimator fills
+        if (estimator.addSample(micros(), position) && estimator.size() == VelocityEstimator::WINDOW) {
+            estSpeed.add(estimator.speed() - trueSpeed);
+            // True acceleration is +-30000 or 0; only compare away from its steps
+            double trueAccel = trueSpeed > lastTrue + 1 ? 30000 : (trueSpeed < lastTrue - 1 ? -30000 : 0);
+            if (std::fabs(trueSpeed) > 400 && std::fabs(trueSpeed) < 6000) estAccel.add(estimator.acceleration() - trueAccel);
+        }
+        lastTrue = trueSpeed;
+
+        if (millis() >= nextBroadcast) {
+            legacySpeed = legacy.sample(position);
+            nextBroadcast += 250;
+        }
+        if (millis() >= nextPoll) {
+            legacySpeed = legacy.sample(position);
+            nextPoll += 100;
+        }
+        legacyError.add(legacySpeed - trueSpeed);
+    }
+
+    printf("  %-40s %12s %12s\n", "speed error (steps/s)", "rms", "max");
+    printf("  %-40s %12.1f %12.1f\n", "millis() differencing, two callers", legacyError.rms(), legacyError.max);
+    printf("  %-40s %12.1f %12.1f\n", "quadratic fit, 32 x 1 ms samples", estSpeed.rms(), estSpeed.max);
+    printf("  %-40s %12.1f %12.1f\n", "acceleration error (steps/s^2)", estAccel.rms(), estAccel.max);
+
+    VelocityEstimator timing;
+    uint32_t t = 0;
+    int32_t p = 0;
+    Bench::measure("addSample() incl. fit", 100000, [&] {
+        t += VelocityEstimator::SAMPLE_INTERVAL_US;
+        p += 6;
+        timing.addSample(t, p);
+    });
+    Bench::measure("speed() getter", 1000000, [&] {
+        volatile float v = timing.speed();
+        (void)v;
+    });
+}
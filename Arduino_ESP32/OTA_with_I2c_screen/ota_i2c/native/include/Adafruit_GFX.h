@@ -0,0 +1,55 @@
+#ifndef NATIVE_ADAFRUIT_GFX_H
+#define NATIVE_ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+// Subset of Adafruit_GFX: pixel primitives and the classic 5x7 text renderer
+// with the same cursor/wrap behaviour, so text lands on the same pixels as on
+// the real panel.
+class Adafruit_GFX {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+    virtual ~Adafruit_GFX() {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    void setTextSize(uint8_t s) { _textSize = s > 0 ? s : 1; }
+    void setTextColor(uint16_t c) { _textColor = _textBg = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { _textColor = c; _textBg = bg; }
+    void setTextWrap(bool w) { _wrap = w; }
+
+    size_t write(uint8_t c);
+    size_t print(const char* s);
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t print(double v, int digits = 2) { return print(String(v, digits)); }
+    size_t println() { return write('\n'); }
+    template<typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t _cursorX = 0;
+    int16_t _cursorY = 0;
+    uint16_t _textColor = 0xFFFF;
+    uint16_t _textBg = 0xFFFF;
+    uint8_t _textSize = 1;
+    bool _wrap = true;
+};
+
+#endif // NATIVE_ADAFRUIT_GFX_H
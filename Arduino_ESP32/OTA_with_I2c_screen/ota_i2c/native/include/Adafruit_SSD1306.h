@@ -0,0 +1,59 @@
+#ifndef NATIVE_ADAFRUIT_SSD1306_H
+#define NATIVE_ADAFRUIT_SSD1306_H
+
+#include <vector>
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+#define SSD1306_MEMORYMODE 0x20
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+
+// Framebuffer-backed SSD1306. display() pushes the buffer through TwoWire
+// with the same framing as the Adafruit driver (command list, then 0x40 data
+// chunks of WIRE_MAX bytes), so Wire's byte counters match the real traffic.
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    static const size_t WIRE_MAX = 128;
+
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
+               bool reset = true, bool periphBegin = true);
+    void display();
+    void clearDisplay();
+    void invertDisplay(bool i) { ssd1306_command(i ? 0xA7 : 0xA6); }
+    void dim(bool dim) { ssd1306_command(0x81); ssd1306_command(dim ? 0 : 0xCF); }
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y) const;
+    uint8_t* getBuffer() { return _buffer.data(); }
+    void ssd1306_command(uint8_t c);
+
+    TwoWire* wire() const { return _wire; }
+    uint8_t i2cAddress() const { return _address; }
+    uint32_t clockDuringTransfer() const { return _clkDuring; }
+    uint32_t clockAfterTransfer() const { return _clkAfter; }
+
+private:
+    void _commandList(const uint8_t* c, uint8_t n);
+
+    TwoWire* _wire;
+    std::vector<uint8_t> _buffer;
+    uint8_t _address = 0x3C;
+    uint32_t _clkDuring;
+    uint32_t _clkAfter;
+};
+
+#endif // NATIVE_ADAFRUIT_SSD1306_H
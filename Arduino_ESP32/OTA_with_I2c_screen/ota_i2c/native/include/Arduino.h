@@ -0,0 +1,170 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host-side stand-in for the Arduino-ESP32 core (env:native only).
+// Time is virtual (see native_clock.h), GPIO levels live in a plain array and
+// interrupts attached with attachInterruptArg() fire synchronously when a test
+// drives a pin through NativeGpio::setLevel().
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+#include <algorithm>
+#include "WString.h"
+#include "native_clock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+// RTC slow memory, kept across every reset but power-on; on the host a
+// section of its own that ESP.powerCycle() scrambles
+#define RTC_NOINIT_ATTR __attribute__((section("rtc_noinit")))
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT         0x01
+#define OUTPUT        0x03
+#define PULLUP        0x04
+#define INPUT_PULLUP  0x05
+#define PULLDOWN      0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define ESP_INTR_FLAG_IRAM (1 << 10)
+
+typedef uint8_t byte;
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+// GPIO
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+inline esp_err_t esp_intr_alloc(int, int, void (*)(void*), void*, void*) { return ESP_OK; }
+
+namespace NativeGpio {
+    static const int PIN_COUNT = 40;
+    // Drive an input pin from a test; fires any attached interrupt on an edge.
+    void setLevel(uint8_t pin, bool level);
+    bool getLevel(uint8_t pin);
+    uint8_t getMode(uint8_t pin);
+    void reset();
+}
+
+// Serial
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { _baud = baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+    size_t print(const char* s);
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c) { char b[2] = {c, 0}; return print(b); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println() { return print("\r\n"); }
+    template<typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t write(const uint8_t* data, size_t len);
+    void flush();
+
+    // Host controls: silence output (benchmarks) and count what would have
+    // been sent over the UART.
+    void setEcho(bool echo) { _echo = echo; }
+    size_t bytesWritten() const { return _bytesWritten; }
+    // How long the callers of write() and flush() would have been blocked
+    // by a UART with a TX_FIFO-byte FIFO at the baud rate (8N1). The virtual
+    // clock does not move while they "wait".
+    double txStallMicros() const { return _txStallUs; }
+
+    static const size_t TX_FIFO = 128;
+
+private:
+    unsigned long _baud = 115200;
+    bool _echo = true;
+    size_t _bytesWritten = 0;
+    double _txIdleUs = 0;    // When the FIFO runs empty, on the writers' clock
+    double _txStallUs = 0;
+    unsigned long _txLastMicros = 0;
+
+    double writerMicros();   // micros() plus the stalls so far
+};
+
+extern HardwareSerial Serial;
+
+// ESP system
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return _freeHeap; }
+    uint32_t getHeapSize() { return 327680; }
+    uint32_t getMinFreeHeap() { return _freeHeap; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreeSketchSpace() { return 1310720; }
+    uint32_t getSketchSize() { return 917504; }
+    void restart();  // Makes the next boot's reset reason ESP_RST_SW
+
+    void setFreeHeap(uint32_t bytes) { _freeHeap = bytes; }
+    unsigned restartCount() const { return _restarts; }
+    // What esp_reset_reason() reports; a test "reboots" by constructing the
+    // firmware objects again
+    void setResetReason(esp_reset_reason_t reason) { _resetReason = reason; }
+    esp_reset_reason_t resetReason() const { return _resetReason; }
+    void powerCycle();  // RTC_NOINIT_ATTR variables lose their contents, reason ESP_RST_POWERON
+
+private:
+    uint32_t _freeHeap = 240000;
+    unsigned _restarts = 0;
+    esp_reset_reason_t _resetReason = ESP_RST_POWERON;
+};
+
+extern EspClass ESP;
+
+inline void esp_restart() { ESP.restart(); }
+inline esp_reset_reason_t esp_reset_reason() { return ESP.resetReason(); }
+inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_add(void*) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
+
+#endif // NATIVE_ARDUINO_H
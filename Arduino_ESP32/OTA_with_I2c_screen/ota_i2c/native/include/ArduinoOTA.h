@@ -0,0 +1,45 @@
+#ifndef NATIVE_ARDUINO_OTA_H
+#define NATIVE_ARDUINO_OTA_H
+
+#include <functional>
+#include "Arduino.h"
+
+typedef enum {
+    OTA_AUTH_ERROR,
+    OTA_BEGIN_ERROR,
+    OTA_CONNECT_ERROR,
+    OTA_RECEIVE_ERROR,
+    OTA_END_ERROR
+} ota_error_t;
+
+// Stores the callbacks so a host harness can replay an update session.
+class ArduinoOTAClass {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+    typedef std::function<void(ota_error_t)> THandlerFunction_Error;
+    typedef std::function<void(unsigned int, unsigned int)> THandlerFunction_Progress;
+
+    ArduinoOTAClass& setHostname(const char*) { return *this; }
+    ArduinoOTAClass& setPassword(const char*) { return *this; }
+    ArduinoOTAClass& onStart(THandlerFunction fn) { _start = fn; return *this; }
+    ArduinoOTAClass& onEnd(THandlerFunction fn) { _end = fn; return *this; }
+    ArduinoOTAClass& onError(THandlerFunction_Error fn) { _error = fn; return *this; }
+    ArduinoOTAClass& onProgress(THandlerFunction_Progress fn) { _progress = fn; return *this; }
+    void begin(bool = true) {}
+    void handle() {}
+
+    void simulateStart() { if (_start) _start(); }
+    void simulateProgress(unsigned int progress, unsigned int total) { if (_progress) _progress(progress, total); }
+    void simulateEnd() { if (_end) _end(); }
+    void simulateError(ota_error_t error) { if (_error) _error(error); }
+
+private:
+    THandlerFunction _start;
+    THandlerFunction _end;
+    THandlerFunction_Error _error;
+    THandlerFunction_Progress _progress;
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif // NATIVE_ARDUINO_OTA_H
@@ -0,0 +1,60 @@
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// RAM-backed EEPROM emulation. commit() copies the working buffer into the
+// "flash" image and counts the commit so benchmarks can report wear.
+class EEPROMClass {
+public:
+    bool begin(size_t size) {
+        _size = size;
+        _data.assign(size, 0xFF);
+        if (_flash.size() != size) _flash.assign(size, 0xFF);
+        memcpy(_data.data(), _flash.data(), size);
+        return true;
+    }
+    void end() {}
+
+    uint8_t read(int address) const {
+        return address >= 0 && (size_t)address < _size ? _data[address] : 0;
+    }
+    void write(int address, uint8_t value) {
+        if (address >= 0 && (size_t)address < _size) _data[address] = value;
+    }
+    bool commit() {
+        _flash = _data;
+        _commits++;
+        _bytesCommitted += _size;
+        return true;
+    }
+
+    template<typename T> T& get(int address, T& value) {
+        if (address >= 0 && address + sizeof(T) <= _size) memcpy(&value, &_data[address], sizeof(T));
+        return value;
+    }
+    template<typename T> const T& put(int address, const T& value) {
+        if (address >= 0 && address + sizeof(T) <= _size) memcpy(&_data[address], &value, sizeof(T));
+        return value;
+    }
+
+    size_t length() const { return _size; }
+
+    // Host controls
+    unsigned long commitCount() const { return _commits; }
+    unsigned long long bytesCommitted() const { return _bytesCommitted; }
+    void resetStats() { _commits = 0; _bytesCommitted = 0; }
+
+private:
+    size_t _size = 0;
+    std::vector<uint8_t> _data;
+    std::vector<uint8_t> _flash;
+    unsigned long _commits = 0;
+    unsigned long long _bytesCommitted = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // NATIVE_EEPROM_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_ESP_H
+#define NATIVE_ESP_H
+
+#include "Arduino.h"
+
+#endif // NATIVE_ESP_H
@@ -0,0 +1,264 @@
+#ifndef NATIVE_ESP_ASYNC_WEB_SERVER_H
+#define NATIVE_ESP_ASYNC_WEB_SERVER_H
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+#include "WiFi.h"
+
+// In-process model of ESPAsyncWebServer. Routes are registered exactly as on
+// the device; a host harness injects requests with AsyncWebServer::dispatch()
+// and WebSocket traffic through AsyncWebSocket::connect()/receive(), and reads
+// back what would have gone over the wire.
+
+typedef enum {
+    HTTP_GET     = 0b00000001,
+    HTTP_POST    = 0b00000010,
+    HTTP_DELETE  = 0b00000100,
+    HTTP_PUT     = 0b00001000,
+    HTTP_PATCH   = 0b00010000,
+    HTTP_HEAD    = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebParameter {
+public:
+    AsyncWebParameter(const String& name, const String& value, bool form = false)
+        : _name(name), _value(value), _isForm(form) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+    bool isPost() const { return _isForm; }
+
+private:
+    String _name;
+    String _value;
+    bool _isForm;
+};
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+class AsyncWebServerResponse {
+public:
+    AsyncWebServerResponse(int code, const String& contentType, const uint8_t* content, size_t len)
+        : _code(code), _contentType(contentType), _content(content, content + len) {}
+    void addHeader(const String& name, const String& value) { _headers.emplace_back(name, value); }
+    void setContentLength(size_t) {}
+
+    int code() const { return _code; }
+    const String& contentType() const { return _contentType; }
+    const std::vector<uint8_t>& content() const { return _content; }
+    const std::vector<AsyncWebHeader>& headers() const { return _headers; }
+    const AsyncWebHeader* header(const char* name) const;
+
+protected:
+    int _code;
+    String _contentType;
+    std::vector<uint8_t> _content;
+    std::vector<AsyncWebHeader> _headers;
+};
+
+// Response built with write(), copied as it is written (the library buffers it in a cbuf)
+class AsyncResponseStream : public AsyncWebServerResponse {
+public:
+    explicit AsyncResponseStream(const String& contentType) : AsyncWebServerResponse(200, contentType, nullptr, 0) {}
+    void setCode(int code) { _code = code; }
+    size_t write(const uint8_t* data, size_t len) {
+        _content.insert(_content.end(), data, data + len);
+        return len;
+    }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+};
+
+class AsyncWebServerRequest {
+public:
+    AsyncWebServerRequest(WebRequestMethodComposite method, const String& url) : _method(method), _url(url) {}
+    ~AsyncWebServerRequest() { free(_tempObject); }
+    AsyncWebServerRequest(const AsyncWebServerRequest&) = delete;
+    AsyncWebServerRequest& operator=(const AsyncWebServerRequest&) = delete;
+
+    void* _tempObject = nullptr;  // Handler scratch space, free()d with the request as in the library
+
+    WebRequestMethodComposite method() const { return _method; }
+    const String& url() const { return _url; }
+
+    bool hasParam(const String& name, bool post = false, bool file = false) const { return getParam(name, post, file) != nullptr; }
+    AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const;
+    size_t params() const { return _params.size(); }
+    bool hasHeader(const String& name) const { return getHeader(name) != nullptr; }
+    AsyncWebHeader* getHeader(const String& name) const;
+
+    void send(int code, const String& contentType = String(), const String& content = String());
+    void send(AsyncWebServerResponse* response);
+    void send_P(int code, const String& contentType, const uint8_t* content, size_t len);
+    void send_P(int code, const String& contentType, const char* content);
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(), const String& content = String());
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const uint8_t* content, size_t len);
+    AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460) {
+        return new AsyncResponseStream(contentType);
+    }
+    void redirect(const String& url);
+
+    // Host side
+    void addParam(const String& name, const String& value, bool form = true) { _params.emplace_back(new AsyncWebParameter(name, value, form)); }
+    void addHeader(const String& name, const String& value) { _headers.emplace_back(new AsyncWebHeader(name, value)); }
+    const AsyncWebServerResponse* response() const { return _response.get(); }
+
+private:
+    WebRequestMethodComposite _method;
+    String _url;
+    std::vector<std::unique_ptr<AsyncWebParameter>> _params;
+    std::vector<std::unique_ptr<AsyncWebHeader>> _headers;
+    std::unique_ptr<AsyncWebServerResponse> _response;
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+};
+
+// WebSocket
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+typedef enum { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING } AwsClientStatus;
+
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocket;
+
+class AsyncWebSocketClient {
+public:
+    AsyncWebSocketClient(AsyncWebSocket* server, uint32_t id) : _server(server), _id(id) {}
+
+    uint32_t id() const { return _id; }
+    IPAddress remoteIP() const { return IPAddress(10, 0, 1, 100); }
+    AwsClientStatus status() const { return _status; }
+    AsyncWebSocket* server() const { return _server; }
+    bool canSend() const { return _status == WS_CONNECTED; }
+    bool queueIsFull() const { return false; }
+
+    void text(const char* message, size_t len) { _record(WS_TEXT, (const uint8_t*)message, len); }
+    void text(const char* message) { text(message, strlen(message)); }
+    void text(const String& message) { text(message.c_str(), message.length()); }
+    void binary(const uint8_t* message, size_t len) { _record(WS_BINARY, message, len); }
+    void binary(const char* message, size_t len) { binary((const uint8_t*)message, len); }
+    void close() { _status = WS_DISCONNECTED; }
+
+    // Host side
+    struct Frame {
+        AwsFrameType type;
+        std::vector<uint8_t> data;
+    };
+    const std::vector<Frame>& sent() const { return _sent; }
+    void clearSent() { _sent.clear(); }
+    void keepFrames(bool keep) { _keepFrames = keep; }
+    unsigned long long bytesSent() const { return _bytesSent; }
+    unsigned long framesSent() const { return _framesSent; }
+    void setStatus(AwsClientStatus status) { _status = status; }
+
+private:
+    void _record(AwsFrameType type, const uint8_t* data, size_t len) {
+        if (_status != WS_CONNECTED) return;
+        _bytesSent += len;
+        _framesSent++;
+        if (_keepFrames) _sent.push_back({type, std::vector<uint8_t>(data, data + len)});
+    }
+
+    AsyncWebSocket* _server;
+    uint32_t _id;
+    AwsClientStatus _status = WS_CONNECTED;
+    std::vector<Frame> _sent;
+    bool _keepFrames = true;
+    unsigned long long _bytesSent = 0;
+    unsigned long _framesSent = 0;
+};
+
+typedef std::function<void(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+    explicit AsyncWebSocket(const String& url) : _url(url) {}
+
+    void onEvent(AwsEventHandler handler) { _handler = handler; }
+    size_t count() const;
+    AsyncWebSocketClient* client(uint32_t id);
+    void cleanupClients(uint16_t maxClients = 8) {}
+    void textAll(const char* message, size_t len);
+    void textAll(const char* message) { textAll(message, strlen(message)); }
+    void textAll(const String& message) { textAll(message.c_str(), message.length()); }
+    void binaryAll(const uint8_t* message, size_t len);
+    void text(uint32_t id, const char* message, size_t len);
+    void binary(uint32_t id, const uint8_t* message, size_t len);
+
+    // Host side
+    AsyncWebSocketClient* connect();
+    void disconnect(uint32_t id);
+    void receive(AsyncWebSocketClient* client, AwsFrameType type, const uint8_t* data, size_t len);
+    void receiveText(AsyncWebSocketClient* client, const char* message) { receive(client, WS_TEXT, (const uint8_t*)message, strlen(message)); }
+    std::list<AsyncWebSocketClient>& getClients() { return _clients; }
+
+private:
+    String _url;
+    AwsEventHandler _handler;
+    std::list<AsyncWebSocketClient> _clients;
+    uint32_t _nextId = 1;
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port) : _port(port) {}
+
+    void begin() { _started = true; }
+    void end() { _started = false; }
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler) { _handlers.push_back(handler); return *handler; }
+    void on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+    void on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+            ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody = nullptr);
+    void onNotFound(ArRequestHandlerFunction fn) { _notFound = fn; }
+
+    // Host side: run the handler registered for (method, url). The request's
+    // response is available afterwards; returns false if no route matched.
+    bool dispatch(AsyncWebServerRequest& request, const uint8_t* body = nullptr, size_t bodyLen = 0);
+
+private:
+    struct Route {
+        String uri;
+        WebRequestMethodComposite method;
+        ArRequestHandlerFunction onRequest;
+        ArBodyHandlerFunction onBody;
+    };
+
+    uint16_t _port;
+    bool _started = false;
+    std::vector<Route> _routes;
+    std::vector<AsyncWebHandler*> _handlers;
+    ArRequestHandlerFunction _notFound;
+};
+
+#endif // NATIVE_ESP_ASYNC_WEB_SERVER_H
@@ -0,0 +1,118 @@
+#ifndef NATIVE_FAST_ACCEL_STEPPER_H
+#define NATIVE_FAST_ACCEL_STEPPER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#define MOVE_OK 0
+#define MOVE_ERR_NO_DIRECTION_PIN -1
+#define MOVE_ERR_SPEED_IS_UNDEFINED -2
+#define MOVE_ERR_ACCELERATION_IS_UNDEFINED -3
+
+// Raw command queue, as on the ESP32 (16 MHz step timer, 32 entries)
+#define TICKS_PER_S 16000000L
+#define MIN_CMD_TICKS (TICKS_PER_S / 5000)
+#define QUEUE_LEN 32
+
+// Positive: try again later; negative: the entry is invalid
+#define AQE_OK 0
+#define AQE_QUEUE_FULL 1
+#define AQE_DIR_PIN_IS_BUSY 2
+#define AQE_WAIT_FOR_ENABLE_PIN_ACTIVE 3
+#define AQE_DEVICE_NOT_READY 4
+#define AQE_ERROR_TICKS_TOO_LOW -1
+#define AQE_ERROR_EMPTY_QUEUE_TO_START -2
+#define AQE_ERROR_NO_DIR_PIN_TO_TOGGLE -3
+
+// One queue entry: `steps` steps (0 = pause) spaced `ticks` apart
+struct stepper_command_s {
+    uint16_t ticks;
+    uint8_t steps;
+    bool count_up;
+};
+
+// Kinematic model of a FastAccelStepper channel running on the virtual clock.
+// Every call first integrates the trapezoidal ramp (or plays the raw command
+// queue) up to NativeClock::now(), so position and speed are what the real
+// step generator would report at that instant.
+class FastAccelStepper {
+public:
+    void setDirectionPin(uint8_t pin, bool dirHighCountsUp = true, uint16_t dir_change_delay_us = 0) { _dirPin = pin; }
+    void setEnablePin(uint8_t pin, bool low_active_enables_stepper = true) { _enablePin = pin; }
+    void setAutoEnable(bool autoEnable) { _autoEnable = autoEnable; }
+
+    int8_t setSpeedInHz(uint32_t speed_hz);
+    int8_t setAcceleration(int32_t step_s_s);
+    void applySpeedAcceleration();
+    uint32_t getSpeedInMilliHz() const { return (uint32_t)(_maxSpeed * 1000.0); }
+    uint32_t getAcceleration() const { return (uint32_t)_accel; }
+
+    int8_t moveTo(int32_t position, bool blocking = false);
+    int8_t move(int32_t move, bool blocking = false);
+    int8_t runForward();
+    int8_t runBackward();
+    void stopMove();
+    void forceStop();
+    void forceStopAndNewPosition(int32_t new_pos);
+
+    bool isRunning();
+    int32_t getCurrentPosition();
+    void setCurrentPosition(int32_t new_pos);
+    int32_t targetPos();
+    int32_t getCurrentSpeedInMilliHz();
+
+    // Raw queue: only while the ramp generator is idle
+    int8_t addQueueEntry(const stepper_command_s* cmd, bool start = true);
+    bool isQueueEmpty();
+    bool isQueueFull();
+
+    void enableOutputs() { _outputsEnabled = true; }
+    void disableOutputs() { _outputsEnabled = false; }
+    bool outputsEnabled() const { return _outputsEnabled; }
+
+    // Host controls
+    uint64_t stepsGenerated() const { return _stepsGenerated; }
+    // The next count addQueueEntry() calls of any stepper return code and queue nothing
+    static void rejectEntries(int8_t code, uint16_t count);
+
+private:
+    enum class Mode { Idle, Position, RunForward, RunBackward, Stopping, Queue };
+
+    void _sync();
+    void _integrate(double dt);
+    void _playQueue(uint64_t ticks);
+    void _begin(Mode mode);
+
+    uint8_t _dirPin = 0xFF;
+    uint8_t _enablePin = 0xFF;
+    bool _autoEnable = false;
+    bool _outputsEnabled = false;
+
+    Mode _mode = Mode::Idle;
+    double _position = 0.0;
+    double _velocity = 0.0;
+    double _maxSpeed = 0.0;
+    double _accel = 0.0;
+    double _pendingSpeed = 0.0;
+    double _pendingAccel = 0.0;
+    int32_t _target = 0;
+    uint64_t _lastSync = 0;
+    uint64_t _stepsGenerated = 0;
+    int32_t _lastStep = 0;
+
+    std::deque<stepper_command_s> _queue;
+    uint32_t _periodTicksLeft = 0;    // Rest of the current entry's step period
+};
+
+class FastAccelStepperEngine {
+public:
+    void init(uint8_t cpu_core = 0) {}
+    FastAccelStepper* stepperConnectToPin(uint8_t step_pin);
+
+private:
+    std::vector<std::unique_ptr<FastAccelStepper>> _steppers;
+};
+
+#endif // NATIVE_FAST_ACCEL_STEPPER_H
@@ -0,0 +1,6 @@
+#ifndef NATIVE_SPIFFS_H
+#define NATIVE_SPIFFS_H
+
+// Nothing in the firmware uses SPIFFS directly; the header only has to exist.
+
+#endif // NATIVE_SPIFFS_H
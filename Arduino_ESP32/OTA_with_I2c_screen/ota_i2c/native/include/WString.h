@@ -0,0 +1,72 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Minimal Arduino String backed by std::string. Only the members used by the
+// firmware and ArduinoJson's String adapter are provided.
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v) : _s(std::to_string(v)) {}
+    String(unsigned int v) : _s(std::to_string(v)) {}
+    String(long v) : _s(std::to_string(v)) {}
+    String(unsigned long v) : _s(std::to_string(v)) {}
+    String(long long v) : _s(std::to_string(v)) {}
+    String(unsigned long long v) : _s(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2) { _fromDouble(v, decimals); }
+    String(double v, unsigned int decimals = 2) { _fromDouble(v, decimals); }
+    String(bool v) : _s(v ? "1" : "0") {}
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+
+    bool concat(const char* s) { if (s) _s += s; return true; }
+    bool concat(const char* s, unsigned int len) { if (s) _s.append(s, len); return true; }
+    bool concat(char c) { _s += c; return true; }
+    bool concat(const String& s) { _s += s._s; return true; }
+
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { if (s) _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return _s == (s ? s : ""); }
+    bool operator!=(const String& s) const { return _s != s._s; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+
+    long toInt() const { return std::strtol(_s.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(_s.c_str(), nullptr); }
+    bool startsWith(const char* prefix) const { return _s.rfind(prefix, 0) == 0; }
+    int indexOf(char c) const { auto p = _s.find(c); return p == std::string::npos ? -1 : (int)p; }
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < _s.size() && to > from ? String(_s.substr(from, to - from)) : String();
+    }
+
+    const std::string& str() const { return _s; }
+
+private:
+    std::string _s;
+
+    void _fromDouble(double v, unsigned int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        _s = buf;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+
+#endif // NATIVE_WSTRING_H
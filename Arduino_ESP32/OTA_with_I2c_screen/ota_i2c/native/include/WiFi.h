@@ -0,0 +1,56 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _octets{a, b, c, d} {}
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _octets[0], _octets[1], _octets[2], _octets[3]);
+        return String(buf);
+    }
+    uint8_t operator[](int i) const { return _octets[i & 3]; }
+
+private:
+    uint8_t _octets[4];
+};
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+// Always "connected" with a fixed address and a settable RSSI.
+class WiFiClass {
+public:
+    IPAddress localIP() const { return IPAddress(10, 0, 1, 234); }
+    int8_t RSSI() const { return _rssi; }
+    wl_status_t status() const { return _status; }
+    String macAddress() const { return String("24:0A:C4:00:00:01"); }
+    bool mode(wifi_mode_t m) { _mode = m; return true; }
+    wifi_mode_t getMode() const { return _mode; }
+    wl_status_t begin(const char*, const char* = nullptr) { _status = WL_CONNECTED; return _status; }
+    bool disconnect(bool = false) { _status = WL_DISCONNECTED; return true; }
+
+    void setRSSI(int8_t rssi) { _rssi = rssi; }
+
+private:
+    int8_t _rssi = -55;
+    wl_status_t _status = WL_CONNECTED;
+    wifi_mode_t _mode = WIFI_STA;
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
@@ -0,0 +1,13 @@
+#ifndef NATIVE_WIFI_MANAGER_H
+#define NATIVE_WIFI_MANAGER_H
+
+#include "WiFi.h"
+
+class WiFiManager {
+public:
+    bool autoConnect(const char* apName) { return autoConnect(apName, nullptr); }
+    bool autoConnect(const char*, const char*) { WiFi.begin("native"); return true; }
+    void resetSettings() {}
+};
+
+#endif // NATIVE_WIFI_MANAGER_H
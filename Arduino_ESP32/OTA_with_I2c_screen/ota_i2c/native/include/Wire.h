@@ -0,0 +1,76 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// A device on the host I2C bus; gets each transaction's bytes at endTransmission()
+class I2cDevice {
+public:
+    virtual ~I2cDevice() {}
+    virtual void onTransaction(const uint8_t* data, size_t len) = 0;
+};
+
+// I2C master that accepts every transaction and counts the traffic, so the
+// cost of display updates can be measured in bytes rather than guessed.
+// Transactions go to the device attached at their address (if any), can be
+// recorded, and add to a simulated bus time at the current clock: START,
+// address and STOP plus 9 clocks (8 bits and ACK) per byte.
+class TwoWire {
+public:
+    struct Transaction {
+        uint8_t address;
+        uint32_t clock;
+        std::vector<uint8_t> data;
+    };
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        if (frequency) _clock = frequency;
+        return true;
+    }
+    bool setClock(uint32_t frequency) { _clock = frequency; return true; }
+    uint32_t getClock() const { return _clock; }
+
+    void beginTransmission(uint8_t address) { _address = address; _pending.clear(); }
+    size_t write(uint8_t data) { _pending.push_back(data); _bytes++; return 1; }
+    size_t write(const uint8_t* data, size_t len) {
+        _pending.insert(_pending.end(), data, data + len);
+        _bytes += len;
+        return len;
+    }
+    uint8_t endTransmission(bool sendStop = true) {
+        _transactions++;
+        _busUs += (11.0 + 9.0 * _pending.size()) * 1e6 / _clock;
+        if (_address < 128 && _devices[_address]) _devices[_address]->onTransaction(_pending.data(), _pending.size());
+        if (_recording) _log.push_back({_address, _clock, _pending});
+        _pending.clear();
+        return 0;
+    }
+
+    // Host controls
+    void attach(uint8_t address, I2cDevice* device) { if (address < 128) _devices[address] = device; }
+    void detach(uint8_t address) { attach(address, nullptr); }
+    unsigned long long bytesWritten() const { return _bytes; }
+    unsigned long transactions() const { return _transactions; }
+    double busMicros() const { return _busUs; }  // Simulated time on the bus
+    void setRecording(bool on) { _recording = on; }
+    const std::vector<Transaction>& log() const { return _log; }
+    void clearLog() { _log.clear(); }
+    void resetStats() { _bytes = 0; _transactions = 0; _busUs = 0; }
+
+private:
+    uint32_t _clock = 100000;
+    uint8_t _address = 0;
+    std::vector<uint8_t> _pending;
+    unsigned long long _bytes = 0;
+    unsigned long _transactions = 0;
+    double _busUs = 0;
+    I2cDevice* _devices[128] = {};
+    bool _recording = false;
+    std::vector<Transaction> _log;
+};
+
+extern TwoWire Wire;
+
+#endif // NATIVE_WIRE_H
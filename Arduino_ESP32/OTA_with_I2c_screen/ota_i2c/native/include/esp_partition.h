@@ -0,0 +1,76 @@
+#ifndef NATIVE_ESP_PARTITION_H
+#define NATIVE_ESP_PARTITION_H
+
+#include "Arduino.h"
+
+// RAM-backed SPI NOR flash behind the ESP-IDF partition API. Like the real
+// part, an erase sets a whole sector to 0xFF and a write can only clear bits
+// (the new contents are ANDed into the old). The table has one 64 KB data
+// partition labelled "config", as in partitions.csv.
+//
+// NativeFlash lets a benchmark cut the power part-way through an operation
+// and count wear and the time the chip would have been busy.
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+#define ESP_ERR_INVALID_ARG  0x102
+#define ESP_ERR_INVALID_SIZE 0x104
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_DATA_OTA = 0x00,
+    ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    uint8_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+namespace NativeFlash {
+    // Datasheet-typical timings of a 4 MB SPI NOR part
+    static const unsigned long SECTOR_ERASE_US = 45000;
+    static const unsigned long PROGRAM_OVERHEAD_US = 20;   // Per write call
+    static const double PROGRAM_US_PER_BYTE = 2.5;          // ~0.65 ms per 256-byte page
+
+    struct Stats {
+        unsigned long writes;
+        unsigned long erases;                 // Sectors
+        unsigned long long bytesProgrammed;
+        unsigned long long busyUs;            // Time the chip would have been busy
+        unsigned long maxSectorErases;        // Wear of the most erased sector
+    };
+
+    void reset();  // Every sector erased, power on, stats cleared
+
+    // Power fails once this many more bytes have been programmed; an erase
+    // counts as SPI_FLASH_SEC_SIZE bytes per sector. The operation that runs
+    // out stops part-way (an erase leaves the start of the sector cleared and
+    // the rest as it was) and returns ESP_FAIL, as does everything after it
+    // until restorePower().
+    void cutPowerAfter(unsigned long long bytes);
+    void restorePower();
+    bool powerLost();
+
+    Stats stats();
+    void resetStats();
+    unsigned long sectorErases(size_t sector);  // Within the config partition
+}
+
+#endif // NATIVE_ESP_PARTITION_H
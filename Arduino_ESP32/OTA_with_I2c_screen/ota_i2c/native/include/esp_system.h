@@ -0,0 +1,6 @@
+#ifndef NATIVE_ESP_SYSTEM_H
+#define NATIVE_ESP_SYSTEM_H
+
+#include "Arduino.h"  // esp_reset_reason(), esp_restart()
+
+#endif // NATIVE_ESP_SYSTEM_H
@@ -0,0 +1,11 @@
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include <cstdint>
+
+// Microseconds since start-up on the host's monotonic clock. Like the
+// FreeRTOS tick (and unlike micros()) this is real time, so it measures what
+// the shim's task threads actually do.
+int64_t esp_timer_get_time();
+
+#endif // NATIVE_ESP_TIMER_H
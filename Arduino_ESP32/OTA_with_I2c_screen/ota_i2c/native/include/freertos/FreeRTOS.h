@@ -0,0 +1,41 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+// Host-side stand-in for the ESP-IDF FreeRTOS port (env:native only).
+// Tasks are real std::threads, so queues and mailboxes shared between tasks
+// see genuine concurrency. The tick is host wall-clock time at 1 kHz and is
+// independent of the virtual NativeClock behind millis()/micros().
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+
+// Critical sections: one global lock is enough on the host
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+
+BaseType_t xPortGetCoreID();
+
+#endif // NATIVE_FREERTOS_H
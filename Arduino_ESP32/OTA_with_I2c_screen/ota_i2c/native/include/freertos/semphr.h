@@ -0,0 +1,18 @@
+#ifndef NATIVE_FREERTOS_SEMPHR_H
+#define NATIVE_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+struct NativeSemaphore;
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+// Mutexes only (plain and recursive); both are backed by a recursive mutex
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+#define xSemaphoreTakeRecursive(s, t) xSemaphoreTake(s, t)
+#define xSemaphoreGiveRecursive(s) xSemaphoreGive(s)
+
+#endif // NATIVE_FREERTOS_SEMPHR_H
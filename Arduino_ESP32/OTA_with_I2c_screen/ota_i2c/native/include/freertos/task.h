@@ -0,0 +1,31 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+struct NativeTask;
+typedef NativeTask* TaskHandle_t;
+
+// Priority and stack depth are recorded but not enforced; the core id is
+// reported back through xPortGetCoreID() from inside the task.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t coreId);
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+void vTaskDelete(TaskHandle_t task);  // Only nullptr (the calling task) is supported
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+
+// Direct-to-task notifications (counting semaphore semantics)
+void xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+#endif // NATIVE_FREERTOS_TASK_H
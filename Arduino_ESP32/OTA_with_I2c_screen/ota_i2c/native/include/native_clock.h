@@ -0,0 +1,15 @@
+#ifndef NATIVE_CLOCK_H
+#define NATIVE_CLOCK_H
+
+#include <cstdint>
+
+// Virtual time base for the host build. millis()/micros()/delay() all run on
+// this clock, so benchmarks and simulations are deterministic and never sleep.
+namespace NativeClock {
+    uint64_t nowMicros();
+    void advanceMicros(uint64_t us);
+    void setMicros(uint64_t us);
+    void reset();
+}
+
+#endif // NATIVE_CLOCK_H
@@ -0,0 +1,14 @@
+#ifndef NATIVE_TASKS_H
+#define NATIVE_TASKS_H
+
+#include <cstddef>
+
+// Host controls for the FreeRTOS shim. Tasks normally run forever; stopAll()
+// unwinds every task at its next vTaskDelay()/ulTaskNotifyTake() and joins
+// its thread, so a benchmark can tear down what it started.
+namespace NativeTasks {
+    size_t count();
+    void stopAll();
+}
+
+#endif // NATIVE_TASKS_H
@@ -0,0 +1,10 @@
+#ifndef NATIVE_SOC_GPIO_REG_H
+#define NATIVE_SOC_GPIO_REG_H
+
+#include "soc/soc.h"
+
+// ESP32 addresses: GPIO 0-31 in GPIO_IN_REG, GPIO 32-39 in bits 0-7 of GPIO_IN1_REG
+#define GPIO_IN_REG  0x3FF4403C
+#define GPIO_IN1_REG 0x3FF44040
+
+#endif // NATIVE_SOC_GPIO_REG_H
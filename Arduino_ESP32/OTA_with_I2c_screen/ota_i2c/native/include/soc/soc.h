@@ -0,0 +1,14 @@
+#ifndef NATIVE_SOC_SOC_H
+#define NATIVE_SOC_SOC_H
+
+#include <cstdint>
+
+// Host-side stand-in for ESP-IDF's register access. Only the GPIO input
+// registers exist; they reflect the levels driven through NativeGpio.
+namespace NativeGpio {
+    uint32_t readRegister(uint32_t address);
+}
+
+#define REG_READ(reg) NativeGpio::readRegister((uint32_t)(reg))
+
+#endif // NATIVE_SOC_SOC_H
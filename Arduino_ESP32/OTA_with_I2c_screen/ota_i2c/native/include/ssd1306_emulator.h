@@ -0,0 +1,73 @@
+#ifndef NATIVE_SSD1306_EMULATOR_H
+#define NATIVE_SSD1306_EMULATOR_H
+
+#include <vector>
+#include "Wire.h"
+
+// The panel end of an SSD1306 on the host I2C bus: decodes the command and
+// data streams the driver sends (addressing modes, column/page windows,
+// display on/off, inversion) into its own display RAM. What it holds is what
+// the physical panel would show, independent of the driver's framebuffer, so
+// it catches transfers that miss or misplace bytes.
+//
+//   Ssd1306Emulator panel(128, 64);
+//   panel.attach(Wire);             // at 0x3C
+//   ... draw through DisplayManager ...
+//   panel.writePbm("ota.pbm");
+//
+// Images are in RAM order (column 0 left, page 0 top); segment remap and COM
+// scan direction are accepted but not applied.
+class Ssd1306Emulator : public I2cDevice {
+public:
+    Ssd1306Emulator(int width = 128, int height = 64);
+    ~Ssd1306Emulator();
+
+    void attach(TwoWire& wire, uint8_t address = 0x3C);
+    void detach();
+    void onTransaction(const uint8_t* data, size_t len) override;
+
+    bool getPixel(int x, int y) const;  // As shown: off and inverted taken into account
+    const std::vector<uint8_t>& ram() const { return _ram; }
+    bool matches(const uint8_t* buffer) const;  // RAM equals a driver framebuffer
+    bool isOn() const { return _on; }
+    bool isInverted() const { return _inverted; }
+    uint8_t contrast() const { return _contrast; }
+
+    uint32_t imageHash() const;  // FNV-1a of the shown pixels, for regression checks
+    bool writePbm(const char* path) const;  // Binary PBM (P4), 1 = lit
+
+    unsigned long commands() const { return _commands; }
+    unsigned long dataBytes() const { return _dataBytes; }
+    void resetStats() { _commands = 0; _dataBytes = 0; }
+
+private:
+    int _width;
+    int _height;
+    int _pages;
+    std::vector<uint8_t> _ram;
+    TwoWire* _wire = nullptr;
+    uint8_t _address = 0;
+
+    uint8_t _addressingMode = 2;  // Page addressing after reset
+    int _columnStart = 0;
+    int _columnEnd;
+    int _pageStart = 0;
+    int _pageEnd;
+    int _column = 0;
+    int _page = 0;
+    bool _on = false;
+    bool _inverted = false;
+    bool _entireOn = false;
+    uint8_t _contrast = 0x7F;
+
+    uint8_t _command[8];  // Command being collected, with its arguments
+    size_t _commandLength = 0;
+    unsigned long _commands = 0;
+    unsigned long _dataBytes = 0;
+
+    void command(uint8_t byte);
+    void execute();
+    void data(uint8_t byte);
+};
+
+#endif // NATIVE_SSD1306_EMULATOR_H
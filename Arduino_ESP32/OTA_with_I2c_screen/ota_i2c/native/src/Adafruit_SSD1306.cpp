@@ -0,0 +1,89 @@
+#include <Adafruit_SSD1306.h>
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin,
+                                   uint32_t clkDuring, uint32_t clkAfter)
+    : Adafruit_GFX(w, h), _wire(twi), _buffer(w * ((h + 7) / 8), 0),
+      _clkDuring(clkDuring), _clkAfter(clkAfter) {}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t i2caddr, bool reset, bool periphBegin) {
+    _address = i2caddr ? i2caddr : 0x3C;
+    if (periphBegin) _wire->begin();
+
+    static const uint8_t init[] = {
+        SSD1306_DISPLAYOFF, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14,
+        SSD1306_MEMORYMODE, 0x00, 0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1,
+        0xDB, 0x40, 0xA4, 0xA6, 0x2E, SSD1306_DISPLAYON
+    };
+    _wire->setClock(_clkDuring);
+    _commandList(init, sizeof(init));
+    _wire->setClock(_clkAfter);
+    return true;
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    std::fill(_buffer.begin(), _buffer.end(), 0);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return;
+    uint8_t& cell = _buffer[x + (y / 8) * _width];
+    uint8_t bit = 1 << (y & 7);
+    switch (color) {
+        case SSD1306_WHITE: cell |= bit; break;
+        case SSD1306_BLACK: cell &= ~bit; break;
+        case SSD1306_INVERSE: cell ^= bit; break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || x >= _width || y < 0 || y >= _height) return false;
+    return _buffer[x + (y / 8) * _width] & (1 << (y & 7));
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x00);
+    _wire->write(c);
+    _wire->endTransmission();
+}
+
+void Adafruit_SSD1306::_commandList(const uint8_t* c, uint8_t n) {
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x00);
+    size_t bytesOut = 1;
+    while (n--) {
+        if (bytesOut >= WIRE_MAX) {
+            _wire->endTransmission();
+            _wire->beginTransmission(_address);
+            _wire->write((uint8_t)0x00);
+            bytesOut = 1;
+        }
+        _wire->write(*c++);
+        bytesOut++;
+    }
+    _wire->endTransmission();
+}
+
+void Adafruit_SSD1306::display() {
+    _wire->setClock(_clkDuring);
+    const uint8_t window[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, (uint8_t)(_width - 1)};
+    _commandList(window, sizeof(window));
+
+    const uint8_t* ptr = _buffer.data();
+    size_t count = _buffer.size();
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x40);
+    size_t bytesOut = 1;
+    while (count--) {
+        if (bytesOut >= WIRE_MAX) {
+            _wire->endTransmission();
+            _wire->beginTransmission(_address);
+            _wire->write((uint8_t)0x40);
+            bytesOut = 1;
+        }
+        _wire->write(*ptr++);
+        bytesOut++;
+    }
+    _wire->endTransmission();
+    _wire->setClock(_clkAfter);
+}
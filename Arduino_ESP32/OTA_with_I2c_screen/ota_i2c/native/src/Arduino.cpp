@@ -0,0 +1,157 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Wire.h>
+#include <WiFi.h>
+#include <ArduinoOTA.h>
+#include <soc/gpio_reg.h>
+#include <atomic>
+
+HardwareSerial Serial;
+EspClass ESP;
+EEPROMClass EEPROM;
+TwoWire Wire;
+WiFiClass WiFi;
+ArduinoOTAClass ArduinoOTA;
+
+namespace {
+    std::atomic<uint64_t> g_nowMicros(0);  // Read from task threads as well
+
+    struct PinState {
+        uint8_t mode = 0;
+        bool level = false;
+        void (*isr)(void*) = nullptr;
+        void* isrArg = nullptr;
+        int isrMode = 0;
+    };
+    PinState g_pins[NativeGpio::PIN_COUNT];
+    uint32_t g_inputWords[2];  // GPIO_IN_REG, GPIO_IN1_REG
+
+    void storeLevel(uint8_t pin, bool level) {
+        g_pins[pin].level = level;
+        uint32_t bit = 1u << (pin & 31);
+        if (level) {
+            g_inputWords[pin >> 5] |= bit;
+        } else {
+            g_inputWords[pin >> 5] &= ~bit;
+        }
+    }
+}
+
+namespace NativeClock {
+    uint64_t nowMicros() { return g_nowMicros; }
+    void advanceMicros(uint64_t us) { g_nowMicros += us; }
+    void setMicros(uint64_t us) { g_nowMicros = us; }
+    void reset() { g_nowMicros = 0; }
+}
+
+unsigned long millis() { return (unsigned long)(g_nowMicros / 1000); }
+unsigned long micros() { return (unsigned long)g_nowMicros; }
+void delay(uint32_t ms) { g_nowMicros += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { g_nowMicros += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= NativeGpio::PIN_COUNT) return;
+    g_pins[pin].mode = mode;
+    if (mode == INPUT_PULLUP) storeLevel(pin, true);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < NativeGpio::PIN_COUNT) storeLevel(pin, val != LOW);
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < NativeGpio::PIN_COUNT && g_pins[pin].level ? HIGH : LOW;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= NativeGpio::PIN_COUNT) return;
+    g_pins[pin].isr = handler;
+    g_pins[pin].isrArg = arg;
+    g_pins[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < NativeGpio::PIN_COUNT) g_pins[pin].isr = nullptr;
+}
+
+namespace NativeGpio {
+    void setLevel(uint8_t pin, bool level) {
+        if (pin >= PIN_COUNT) return;
+        PinState& p = g_pins[pin];
+        bool previous = p.level;
+        storeLevel(pin, level);
+        if (!p.isr || previous == level) return;
+        bool fire = p.isrMode == CHANGE ||
+                    (p.isrMode == RISING && level) ||
+                    (p.isrMode == FALLING && !level);
+        if (fire) p.isr(p.isrArg);
+    }
+
+    bool getLevel(uint8_t pin) { return pin < PIN_COUNT && g_pins[pin].level; }
+    uint8_t getMode(uint8_t pin) { return pin < PIN_COUNT ? g_pins[pin].mode : 0; }
+
+    void reset() {
+        for (auto& p : g_pins) p = PinState();
+        g_inputWords[0] = g_inputWords[1] = 0;
+    }
+
+    uint32_t readRegister(uint32_t address) {
+        switch (address) {
+            case GPIO_IN_REG:  return g_inputWords[0];
+            case GPIO_IN1_REG: return g_inputWords[1];
+            default:           return 0;
+        }
+    }
+}
+
+size_t HardwareSerial::print(const char* s) {
+    return write((const uint8_t*)s, strlen(s));
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    return write((const uint8_t*)buffer, std::min((size_t)len, sizeof(buffer) - 1));
+}
+
+double HardwareSerial::writerMicros() {
+    unsigned long now = micros();
+    if (now < _txLastMicros) _txIdleUs = 0;  // NativeClock::reset()
+    _txLastMicros = now;
+    double writer = now + _txStallUs;
+    if (_txIdleUs < writer) _txIdleUs = writer;
+    return writer;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t len) {
+    double usPerByte = 10e6 / _baud;
+    double queued = (_txIdleUs - writerMicros()) / usPerByte;
+    if (queued + len > TX_FIFO) _txStallUs += (queued + len - TX_FIFO) * usPerByte;
+    _txIdleUs += len * usPerByte;
+    _bytesWritten += len;
+    if (_echo) fwrite(data, 1, len, stdout);
+    return len;
+}
+
+void HardwareSerial::flush() {
+    _txStallUs += _txIdleUs - writerMicros();
+}
+
+// Bounds of the RTC_NOINIT_ATTR section, from the linker
+extern "C" uint8_t __start_rtc_noinit[] __attribute__((weak));
+extern "C" uint8_t __stop_rtc_noinit[] __attribute__((weak));
+
+void EspClass::powerCycle() {
+    for (uint8_t* p = __start_rtc_noinit; p < __stop_rtc_noinit; p++) *p = rand();
+    _resetReason = ESP_RST_POWERON;
+}
+
+void EspClass::restart() {
+    _restarts++;
+    _resetReason = ESP_RST_SW;
+    if (Serial) Serial.print("[native] ESP.restart() requested\r\n");
+}
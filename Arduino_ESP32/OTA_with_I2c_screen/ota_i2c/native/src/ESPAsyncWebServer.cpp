@@ -0,0 +1,139 @@
+#include <ESPAsyncWebServer.h>
+#include <strings.h>
+
+const AsyncWebHeader* AsyncWebServerResponse::header(const char* name) const {
+    for (const auto& h : _headers) {
+        if (strcasecmp(h.name().c_str(), name) == 0) return &h;
+    }
+    return nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const {
+    for (const auto& p : _params) {
+        if (p->name() == name && p->isPost() == post) return p.get();
+    }
+    return nullptr;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const {
+    for (const auto& h : _headers) {
+        if (strcasecmp(h->name().c_str(), name.c_str()) == 0) return h.get();
+    }
+    return nullptr;
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+    send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+    _response.reset(response);
+}
+
+void AsyncWebServerRequest::send_P(int code, const String& contentType, const uint8_t* content, size_t len) {
+    send(beginResponse_P(code, contentType, content, len));
+}
+
+void AsyncWebServerRequest::send_P(int code, const String& contentType, const char* content) {
+    send_P(code, contentType, (const uint8_t*)content, strlen(content));
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType, const String& content) {
+    return new AsyncWebServerResponse(code, contentType, (const uint8_t*)content.c_str(), content.length());
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType, const uint8_t* content, size_t len) {
+    return new AsyncWebServerResponse(code, contentType, content, len);
+}
+
+void AsyncWebServerRequest::redirect(const String& url) {
+    AsyncWebServerResponse* response = beginResponse(302);
+    response->addHeader("Location", url);
+    send(response);
+}
+
+size_t AsyncWebSocket::count() const {
+    size_t n = 0;
+    for (const auto& c : _clients) {
+        if (c.status() == WS_CONNECTED) n++;
+    }
+    return n;
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
+    for (auto& c : _clients) {
+        if (c.id() == id && c.status() == WS_CONNECTED) return &c;
+    }
+    return nullptr;
+}
+
+void AsyncWebSocket::textAll(const char* message, size_t len) {
+    for (auto& c : _clients) c.text(message, len);
+}
+
+void AsyncWebSocket::binaryAll(const uint8_t* message, size_t len) {
+    for (auto& c : _clients) c.binary(message, len);
+}
+
+void AsyncWebSocket::text(uint32_t id, const char* message, size_t len) {
+    AsyncWebSocketClient* c = client(id);
+    if (c) c->text(message, len);
+}
+
+void AsyncWebSocket::binary(uint32_t id, const uint8_t* message, size_t len) {
+    AsyncWebSocketClient* c = client(id);
+    if (c) c->binary(message, len);
+}
+
+AsyncWebSocketClient* AsyncWebSocket::connect() {
+    _clients.emplace_back(this, _nextId++);
+    AsyncWebSocketClient* c = &_clients.back();
+    if (_handler) _handler(this, c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+    return c;
+}
+
+void AsyncWebSocket::disconnect(uint32_t id) {
+    for (auto it = _clients.begin(); it != _clients.end(); ++it) {
+        if (it->id() == id) {
+            it->setStatus(WS_DISCONNECTED);
+            if (_handler) _handler(this, &*it, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+            _clients.erase(it);
+            return;
+        }
+    }
+}
+
+void AsyncWebSocket::receive(AsyncWebSocketClient* client, AwsFrameType type, const uint8_t* data, size_t len) {
+    AwsFrameInfo info = {};
+    info.message_opcode = type;
+    info.opcode = type;
+    info.final = 1;
+    info.len = len;
+    info.index = 0;
+    std::vector<uint8_t> copy(data, data + len);
+    if (_handler) _handler(this, client, WS_EVT_DATA, &info, copy.data(), copy.size());
+}
+
+void AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest) {
+    _routes.push_back({uri, method, onRequest, nullptr});
+}
+
+void AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                        ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody) {
+    _routes.push_back({uri, method, onRequest, onBody});
+}
+
+bool AsyncWebServer::dispatch(AsyncWebServerRequest& request, const uint8_t* body, size_t bodyLen) {
+    for (auto& route : _routes) {
+        if (route.uri == request.url() && (route.method & request.method())) {
+            if (body && route.onBody) {
+                std::vector<uint8_t> copy(body, body + bodyLen);
+                route.onBody(&request, copy.data(), copy.size(), 0, copy.size());
+            }
+            if (route.onRequest) route.onRequest(&request);
+            return true;
+        }
+    }
+    if (_notFound) _notFound(&request);
+    return false;
+}
@@ -0,0 +1,277 @@
+#include <FastAccelStepper.h>
+#include <algorithm>
+#include <cmath>
+#include "native_clock.h"
+
+namespace {
+    // Integration step of the simulated step generator.
+    const double SIM_DT = 50e-6;
+}
+
+FastAccelStepper* FastAccelStepperEngine::stepperConnectToPin(uint8_t step_pin) {
+    _steppers.emplace_back(new FastAccelStepper());
+    return _steppers.back().get();
+}
+
+int8_t FastAccelStepper::setSpeedInHz(uint32_t speed_hz) {
+    if (speed_hz == 0) return -1;
+    _pendingSpeed = speed_hz;
+    if (_mode == Mode::Idle) _maxSpeed = _pendingSpeed;
+    return 0;
+}
+
+int8_t FastAccelStepper::setAcceleration(int32_t step_s_s) {
+    if (step_s_s <= 0) return -1;
+    _pendingAccel = step_s_s;
+    if (_mode == Mode::Idle) _accel = _pendingAccel;
+    return 0;
+}
+
+void FastAccelStepper::applySpeedAcceleration() {
+    _sync();
+    _maxSpeed = _pendingSpeed;
+    _accel = _pendingAccel;
+}
+
+void FastAccelStepper::_begin(Mode mode) {
+    _sync();
+    _maxSpeed = _pendingSpeed;
+    _accel = _pendingAccel;
+    _mode = mode;
+    if (_autoEnable) _outputsEnabled = true;
+}
+
+int8_t FastAccelStepper::moveTo(int32_t position, bool blocking) {
+    if (_pendingSpeed <= 0) return MOVE_ERR_SPEED_IS_UNDEFINED;
+    if (_pendingAccel <= 0) return MOVE_ERR_ACCELERATION_IS_UNDEFINED;
+    _target = position;
+    _begin(Mode::Position);
+    return MOVE_OK;
+}
+
+int8_t FastAccelStepper::move(int32_t delta, bool blocking) {
+    _sync();
+    int32_t base = _mode == Mode::Position ? _target : (int32_t)std::lround(_position);
+    return moveTo(base + delta, blocking);
+}
+
+int8_t FastAccelStepper::runForward() {
+    if (_pendingSpeed <= 0) return MOVE_ERR_SPEED_IS_UNDEFINED;
+    _begin(Mode::RunForward);
+    return MOVE_OK;
+}
+
+int8_t FastAccelStepper::runBackward() {
+    if (_pendingSpeed <= 0) return MOVE_ERR_SPEED_IS_UNDEFINED;
+    _begin(Mode::RunBackward);
+    return MOVE_OK;
+}
+
+void FastAccelStepper::stopMove() {
+    _sync();
+    if (_mode != Mode::Idle && _mode != Mode::Queue) _mode = Mode::Stopping;
+}
+
+void FastAccelStepper::forceStop() {
+    _sync();
+    _mode = Mode::Idle;
+    _velocity = 0.0;
+    _position = std::lround(_position);
+    _queue.clear();
+    _periodTicksLeft = 0;
+}
+
+namespace {
+    int8_t g_rejectCode = AQE_OK;
+    uint16_t g_rejectCount = 0;
+}
+
+void FastAccelStepper::rejectEntries(int8_t code, uint16_t count) {
+    g_rejectCode = code;
+    g_rejectCount = count;
+}
+
+int8_t FastAccelStepper::addQueueEntry(const stepper_command_s* cmd, bool start) {
+    _sync();
+    if (g_rejectCount > 0) {
+        g_rejectCount--;
+        return g_rejectCode;
+    }
+    if (_mode != Mode::Idle && _mode != Mode::Queue) return AQE_QUEUE_FULL;  // Ramp generator owns the queue
+    if (_queue.size() >= QUEUE_LEN) return AQE_QUEUE_FULL;
+    if (cmd->steps > 0 && (uint32_t)cmd->ticks * cmd->steps < MIN_CMD_TICKS) return AQE_ERROR_TICKS_TOO_LOW;
+    _queue.push_back(*cmd);
+    if (start && _mode == Mode::Idle) {
+        _mode = Mode::Queue;
+        if (_autoEnable) _outputsEnabled = true;
+    }
+    return AQE_OK;
+}
+
+bool FastAccelStepper::isQueueEmpty() {
+    _sync();
+    return _queue.empty() && _periodTicksLeft == 0;
+}
+
+bool FastAccelStepper::isQueueFull() {
+    _sync();
+    return _queue.size() >= QUEUE_LEN;
+}
+
+void FastAccelStepper::forceStopAndNewPosition(int32_t new_pos) {
+    forceStop();
+    setCurrentPosition(new_pos);
+}
+
+bool FastAccelStepper::isRunning() {
+    _sync();
+    return _mode != Mode::Idle;
+}
+
+int32_t FastAccelStepper::getCurrentPosition() {
+    _sync();
+    return (int32_t)std::lround(_position);
+}
+
+void FastAccelStepper::setCurrentPosition(int32_t new_pos) {
+    _sync();
+    double shift = new_pos - _position;
+    _position = new_pos;
+    _target += (int32_t)std::lround(shift);
+    _lastStep = new_pos;
+}
+
+int32_t FastAccelStepper::targetPos() {
+    _sync();
+    return _mode == Mode::Position ? _target : (int32_t)std::lround(_position);
+}
+
+int32_t FastAccelStepper::getCurrentSpeedInMilliHz() {
+    _sync();
+    return (int32_t)(_velocity * 1000.0);
+}
+
+void FastAccelStepper::_sync() {
+    uint64_t now = NativeClock::nowMicros();
+    if (now <= _lastSync) {
+        _lastSync = now;
+        return;
+    }
+    if (_mode == Mode::Queue) {
+        _playQueue((now - _lastSync) * (TICKS_PER_S / 1000000));
+        _lastSync = now;
+        if (_mode == Mode::Idle && _autoEnable) _outputsEnabled = false;
+        return;
+    }
+    double elapsed = (now - _lastSync) * 1e-6;
+    _lastSync = now;
+    while (elapsed > 0.0 && _mode != Mode::Idle) {
+        double dt = elapsed < SIM_DT ? elapsed : SIM_DT;
+        _integrate(dt);
+        elapsed -= dt;
+    }
+    if (_mode == Mode::Idle && _autoEnable) _outputsEnabled = false;
+}
+
+void FastAccelStepper::_playQueue(uint64_t ticks) {
+    // Each entry steps at the start of every period, then waits `ticks`
+    while (ticks > 0) {
+        if (_periodTicksLeft == 0) {
+            if (_queue.empty()) {
+                _mode = Mode::Idle;
+                _velocity = 0.0;
+                return;
+            }
+            stepper_command_s& cmd = _queue.front();
+            if (cmd.steps > 0) {
+                double dir = cmd.count_up ? 1.0 : -1.0;
+                _position += dir;
+                _lastStep += (int32_t)dir;
+                _stepsGenerated++;
+                _velocity = dir * TICKS_PER_S / cmd.ticks;
+                cmd.steps--;
+            } else {
+                _velocity = 0.0;
+            }
+            _periodTicksLeft = cmd.ticks;
+            if (cmd.steps == 0) _queue.pop_front();
+        }
+        uint64_t spent = ticks < _periodTicksLeft ? ticks : _periodTicksLeft;
+        _periodTicksLeft -= (uint32_t)spent;
+        ticks -= spent;
+    }
+    if (_periodTicksLeft == 0 && _queue.empty()) {
+        _mode = Mode::Idle;
+        _velocity = 0.0;
+    }
+}
+
+void FastAccelStepper::_integrate(double dt) {
+    double dv = _accel * dt;
+    double speed = std::fabs(_velocity);
+    double dir = _velocity >= 0 ? 1.0 : -1.0;
+
+    switch (_mode) {
+        case Mode::Idle:
+        case Mode::Queue:  // Played by _playQueue()
+            return;
+        case Mode::Stopping:
+            speed -= dv;
+            if (speed <= 0.0) {
+                speed = 0.0;
+                _mode = Mode::Idle;
+            }
+            break;
+        case Mode::RunForward:
+        case Mode::RunBackward: {
+            double want = _mode == Mode::RunForward ? 1.0 : -1.0;
+            if (speed > 0.0 && dir != want) {
+                speed -= dv;
+                if (speed < 0.0) speed = 0.0;
+            } else {
+                dir = want;
+                speed = speed < _maxSpeed ? std::min(_maxSpeed, speed + dv) : std::max(_maxSpeed, speed - dv);
+            }
+            break;
+        }
+        case Mode::Position: {
+            double dist = _target - _position;
+            double want = dist >= 0 ? 1.0 : -1.0;
+            if (std::fabs(dist) < 0.5 && speed <= dv) {
+                _position = _target;
+                _velocity = 0.0;
+                _mode = Mode::Idle;
+                return;
+            }
+            if (speed > 0.0 && dir != want) {
+                speed -= dv;
+                if (speed < 0.0) speed = 0.0;
+            } else {
+                dir = want;
+                double brake = speed * speed / (2.0 * _accel);
+                if (brake >= std::fabs(dist)) {
+                    speed = std::max(dv, speed - dv);
+                } else if (speed < _maxSpeed) {
+                    speed = std::min(_maxSpeed, speed + dv);
+                } else {
+                    speed = std::max(_maxSpeed, speed - dv);
+                }
+                if (speed * dt >= std::fabs(dist)) {
+                    _position = _target;
+                    _velocity = 0.0;
+                    _mode = Mode::Idle;
+                    _stepsGenerated += (uint64_t)std::labs(_target - _lastStep);
+                    _lastStep = _target;
+                    return;
+                }
+            }
+            break;
+        }
+    }
+
+    _velocity = dir * speed;
+    _position += _velocity * dt;
+    int32_t step = (int32_t)std::lround(_position);
+    _stepsGenerated += (uint64_t)std::labs(step - _lastStep);
+    _lastStep = step;
+}
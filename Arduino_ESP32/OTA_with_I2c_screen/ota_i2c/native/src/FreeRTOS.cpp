@@ -0,0 +1,175 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "native_tasks.h"
+
+struct NativeTask {
+    std::string name;
+    TaskFunction_t fn;
+    void* arg;
+    UBaseType_t priority;
+    BaseType_t coreId;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifications = 0;
+};
+
+struct NativeSemaphore {
+    std::recursive_timed_mutex mutex;
+};
+
+namespace {
+    // Thrown through a task's stack by vTaskDelete(nullptr) and by blocking
+    // calls once NativeTasks::stopAll() has been requested.
+    struct TaskExit {};
+
+    std::recursive_mutex g_critical;
+    std::mutex g_tasksMutex;
+    std::list<NativeTask> g_tasks;
+    std::atomic<bool> g_stopping(false);
+    thread_local NativeTask* t_current = nullptr;
+    const auto g_start = std::chrono::steady_clock::now();
+
+    void checkStop() {
+        if (g_stopping.load() && t_current) throw TaskExit();
+    }
+
+    void runTask(NativeTask* task) {
+        t_current = task;
+        try {
+            task->fn(task->arg);
+        } catch (const TaskExit&) {
+        }
+    }
+}
+
+void vPortEnterCritical(portMUX_TYPE*) { g_critical.lock(); }
+void vPortExitCritical(portMUX_TYPE*) { g_critical.unlock(); }
+
+BaseType_t xPortGetCoreID() {
+    return t_current && t_current->coreId != tskNO_AFFINITY ? t_current->coreId : APP_CPU_NUM;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t coreId) {
+    std::lock_guard<std::mutex> lock(g_tasksMutex);
+    g_tasks.emplace_back();
+    NativeTask* task = &g_tasks.back();
+    task->name = name ? name : "";
+    task->fn = fn;
+    task->arg = arg;
+    task->priority = priority;
+    task->coreId = coreId;
+    if (handle) *handle = task;
+    task->thread = std::thread(runTask, task);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == t_current) throw TaskExit();
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - g_start).count();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    checkStop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+    checkStop();
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+    *previousWake += increment;
+    checkStop();
+    std::this_thread::sleep_until(g_start + std::chrono::milliseconds(*previousWake));
+    checkStop();
+}
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_start).count();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return t_current; }
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    task = task ? task : t_current;
+    return task ? task->name.c_str() : "main";
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->cv.notify_one();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeTask* task = t_current;
+    if (!task) return 0;
+    checkStop();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto ready = [task] { return task->notifications > 0 || g_stopping.load(); };
+    if (ticksToWait == portMAX_DELAY) {
+        task->cv.wait(lock, ready);
+    } else {
+        task->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait), ready);
+    }
+    if (g_stopping.load()) throw TaskExit();
+    uint32_t count = task->notifications;
+    if (count > 0) task->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore(); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new NativeSemaphore(); }
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (ticksToWait == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+namespace NativeTasks {
+    size_t count() {
+        std::lock_guard<std::mutex> lock(g_tasksMutex);
+        return g_tasks.size();
+    }
+
+    void stopAll() {
+        g_stopping.store(true);
+        std::lock_guard<std::mutex> lock(g_tasksMutex);
+        for (auto& task : g_tasks) {
+            task.cv.notify_all();
+        }
+        for (auto& task : g_tasks) {
+            if (task.thread.joinable()) task.thread.join();
+        }
+        g_tasks.clear();
+        g_stopping.store(false);
+    }
+}
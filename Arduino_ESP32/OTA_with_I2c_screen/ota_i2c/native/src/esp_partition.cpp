@@ -0,0 +1,104 @@
+#include <esp_partition.h>
+#include <vector>
+
+namespace {
+    const esp_partition_t g_config = {ESP_PARTITION_TYPE_DATA, 0x40, 0x3E0000, 0x10000, "config", false};
+    const size_t SECTORS = 0x10000 / SPI_FLASH_SEC_SIZE;
+
+    std::vector<uint8_t> g_flash(0x10000, 0xFF);
+    unsigned long g_erases[SECTORS] = {};
+    NativeFlash::Stats g_stats = {};
+    bool g_cutArmed = false;
+    bool g_powerLost = false;
+    unsigned long long g_budget = 0;
+
+    bool inRange(const esp_partition_t* partition, size_t offset, size_t size) {
+        return partition == &g_config && offset <= partition->size && size <= partition->size - offset;
+    }
+
+    // How much of an operation of this size completes before the power fails
+    size_t allowance(size_t size) {
+        if (!g_cutArmed) return size;
+        if (g_budget >= size) {
+            g_budget -= size;
+            return size;
+        }
+        size_t done = g_budget;
+        g_budget = 0;
+        g_powerLost = true;
+        return done;
+    }
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    if (type != g_config.type) return nullptr;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != g_config.subtype) return nullptr;
+    if (label && strcmp(label, g_config.label) != 0) return nullptr;
+    return &g_config;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+    if (!dst || !inRange(partition, src_offset, size)) return ESP_ERR_INVALID_ARG;
+    if (g_powerLost) return ESP_FAIL;
+    memcpy(dst, &g_flash[src_offset], size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size) {
+    if (!src || !inRange(partition, dst_offset, size)) return ESP_ERR_INVALID_ARG;
+    if (g_powerLost) return ESP_FAIL;
+    size_t done = allowance(size);
+    const uint8_t* in = (const uint8_t*)src;
+    for (size_t i = 0; i < done; i++) {
+        g_flash[dst_offset + i] &= in[i];
+    }
+    g_stats.writes++;
+    g_stats.bytesProgrammed += done;
+    g_stats.busyUs += NativeFlash::PROGRAM_OVERHEAD_US + (unsigned long long)(done * NativeFlash::PROGRAM_US_PER_BYTE);
+    return done == size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (!inRange(partition, offset, size)) return ESP_ERR_INVALID_ARG;
+    if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) return ESP_ERR_INVALID_SIZE;
+    if (g_powerLost) return ESP_FAIL;
+    for (size_t sector = offset / SPI_FLASH_SEC_SIZE; sector < (offset + size) / SPI_FLASH_SEC_SIZE; sector++) {
+        size_t done = allowance(SPI_FLASH_SEC_SIZE);
+        memset(&g_flash[sector * SPI_FLASH_SEC_SIZE], 0xFF, done);
+        g_stats.busyUs += NativeFlash::SECTOR_ERASE_US * done / SPI_FLASH_SEC_SIZE;
+        if (done < SPI_FLASH_SEC_SIZE) return ESP_FAIL;
+        g_stats.erases++;
+        if (++g_erases[sector] > g_stats.maxSectorErases) g_stats.maxSectorErases = g_erases[sector];
+    }
+    return ESP_OK;
+}
+
+namespace NativeFlash {
+    void reset() {
+        std::fill(g_flash.begin(), g_flash.end(), 0xFF);
+        restorePower();
+        resetStats();
+    }
+
+    void cutPowerAfter(unsigned long long bytes) {
+        g_cutArmed = true;
+        g_budget = bytes;
+    }
+
+    void restorePower() {
+        g_cutArmed = false;
+        g_powerLost = false;
+    }
+
+    bool powerLost() { return g_powerLost; }
+
+    Stats stats() { return g_stats; }
+
+    void resetStats() {
+        g_stats = Stats();
+        std::fill(g_erases, g_erases + SECTORS, 0);
+    }
+
+    unsigned long sectorErases(size_t sector) { return sector < SECTORS ? g_erases[sector] : 0; }
+}
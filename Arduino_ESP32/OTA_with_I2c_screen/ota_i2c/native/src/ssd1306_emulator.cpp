@@ -0,0 +1,157 @@
+#include <ssd1306_emulator.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    // Argument bytes following each multi-byte command
+    size_t argumentCount(uint8_t command) {
+        switch (command) {
+            case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+                return 1;
+            case 0x21: case 0x22: case 0xA3:
+                return 2;
+            case 0x29: case 0x2A:
+                return 5;
+            case 0x26: case 0x27:
+                return 6;
+            default:
+                return 0;
+        }
+    }
+}
+
+Ssd1306Emulator::Ssd1306Emulator(int width, int height)
+    : _width(width), _height(height), _pages((height + 7) / 8), _ram(width * ((height + 7) / 8), 0),
+      _columnEnd(width - 1), _pageEnd((height + 7) / 8 - 1) {}
+
+Ssd1306Emulator::~Ssd1306Emulator() { detach(); }
+
+void Ssd1306Emulator::attach(TwoWire& wire, uint8_t address) {
+    detach();
+    _wire = &wire;
+    _address = address;
+    wire.attach(address, this);
+}
+
+void Ssd1306Emulator::detach() {
+    if (_wire) _wire->detach(_address);
+    _wire = nullptr;
+}
+
+void Ssd1306Emulator::onTransaction(const uint8_t* bytes, size_t len) {
+    // Control byte: bit 6 selects data, bit 7 (Co) says only one byte follows
+    // before the next control byte
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = bytes[i++];
+        bool isData = control & 0x40;
+        bool single = control & 0x80;
+        for (; i < len; i++) {
+            if (isData) data(bytes[i]);
+            else command(bytes[i]);
+            if (single) {
+                i++;
+                break;
+            }
+        }
+    }
+}
+
+void Ssd1306Emulator::command(uint8_t byte) {
+    _command[_commandLength++] = byte;
+    if (_commandLength > argumentCount(_command[0]) || _commandLength == sizeof(_command)) {
+        execute();
+        _commandLength = 0;
+    }
+}
+
+void Ssd1306Emulator::execute() {
+    _commands++;
+    uint8_t c = _command[0];
+    if (c <= 0x0F) {
+        _column = (_column & 0xF0) | c;  // Page mode column, low nibble
+    } else if (c <= 0x1F) {
+        _column = (_column & 0x0F) | ((c & 0x0F) << 4);
+    } else if (c >= 0xB0 && c <= 0xB7) {
+        _page = c & 0x07;
+    } else {
+        switch (c) {
+            case 0x20: _addressingMode = _command[1] & 0x03; break;
+            case 0x21:
+                _columnStart = _column = _command[1] & 0x7F;
+                _columnEnd = _command[2] & 0x7F;
+                break;
+            case 0x22:
+                _pageStart = _page = _command[1] & 0x07;
+                _pageEnd = _command[2] & 0x07;
+                break;
+            case 0x81: _contrast = _command[1]; break;
+            case 0xA4: _entireOn = false; break;
+            case 0xA5: _entireOn = true; break;
+            case 0xA6: _inverted = false; break;
+            case 0xA7: _inverted = true; break;
+            case 0xAE: _on = false; break;
+            case 0xAF: _on = true; break;
+            default: break;  // Timing, charge pump, remap, scrolling: no effect on the image
+        }
+    }
+}
+
+void Ssd1306Emulator::data(uint8_t byte) {
+    _dataBytes++;
+    if (_column < _width && _page < _pages) _ram[_page * _width + _column] = byte;
+
+    switch (_addressingMode) {
+        case 0:  // Horizontal: along the columns of the window, then the next page
+            if (++_column > _columnEnd) {
+                _column = _columnStart;
+                if (++_page > _pageEnd) _page = _pageStart;
+            }
+            break;
+        case 1:  // Vertical: down the pages of the window, then the next column
+            if (++_page > _pageEnd) {
+                _page = _pageStart;
+                if (++_column > _columnEnd) _column = _columnStart;
+            }
+            break;
+        default:  // Page: along the page, wrapping to column 0
+            if (++_column >= _width) _column = 0;
+            break;
+    }
+}
+
+bool Ssd1306Emulator::getPixel(int x, int y) const {
+    if (x < 0 || x >= _width || y < 0 || y >= _height || !_on) return false;
+    bool lit = _entireOn || (_ram[(y / 8) * _width + x] & (1 << (y & 7)));
+    return lit != _inverted;
+}
+
+bool Ssd1306Emulator::matches(const uint8_t* buffer) const {
+    return memcmp(buffer, _ram.data(), _ram.size()) == 0;
+}
+
+uint32_t Ssd1306Emulator::imageHash() const {
+    uint32_t hash = 2166136261u;
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < _width; x++) {
+            hash = (hash ^ (getPixel(x, y) ? 1 : 0)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool Ssd1306Emulator::writePbm(const char* path) const {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P4\n%d %d\n", _width, _height);
+    std::vector<uint8_t> row((_width + 7) / 8);
+    for (int y = 0; y < _height; y++) {
+        std::fill(row.begin(), row.end(), 0);
+        for (int x = 0; x < _width; x++) {
+            if (getPixel(x, y)) row[x / 8] |= 0x80 >> (x & 7);
+        }
+        fwrite(row.data(), 1, row.size(), f);
+    }
+    return fclose(f) == 0;
+}
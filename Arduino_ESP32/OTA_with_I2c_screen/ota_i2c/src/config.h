@@ -16,6 +16,7 @@
 #define SCREEN_HEIGHT 64
 #define OLED_RESET -1
 #define OLED_ADDRESS 0x3C
+#define OLED_I2C_CLOCK 400000  // Display transfers; 1000000 works on most modules
 
 // System Configuration
 #define WDT_TIMEOUT 30  // Watchdog timeout in seconds
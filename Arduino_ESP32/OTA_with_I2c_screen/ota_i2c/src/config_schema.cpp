@@ -0,0 +1,96 @@
+#include "config_schema.h"
+#include "config_store.h"
+
+const ConfigSchema::PinConfig ConfigSchema::DEFAULT_PINS = {
+    .stepperStepPin = 12,    // Example default values
+    .stepperDirPin = 13,
+    .stepperEnablePin = 14,
+    .displaySdaPin = 21,     // ESP32 default I2C pins
+    .displaySclPin = 22,     // ESP32 default I2C pins
+    .displayResetPin = -1,   // Not used
+    .ledPin = 1             // Default LED pin
+};
+
+namespace {
+    uint32_t payloadCrc(const uint8_t* blob, size_t length) {
+        return ConfigStore::crc32(blob + sizeof(ConfigSchema::Header), length - sizeof(ConfigSchema::Header));
+    }
+
+    // Version 1 kept each pin at its own address and the homing result with
+    // its own magic. Returns false when none of it was ever written.
+    bool loadV1(const uint8_t* image, ConfigSchema::Layout& out) {
+        typedef ConfigSchema::V1 V1;
+        bool written = false;
+        for (size_t i = V1::LED_PIN; i < V1::END; i++) {
+            if (image[i] != 0xFF) written = true;
+        }
+        if (!written) return false;
+
+        bool pinsWritten = false;
+        for (size_t i = V1::LED_PIN; i <= V1::DISPLAY_RESET_PIN; i++) {
+            if (image[i] != 0xFF) pinsWritten = true;
+        }
+        if (pinsWritten) {
+            out.pins.ledPin = image[V1::LED_PIN];
+            out.pins.stepperStepPin = image[V1::STEPPER_STEP_PIN];
+            out.pins.stepperDirPin = image[V1::STEPPER_DIR_PIN];
+            out.pins.stepperEnablePin = image[V1::STEPPER_ENABLE_PIN];
+            out.pins.displaySdaPin = image[V1::DISPLAY_SDA_PIN];
+            out.pins.displaySclPin = image[V1::DISPLAY_SCL_PIN];
+            out.pins.displayResetPin = image[V1::DISPLAY_RESET_PIN];
+        }
+        uint32_t magic;
+        int32_t travel;
+        memcpy(&magic, image + V1::HOMING, sizeof(magic));
+        memcpy(&travel, image + V1::HOMING + sizeof(magic), sizeof(travel));
+        if (magic == V1::HOMING_MAGIC && travel > 0) out.homing.travel = travel;
+        return true;
+    }
+}
+
+ConfigSchema::Layout ConfigSchema::defaults() {
+    Layout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.pins = DEFAULT_PINS;
+    layout.homing.travel = 0;
+    seal(layout);
+    return layout;
+}
+
+void ConfigSchema::seal(Layout& layout) {
+    layout.header.magic = MAGIC;
+    layout.header.version = VERSION;
+    layout.header.length = sizeof(Layout);
+    layout.header.crc = payloadCrc((const uint8_t*)&layout, sizeof(Layout));
+}
+
+ConfigSchema::Result ConfigSchema::load(const uint8_t* image, size_t size, Layout& out) {
+    out = defaults();
+    if (size < V1::END || size < sizeof(Layout)) return DEFAULTED;
+
+    Header header;
+    memcpy(&header, image, sizeof(header));
+    if (header.magic == MAGIC) {
+        if (header.length < sizeof(Header) || header.length > size || header.version == 0 ||
+            payloadCrc(image, header.length) != header.crc) {
+            return DEFAULTED;
+        }
+        // Older: the sections it has, defaults for the rest. Newer: the sections this version knows.
+        size_t known = header.length < sizeof(Layout) ? header.length : sizeof(Layout);
+        memcpy((uint8_t*)&out + sizeof(Header), image + sizeof(Header), known - sizeof(Header));
+        seal(out);
+        return header.version == VERSION && header.length == sizeof(Layout) ? VALID : MIGRATED;
+    }
+
+    if (!loadV1(image, out)) return DEFAULTED;
+    seal(out);
+    return MIGRATED;
+}
+
+const char* ConfigSchema::resultName(Result result) {
+    switch (result) {
+        case VALID: return "valid";
+        case MIGRATED: return "migrated";
+        default: return "defaulted";
+    }
+}
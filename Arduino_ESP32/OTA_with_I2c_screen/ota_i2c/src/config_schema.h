@@ -0,0 +1,161 @@
+#ifndef CONFIG_SCHEMA_H
+#define CONFIG_SCHEMA_H
+
+#include <Arduino.h>
+#include <stddef.h>
+
+// Layout of the settings blob at the start of the FlashController image
+// (little endian, packed):
+//   Header   uint32 magic "CFG2", uint16 version, uint16 length (bytes,
+//            header included), uint32 crc32 of bytes [sizeof(Header), length)
+//   pins     PinConfig, 7 x int8
+//   homing   HomingSection: int32 travel (<= 0: not measured), uint32 reserved
+//   position PositionSection (since version 3): int32 position, softMin,
+//            softMax, uint8 flags, 3 reserved; see PositionMemory
+// Offsets and sizes come from the structs: a Field names one member and
+// carries its type, offset and size, so FlashController::get/set<Field>
+// cannot use a wrong address or size.
+//
+// Sections are only ever appended. A blob of an older version is therefore
+// the current one cut short and load() gives the missing sections their
+// defaults; a blob written by a newer firmware keeps the sections this one
+// knows. A version that changes the meaning of an existing section adds its
+// own step to load(). Version 1 is the unversioned address map the settings
+// used before (V1 below), converted field by field.
+class ConfigSchema {
+public:
+    static const uint32_t MAGIC = 0x32474643;  // "CFG2"
+    static const uint16_t VERSION = 3;
+
+    struct __attribute__((packed)) Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t length;
+        uint32_t crc;
+    };
+
+    struct PinConfig {
+        int8_t stepperStepPin;
+        int8_t stepperDirPin;
+        int8_t stepperEnablePin;
+        int8_t displaySdaPin;
+        int8_t displaySclPin;
+        int8_t displayResetPin;
+        int8_t ledPin;
+
+        void print() const {
+            Serial.printf("PinConfig: stepperStep=%d, stepperDir=%d, stepperEnable=%d, "
+                        "displaySda=%d, displayScl=%d, displayReset=%d, led=%d\n",
+                        stepperStepPin, stepperDirPin, stepperEnablePin,
+                        displaySdaPin, displaySclPin, displayResetPin, ledPin);
+        }
+    };
+
+    struct __attribute__((packed)) HomingSection {
+        int32_t travel;
+        uint32_t reserved;
+    };
+
+    struct __attribute__((packed)) PositionSection {
+        enum Flags : uint8_t {
+            AT_REST = 0x01,      // Taken with the motor stopped; nothing is valid without it
+            HOMED = 0x02,
+            SOFT_LIMITS = 0x04,
+        };
+        int32_t position;
+        int32_t softMin;
+        int32_t softMax;
+        uint8_t flags;
+        uint8_t reserved[3];
+    };
+
+    struct __attribute__((packed)) Layout {
+        Header header;
+        PinConfig pins;
+        HomingSection homing;
+        PositionSection position;
+    };
+
+    template<typename T, size_t Offset>
+    struct Field {
+        typedef T Type;
+        static const size_t OFFSET = Offset;
+        static const size_t SIZE = sizeof(T);
+        static_assert(Offset >= sizeof(Header), "A field may not overlap the header");
+        static_assert(Offset + sizeof(T) <= sizeof(Layout), "Field outside the layout");
+    };
+
+#define CONFIG_SCHEMA_FIELD(member) \
+    Field<decltype(((Layout*)nullptr)->member), offsetof(Layout, member)>
+
+    typedef CONFIG_SCHEMA_FIELD(pins) Pins;
+    typedef CONFIG_SCHEMA_FIELD(pins.ledPin) LedPin;
+    typedef CONFIG_SCHEMA_FIELD(homing) Homing;
+    typedef CONFIG_SCHEMA_FIELD(position) Position;
+
+    // Version 1: fixed EEPROM addresses, no header or checksum
+    struct V1 {
+        static const size_t LED_PIN = 32;
+        static const size_t STEPPER_STEP_PIN = 33;
+        static const size_t STEPPER_DIR_PIN = 34;
+        static const size_t STEPPER_ENABLE_PIN = 35;
+        static const size_t DISPLAY_SDA_PIN = 36;
+        static const size_t DISPLAY_SCL_PIN = 37;
+        static const size_t DISPLAY_RESET_PIN = 38;
+        static const size_t HOMING = 64;           // uint32 magic "HOM1", int32 travel, uint32 reserved[2]
+        static const size_t HOMING_SIZE = 16;
+        static const uint32_t HOMING_MAGIC = 0x484F4D31;
+        static const size_t END = HOMING + HOMING_SIZE;
+    };
+
+    enum Result {
+        VALID,      // Current version, checksum good
+        MIGRATED,   // Converted from an older (or newer) version
+        DEFAULTED,  // Nothing usable: blank, corrupt or unknown
+    };
+
+    static const PinConfig DEFAULT_PINS;
+    static Layout defaults();
+
+    // Validates or converts the blob in image (size bytes, at least V1::END)
+    // in one pass; out is always a sealed current-version blob
+    static Result load(const uint8_t* image, size_t size, Layout& out);
+    static void seal(Layout& layout);  // Sets the header for the current version
+    static const char* resultName(Result result);
+
+    // Compile-time layout checks
+    struct Span {
+        size_t offset;
+        size_t size;
+        constexpr size_t end() const { return offset + size; }
+    };
+    static constexpr bool clearOf(Span) { return true; }
+    template<typename... Rest>
+    static constexpr bool clearOf(Span a, Span b, Rest... rest) {
+        return (a.end() <= b.offset || b.end() <= a.offset) && clearOf(a, rest...);
+    }
+    static constexpr bool disjoint(Span) { return true; }
+    template<typename... Rest>
+    static constexpr bool disjoint(Span a, Rest... rest) { return clearOf(a, rest...) && disjoint(rest...); }
+    template<typename F> static constexpr Span span() { return Span{F::OFFSET, F::SIZE}; }
+};
+
+static_assert(ConfigSchema::disjoint(ConfigSchema::Span{0, sizeof(ConfigSchema::Header)},
+                                     ConfigSchema::span<ConfigSchema::Pins>(),
+                                     ConfigSchema::span<ConfigSchema::Homing>(),
+                                     ConfigSchema::span<ConfigSchema::Position>()),
+              "Config sections overlap");
+static_assert(sizeof(ConfigSchema::PinConfig) == 7 && sizeof(ConfigSchema::HomingSection) == 8 &&
+                  sizeof(ConfigSchema::PositionSection) == 16,
+              "Section sizes are part of the stored format");
+static_assert(ConfigSchema::disjoint(ConfigSchema::Span{ConfigSchema::V1::LED_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::STEPPER_STEP_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::STEPPER_DIR_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::STEPPER_ENABLE_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::DISPLAY_SDA_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::DISPLAY_SCL_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::DISPLAY_RESET_PIN, 1},
+                                     ConfigSchema::Span{ConfigSchema::V1::HOMING, ConfigSchema::V1::HOMING_SIZE}),
+              "Version 1 fields overlap");
+
+#endif // CONFIG_SCHEMA_H
@@ -0,0 +1,314 @@
+#include "config_store.h"
+#include <esp_timer.h>
+#include <stddef.h>
+
+namespace {
+    class StoreLock {
+    public:
+        explicit StoreLock(SemaphoreHandle_t lock) : _lock(lock) { if (_lock) xSemaphoreTakeRecursive(_lock, portMAX_DELAY); }
+        ~StoreLock() { if (_lock) xSemaphoreGiveRecursive(_lock); }
+    private:
+        SemaphoreHandle_t _lock;
+    };
+}
+
+ConfigStore::ConfigStore()
+    : _partition(nullptr), _lock(nullptr), _sectors(0), _active(0), _sequence(0), _offset(SECTOR_SIZE),
+      _formatted(false), _flushRequested(false), _dirtyLow(IMAGE_SIZE), _dirtyHigh(0), _dirtySince(0),
+      _lastChange(0), _generation(0), _stats() {
+    memset(_image, 0xFF, sizeof(_image));
+}
+
+ConfigStore::~ConfigStore() {
+    if (_lock) vSemaphoreDelete(_lock);
+}
+
+uint32_t ConfigStore::crc32(const void* data, size_t length, uint32_t crc) {
+    // Reflected 0xEDB88320, as zlib; pass the previous result to continue
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (length--) {
+        crc ^= *p++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+bool ConfigStore::begin(const char* label) {
+    if (!_lock) _lock = xSemaphoreCreateRecursiveMutex();
+    StoreLock lock(_lock);
+    if (_partition) return true;
+
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        Serial.printf("[CONFIG] No \"%s\" partition\n", label);
+        return false;
+    }
+    _partition = partition;
+    _sectors = partition->size / SECTOR_SIZE;
+    if (_sectors > MAX_SECTORS) _sectors = MAX_SECTORS;
+    if (_sectors < 2) {
+        Serial.printf("[CONFIG] Partition \"%s\" too small: %u bytes\n", label, (unsigned)partition->size);
+        _partition = nullptr;
+        return false;
+    }
+
+    bool found = false;
+    for (size_t sector = 0; sector < _sectors; sector++) {
+        uint32_t sequence;
+        if (_mount(sector, sequence) && (!found || sequence > _sequence)) {
+            found = true;
+            _active = sector;
+            _sequence = sequence;
+        }
+    }
+
+    memset(_image, 0xFF, sizeof(_image));
+    if (found) {
+        _offset = _replay(_active);
+    } else {
+        // Blank or unreadable: start the log with an empty image in sector 0
+        _formatted = true;
+        _active = _sectors - 1;
+        _sequence = 0;
+        if (!_compact(0, _image, 0)) {
+            Serial.printf("[CONFIG] Cannot format partition \"%s\"\n", label);
+            _partition = nullptr;
+            return false;
+        }
+    }
+    Serial.printf("[CONFIG] Mounted \"%s\": sector %u of %u, sequence %u, %u bytes used%s\n", label,
+                  (unsigned)_active, (unsigned)_sectors, (unsigned)_sequence, (unsigned)_offset,
+                  _formatted ? " (formatted)" : "");
+    return true;
+}
+
+bool ConfigStore::read(size_t address, void* data, size_t length) const {
+    if (!data || address > IMAGE_SIZE || length > IMAGE_SIZE - address) return false;
+    StoreLock lock(_lock);
+    if (!_partition) return false;
+    memcpy(data, _image + address, length);
+    return true;
+}
+
+bool ConfigStore::write(size_t address, const void* data, size_t length) {
+    Transaction transaction(*this);
+    return transaction.stage(address, data, length) && transaction.commit();
+}
+
+bool ConfigStore::service() {
+    StoreLock lock(_lock);
+    if (_dirtyLow >= _dirtyHigh) return true;
+    uint32_t now = millis();
+    if (!_flushRequested && now - _lastChange < QUIET_MS && now - _dirtySince < MAX_DELAY_MS) return true;
+    if (_flush()) return true;
+    _lastChange = now;  // Retry after another quiet period rather than on every call
+    return false;
+}
+
+bool ConfigStore::flush() {
+    StoreLock lock(_lock);
+    return _flush();
+}
+
+void ConfigStore::requestFlush() {
+    StoreLock lock(_lock);
+    _flushRequested = true;
+}
+
+bool ConfigStore::isDirty() const {
+    StoreLock lock(_lock);
+    return _dirtyLow < _dirtyHigh;
+}
+
+ConfigStore::Stats ConfigStore::getStats() const {
+    StoreLock lock(_lock);
+    Stats stats = _stats;
+    stats.sequence = _sequence;
+    stats.sector = _active;
+    stats.used = _offset;
+    stats.pending = _dirtyLow < _dirtyHigh ? _dirtyHigh - _dirtyLow : 0;
+    return stats;
+}
+
+bool ConfigStore::_flush() {
+    if (!_partition) return false;
+    _flushRequested = false;
+    if (_dirtyLow >= _dirtyHigh) return true;
+
+    // The whole range goes out as one record, so it survives a power loss as a unit
+    int64_t start = esp_timer_get_time();
+    size_t length = _dirtyHigh - _dirtyLow;
+    const uint8_t* data = _image + _dirtyLow;
+    bool ok = _offset + recordSize(length) <= SECTOR_SIZE ? _append(_dirtyLow, data, length)
+                                                          : _compact(_dirtyLow, data, length);
+    uint32_t us = esp_timer_get_time() - start;
+    _stats.lastFlushUs = us;
+    if (us > _stats.maxFlushUs) _stats.maxFlushUs = us;
+    _stats.totalFlushUs += us;
+    if (!ok) {
+        _stats.failures++;
+        Serial.printf("[CONFIG] Flush of %u bytes at %u failed\n", (unsigned)length, (unsigned)_dirtyLow);
+        return false;
+    }
+    _stats.flushes++;
+    _dirtyLow = IMAGE_SIZE;
+    _dirtyHigh = 0;
+    return true;
+}
+
+bool ConfigStore::_program(size_t offset, const void* data, size_t length) {
+    return length == 0 || esp_partition_write(_partition, offset, data, length) == ESP_OK;
+}
+
+bool ConfigStore::_readRecord(size_t sector, size_t offset, RecordHeader& header, bool& empty) {
+    empty = false;
+    size_t base = sector * SECTOR_SIZE;
+    if (esp_partition_read(_partition, base + offset, &header, sizeof(header)) != ESP_OK) return false;
+    if (header.address == 0xFFFF && header.length == 0xFFFF && header.crc == 0xFFFFFFFF) {
+        empty = true;
+        return false;
+    }
+    if (header.length == 0 || header.address + header.length > IMAGE_SIZE ||
+        offset + recordSize(header.length) > SECTOR_SIZE) {
+        return false;
+    }
+    uint8_t* data = _record + sizeof(header);
+    if (esp_partition_read(_partition, base + offset + sizeof(header), data, header.length) != ESP_OK) return false;
+    return crc32(data, header.length, crc32(&header, 4)) == header.crc;
+}
+
+bool ConfigStore::_mount(size_t sector, uint32_t& sequence) {
+    SectorHeader header;
+    if (esp_partition_read(_partition, sector * SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) return false;
+    if (header.magic != MAGIC || crc32(&header, offsetof(SectorHeader, crc)) != header.crc) return false;
+
+    // Only a sector whose snapshot was completed counts
+    RecordHeader snapshot;
+    bool empty;
+    if (!_readRecord(sector, sizeof(SectorHeader), snapshot, empty)) return false;
+    if (snapshot.address != 0 || snapshot.length != IMAGE_SIZE) return false;
+    sequence = header.sequence;
+    return true;
+}
+
+size_t ConfigStore::_replay(size_t sector) {
+    size_t offset = sizeof(SectorHeader);
+    RecordHeader header;
+    bool empty;
+    while (offset + sizeof(header) <= SECTOR_SIZE) {
+        if (!_readRecord(sector, offset, header, empty)) {
+            if (empty) return offset;
+            // Torn by a power loss; nothing after it can be trusted or appended to
+            Serial.printf("[CONFIG] Sector %u: bad record at offset %u, ignoring the rest\n", (unsigned)sector,
+                          (unsigned)offset);
+            return SECTOR_SIZE;
+        }
+        memcpy(_image + header.address, _record + sizeof(header), header.length);
+        offset += recordSize(header.length);
+    }
+    return offset;
+}
+
+bool ConfigStore::_append(size_t address, const uint8_t* data, size_t length) {
+    RecordHeader header = {(uint16_t)address, (uint16_t)length, 0};
+    header.crc = crc32(data, length, crc32(&header, 4));
+    size_t size = recordSize(length);
+    memcpy(_record, &header, sizeof(header));
+    memcpy(_record + sizeof(header), data, length);
+    memset(_record + sizeof(header) + length, 0xFF, size - sizeof(header) - length);  // Padding left unprogrammed
+
+    if (!_program(_active * SECTOR_SIZE + _offset, _record, size)) {
+        _offset = SECTOR_SIZE;  // Possibly half written; the next write starts a new sector
+        return false;
+    }
+    _offset += size;
+    _stats.records++;
+    return true;
+}
+
+bool ConfigStore::_compact(size_t address, const uint8_t* data, size_t length) {
+    size_t next = (_active + 1) % _sectors;
+    size_t base = next * SECTOR_SIZE;
+    if (esp_partition_erase_range(_partition, base, SECTOR_SIZE) != ESP_OK) return false;
+
+    SectorHeader sector = {MAGIC, _sequence + 1, 0xFFFFFFFF, 0};
+    sector.crc = crc32(&sector, offsetof(SectorHeader, crc));
+
+    // Snapshot of the image with the pending write applied, written in place
+    const uint8_t* tail = _image + address + length;
+    size_t tailLength = IMAGE_SIZE - address - length;
+    RecordHeader snapshot = {0, IMAGE_SIZE, 0};
+    snapshot.crc = crc32(tail, tailLength, crc32(data, length, crc32(_image, address, crc32(&snapshot, 4))));
+
+    size_t at = base + sizeof(sector);
+    if (!_program(base, &sector, sizeof(sector)) ||
+        !_program(at, &snapshot, sizeof(snapshot)) ||
+        !_program(at + sizeof(snapshot), _image, address) ||
+        !_program(at + sizeof(snapshot) + address, data, length) ||
+        !_program(at + sizeof(snapshot) + address + length, tail, tailLength)) {
+        return false;  // The previous sector stays active; the next write retries
+    }
+
+    _active = next;
+    _sequence++;
+    _offset = sizeof(sector) + recordSize(IMAGE_SIZE);
+    _stats.compactions++;
+    return true;
+}
+
+ConfigStore::Transaction::Transaction(ConfigStore& store)
+    : _store(store), _open(true), _failed(false), _low(IMAGE_SIZE), _high(0) {
+    if (_store._lock) xSemaphoreTakeRecursive(_store._lock, portMAX_DELAY);
+}
+
+ConfigStore::Transaction::~Transaction() {
+    close();
+}
+
+void ConfigStore::Transaction::close() {
+    if (!_open) return;
+    _open = false;
+    if (_store._lock) xSemaphoreGiveRecursive(_store._lock);
+}
+
+bool ConfigStore::Transaction::stage(size_t address, const void* data, size_t length) {
+    if (!_open || !_store._partition || !data || length == 0 || address > IMAGE_SIZE ||
+        length > IMAGE_SIZE - address) {
+        _failed = true;
+        return false;
+    }
+    if (_low >= _high) memcpy(_store._staged, _store._image, IMAGE_SIZE);  // First stage
+    memcpy(_store._staged + address, data, length);
+    if (address < _low) _low = address;
+    if (address + length > _high) _high = address + length;
+    return true;
+}
+
+bool ConfigStore::Transaction::commit() {
+    if (!_open) return false;
+    bool ok = !_failed;
+    if (ok) {
+        ConfigStore& store = _store;
+        store._stats.commits++;
+        // Only the bytes that differ join the dirty range
+        size_t low = _low, high = _high;
+        while (low < high && store._staged[low] == store._image[low]) low++;
+        while (high > low && store._staged[high - 1] == store._image[high - 1]) high--;
+        if (low == high) {
+            store._stats.unchanged++;
+        } else {
+            memcpy(store._image + low, store._staged + low, high - low);
+            uint32_t now = millis();
+            if (store._dirtyLow >= store._dirtyHigh) store._dirtySince = now;
+            store._lastChange = now;
+            if (low < store._dirtyLow) store._dirtyLow = low;
+            if (high > store._dirtyHigh) store._dirtyHigh = high;
+            store._generation++;
+        }
+    }
+    close();
+    return ok;
+}
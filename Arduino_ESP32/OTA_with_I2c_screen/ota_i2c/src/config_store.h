@@ -0,0 +1,158 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Byte-addressed configuration image (IMAGE_SIZE bytes, reads 0xFF where
+// nothing was written) kept in RAM and persisted as an append-only log in a
+// dedicated flash partition, so a write costs one small record instead of a
+// rewrite of the whole image.
+//
+// Flash layout, little endian, in each SECTOR_SIZE sector of the partition:
+//   SectorHeader  uint32 magic "CFGS", uint32 sequence, uint32 reserved,
+//                 uint32 crc32 of the first 12 bytes
+//   Record        uint16 address, uint16 length, uint32 crc32 of address,
+//                 length and data; then the data, padded to 4 bytes
+// The first record of a sector is a snapshot of the whole image; later ones
+// are flushes of the changed range, in order. When the active sector is full
+// the next one (round robin, so erases are spread over all of them) is
+// erased and started with a snapshot that includes the pending changes.
+// Mounting replays the valid sector with the highest sequence and stops at
+// the first record that fails its CRC, so a flush cut short by a power loss
+// reads back either complete or not at all, and a sector whose compaction was
+// interrupted is ignored in favour of the previous one.
+//
+// Changes are write-behind: write() and Transaction::commit() only update
+// the RAM image and widen a dirty range; service(), called periodically from
+// one low-priority task, writes that range as a single record once no change
+// has been made for QUIET_MS (or MAX_DELAY_MS after the first unflushed
+// one), so a burst of changes costs one flash commit and nothing that makes
+// a change waits for the flash. flush() does it at once, e.g. before a
+// restart. Reads come from RAM only. All calls may be made from any task,
+// but flush() and service() stall the caller (and, while the flash is busy,
+// code running from it on the other core): keep them off the async_tcp task
+// and the motion tasks.
+class ConfigStore
+{
+public:
+    static const size_t IMAGE_SIZE = 512;
+    static const size_t SECTOR_SIZE = SPI_FLASH_SEC_SIZE;
+    static const size_t MAX_SECTORS = 16;
+    static const uint32_t MAGIC = 0x53474643;  // "CFGS"
+    static const uint32_t QUIET_MS = 500;
+    static const uint32_t MAX_DELAY_MS = 5000;
+
+    struct __attribute__((packed)) SectorHeader {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t reserved;
+        uint32_t crc;
+    };
+
+    struct __attribute__((packed)) RecordHeader {
+        uint16_t address;
+        uint16_t length;
+        uint32_t crc;
+    };
+
+    struct Stats {
+        uint32_t commits;       // Transactions committed (a write() is one)
+        uint32_t unchanged;     // Of which changed nothing
+        uint32_t flushes;       // Flash commits; each is one record or one compaction
+        uint32_t records;       // Appended to the active sector
+        uint32_t compactions;   // Sector switches (one erase each)
+        uint32_t failures;      // Flash errors; the changes stay pending and are retried
+        uint32_t lastFlushUs;
+        uint32_t maxFlushUs;
+        uint64_t totalFlushUs;
+        uint32_t sequence;      // Of the active sector
+        uint16_t sector;
+        uint16_t used;          // Bytes of the active sector in use
+        uint16_t pending;       // Bytes in the dirty range, 0 when all is in flash
+    };
+
+    // Changes that become visible, and reach flash, together. Holds the
+    // store from construction until commit() or destruction, so keep it
+    // short, and do not nest one in another; reads from the same task see
+    // the image without the staged changes.
+    class Transaction
+    {
+    public:
+        explicit Transaction(ConfigStore& store);
+        ~Transaction();  // Drops what was staged if commit() was not called
+
+        bool stage(size_t address, const void* data, size_t length);
+        template<typename T> bool stage(size_t address, const T& value) { return stage(address, &value, sizeof(T)); }
+        bool commit();   // False, with nothing applied, if a stage() failed
+
+    private:
+        Transaction(const Transaction&);
+        Transaction& operator=(const Transaction&);
+        void close();
+
+        ConfigStore& _store;
+        bool _open;
+        bool _failed;
+        size_t _low;
+        size_t _high;
+    };
+
+    ConfigStore();
+    ~ConfigStore();
+
+    // Mounts the partition with this label. False when it does not exist or
+    // cannot be read; a partition without a valid sector is formatted with an
+    // empty image and formatted() reports it.
+    bool begin(const char* label = "config");
+    bool isMounted() const { return _partition != nullptr; }
+    bool formatted() const { return _formatted; }
+
+    bool read(size_t address, void* data, size_t length) const;
+    bool write(size_t address, const void* data, size_t length);  // One-range transaction
+
+    bool service();        // Flushes when the quiet period is over or a flush was requested
+    bool flush();          // Writes the pending changes now; true when nothing is pending
+    void requestFlush();   // Next service() flushes, quiet or not; for tasks that must not write
+    bool isDirty() const;
+    uint32_t generation() const { return _generation; }  // Bumped by every commit that changes the image
+
+    Stats getStats() const;
+    static uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+private:
+    static const size_t RECORD_MAX = sizeof(RecordHeader) + IMAGE_SIZE;
+
+    const esp_partition_t* _partition;
+    SemaphoreHandle_t _lock;  // Recursive: a task in a Transaction may still read
+    size_t _sectors;
+    size_t _active;
+    uint32_t _sequence;
+    size_t _offset;         // Next free byte of the active sector
+    bool _formatted;
+    bool _flushRequested;
+    size_t _dirtyLow;       // Changed range not yet in flash; empty when low >= high
+    size_t _dirtyHigh;
+    uint32_t _dirtySince;   // millis() of the first and the latest unflushed change
+    uint32_t _lastChange;
+    volatile uint32_t _generation;
+    Stats _stats;
+    uint8_t _image[IMAGE_SIZE];
+    uint8_t _staged[IMAGE_SIZE];  // The open transaction's view
+    uint8_t _record[RECORD_MAX];  // Encode/decode buffer; only touched with _lock held
+
+    static size_t recordSize(size_t length) { return sizeof(RecordHeader) + ((length + 3) & ~(size_t)3); }
+
+    // Called with _lock held
+    bool _program(size_t offset, const void* data, size_t length);
+    bool _flush();
+    bool _readRecord(size_t sector, size_t offset, RecordHeader& header, bool& empty);  // Data into _record
+    bool _mount(size_t sector, uint32_t& sequence);
+    size_t _replay(size_t sector);  // Loads the image; returns the free offset
+    bool _append(size_t address, const uint8_t* data, size_t length);
+    bool _compact(size_t address, const uint8_t* data, size_t length);  // Next sector, snapshot with the write
+};
+
+#endif // CONFIG_STORE_H
@@ -1,79 +1,130 @@
 #include "control_signal_handler.h"
+#include <ArduinoJson.h>
+#include "logger.h"
 
-ControlSignalHandler::ControlSignalHandler(DisplayManager& display)
-    : _display(display), _initialized(false) {}
+static const char* const ACTION_NAMES[] = {"report", "forceStop", "stopDirection", "decelerate"};
+
+ControlSignalHandler::ControlSignalHandler(DisplayManager& display, StepperManager& stepper)
+    : _display(display), _stepper(stepper), _initialized(false) {}
+
+ControlSignalHandler::~ControlSignalHandler() {
+    // The interrupts point into _switches
+    _switches.forEach([](SwitchHandle, LimitSwitch& sw) { detachInterrupt(sw.getPin()); });
+}
 
 bool ControlSignalHandler::init() {
     _initialized = true;
-    Serial.println("ControlSignalHandler initialized");
+    LOG_INFO("ControlSignalHandler initialized");
     return true;
 }
 
 void ControlSignalHandler::handle() {
-    // Update all switches
-    for (const auto& sw : _limitSwitches) {
-        sw->update();
+    // Stop reports of the switch interrupts
+    _switches.forEach([](SwitchHandle, LimitSwitch& sw) { sw.update(); });
+
+    // Debounced changes; nothing to do on a quiet tick
+    if (!_sampler.sample()) return;
+    InputSampler::Event event;
+    while (_sampler.popEvent(event)) {
+        SwitchHandle handle = _switches.findByPin(event.pin);
+        LimitSwitch* sw = _switches.get(handle);
+        if (!sw) continue;
+        sw->setDebouncedState(event.active);
+        if (event.active) {
+            _triggeredMask |= 1u << handle;
+        } else {
+            _triggeredMask &= ~(1u << handle);
+        }
+        EventBus::instance().publish(EventBus::INPUT_CHANGED, event.pin, event.active, sw->getId());
     }
 }
 
-bool ControlSignalHandler::addLimitSwitch(uint8_t pin, const char* id, bool activeLow) {
-    // Check if ID already exists
-    for (const auto& sw : _limitSwitches) {
-        if (strcmp(sw->getId(), id) == 0) {
-            Serial.printf("Switch with ID %s already exists\n", id);
-            return false;
-        }
+ControlSignalHandler::SwitchHandle ControlSignalHandler::addLimitSwitch(uint8_t pin, const char* id, bool activeLow,
+                                                                        LimitSwitch::Action action, int8_t direction) {
+    if (_switches.find(id) != INVALID_SWITCH) {
+        LOG_WARN("Switch with ID %s already exists", id);
+        return INVALID_SWITCH;
     }
     
-    // Determine priority based on switch ID
-    uint8_t priority = LimitSwitch::PRIORITY_NORMAL;  // Default priority
-    if (strstr(id, "HOME") || strstr(id, "LIMIT")) {
-        priority = LimitSwitch::PRIORITY_CRITICAL;  // Home and limit switches are critical
-    } else if (strstr(id, "EMERGENCY")) {
-        priority = LimitSwitch::PRIORITY_HIGH;  // Emergency stops are high priority
-    }
+    // A switch that stops the motor gets the highest interrupt priority
+    uint8_t priority = action == LimitSwitch::ACTION_REPORT ? LimitSwitch::PRIORITY_NORMAL
+                                                            : LimitSwitch::PRIORITY_CRITICAL;
     
-    // Create and initialize new switch
-    auto newSwitch = std::make_shared<LimitSwitch>(pin, id, activeLow, priority);
+    // Create and initialize new switch in place
+    SwitchHandle handle = _switches.add(pin, id, activeLow, priority, &_edgeLog);
+    LimitSwitch* newSwitch = _switches.get(handle);
+    if (!newSwitch) {
+        LOG_WARN("No free slot for switch %s on pin %d (pin taken or %d switches)", id, pin, MAX_SWITCHES);
+        return INVALID_SWITCH;
+    }
+    newSwitch->setAction(action, direction, &_stepper);
     if (!newSwitch->init()) {
-        Serial.printf("Failed to initialize switch %s on pin %d\n", id, pin);
-        return false;
+        LOG_ERROR("Failed to initialize switch %s on pin %d", id, pin);
+        _switches.remove(handle);
+        return INVALID_SWITCH;
     }
     
-    _limitSwitches.push_back(newSwitch);
-    Serial.printf("Added switch %s on pin %d (activeLow: %d, priority: %d)\n", 
-                 id, pin, activeLow, priority);
-    return true;
+    _sampler.addPin(pin, activeLow);
+    LOG_INFO("Added switch %s on pin %d (handle: %d, activeLow: %d, priority: %d, action: %s)",
+             id, pin, handle, activeLow, priority, ACTION_NAMES[action]);
+    return handle;
+}
+
+bool ControlSignalHandler::removeLimitSwitch(SwitchHandle handle) {
+    LimitSwitch* sw = _switches.get(handle);
+    if (!sw) return false;
+    detachInterrupt(sw->getPin());
+    _sampler.removePin(sw->getPin());
+    _triggeredMask &= ~(1u << handle);
+    return _switches.remove(handle);
 }
 
 void ControlSignalHandler::removeLimitSwitch(const char* id) {
-    auto it = std::find_if(_limitSwitches.begin(), _limitSwitches.end(),
-        [id](const std::shared_ptr<LimitSwitch>& sw) { 
-            return strcmp(sw->getId(), id) == 0; 
-        });
-    
-    if (it != _limitSwitches.end()) {
-        _limitSwitches.erase(it);
-    }
+    removeLimitSwitch(_switches.find(id));
 }
 
-bool ControlSignalHandler::isLimitSwitchTriggered(const char* id) const {
-    for (const auto& sw : _limitSwitches) {
-        if (strcmp(sw->getId(), id) == 0) {
-            return sw->isTriggered();
-        }
+bool ControlSignalHandler::setSwitchAction(SwitchHandle handle, LimitSwitch::Action action, int8_t direction) {
+    LimitSwitch* sw = _switches.get(handle);
+    if (!sw) return false;
+    sw->setAction(action, direction, &_stepper);
+    return true;
+}
+
+int ControlSignalHandler::parseAction(const char* name) {
+    for (int i = 0; i < (int)(sizeof(ACTION_NAMES) / sizeof(ACTION_NAMES[0])); i++) {
+        if (strcmp(name, ACTION_NAMES[i]) == 0) return i;
     }
-    return false;
+    return -1;
 }
 
-void ControlSignalHandler::registerSignalHandler(SignalHandlerFunc handler) {
-    _signalHandler = handler;
-    Serial.println("Signal handler registered");
+String ControlSignalHandler::getSwitchesJson() const {
+    DynamicJsonDocument doc(128 + _switches.size() * 256);
+    JsonArray switches = doc.createNestedArray("switches");
+    _switches.forEach([&switches](SwitchHandle handle, const LimitSwitch& sw) {
+        LimitSwitch::StopReport stop = sw.getLastStop();
+        JsonObject entry = switches.createNestedObject();
+        entry["id"] = sw.getId();
+        entry["handle"] = handle;
+        entry["pin"] = sw.getPin();
+        entry["triggered"] = sw.isTriggered();
+        entry["action"] = ACTION_NAMES[sw.getAction()];
+        entry["direction"] = sw.getDirection();
+        entry["stops"] = stop.stops;
+        entry["actionUs"] = stop.actionUs;
+        entry["stopUs"] = stop.stopUs;
+        entry["overrunSteps"] = stop.overrunSteps;
+    });
+    String json;
+    serializeJson(doc, json);
+    return json;
 }
 
-void ControlSignalHandler::onSwitchActivated(const char* switchId) {
-    Serial.printf("Switch activated: %s\n", switchId);
-    if (_signalHandler) {
-        _signalHandler(switchId);
-    }
-} 
\ No newline at end of file
+LimitSwitch::StopReport ControlSignalHandler::getLastStop(SwitchHandle handle) const {
+    const LimitSwitch* sw = _switches.get(handle);
+    return sw ? sw->getLastStop() : LimitSwitch::StopReport();
+}
+
+LimitSwitch::Edge ControlSignalHandler::getLastEdge(SwitchHandle handle) const {
+    const LimitSwitch* sw = _switches.get(handle);
+    return sw ? sw->getLastEdge() : LimitSwitch::Edge();
+}
@@ -1,38 +1,68 @@
 #ifndef CONTROL_SIGNAL_HANDLER_H
 #define CONTROL_SIGNAL_HANDLER_H
 
-#include <vector>
-#include <functional>
-#include <memory>  // For shared_ptr
+#include "edge_log.h"
+#include "event_bus.h"
+#include "input_registry.h"
+#include "input_sampler.h"
 #include "limit_switch.h"
 #include "display_manager.h"
+#include "stepper_manager.h"
 
 class ControlSignalHandler {
 public:
-    // Signal handler function type
-    using SignalHandlerFunc = std::function<void(const char*)>;
-    
-    ControlSignalHandler(DisplayManager& display);
-    // No need for explicit destructor with shared_ptr
-    
+    static const uint8_t MAX_SWITCHES = 32;
+    typedef InputRegistry<LimitSwitch, MAX_SWITCHES> SwitchRegistry;
+    typedef SwitchRegistry::Handle SwitchHandle;
+    static const SwitchHandle INVALID_SWITCH = SwitchRegistry::INVALID;
+
+    ControlSignalHandler(DisplayManager& display, StepperManager& stepper);
+    ~ControlSignalHandler();
+
     bool init();
-    void handle();
-    
-    // Limit switch management
-    bool addLimitSwitch(uint8_t pin, const char* id, bool activeLow = true);
+    void handle();  // One debounce sample of every switch; call at a fixed rate.
+                    // Each debounced change is published as EventBus::INPUT_CHANGED.
+
+    // Limit switch management. Switches are added and removed during setup.
+    // action is latched by the switch's interrupt; direction is the side of travel it guards.
+    // Returns INVALID_SWITCH when the ID or pin is taken or all slots are used.
+    SwitchHandle addLimitSwitch(uint8_t pin, const char* id, bool activeLow = true,
+                                LimitSwitch::Action action = LimitSwitch::ACTION_REPORT, int8_t direction = 0);
+    bool removeLimitSwitch(SwitchHandle handle);
     void removeLimitSwitch(const char* id);
-    bool isLimitSwitchTriggered(const char* id) const;
-    
-    // Signal handler registration
-    void registerSignalHandler(SignalHandlerFunc handler);
-    
+    SwitchHandle findLimitSwitch(const char* id) const { return _switches.find(id); }  // Linear; resolve once
+
+    // Debounced state, safe from any task or an ISR
+    bool IRAM_ATTR isLimitSwitchTriggered(SwitchHandle handle) const {
+        return handle >= 0 && handle < (SwitchHandle)MAX_SWITCHES && ((_triggeredMask >> handle) & 1);
+    }
+    uint32_t IRAM_ATTR triggeredMask() const { return _triggeredMask; }  // Bit n = handle n
+    uint32_t switchMask() const { return _switches.mask(); }              // Handles in use
+
+    LimitSwitch::StopReport getLastStop(SwitchHandle handle) const;
+    LimitSwitch::Edge getLastEdge(SwitchHandle handle) const;  // count 0 when unknown or never closed
+    bool setSwitchAction(SwitchHandle handle, LimitSwitch::Action action, int8_t direction);
+
+    // By ID, for the web API and setup code
+    bool isLimitSwitchTriggered(const char* id) const { return isLimitSwitchTriggered(findLimitSwitch(id)); }
+    LimitSwitch::StopReport getLastStop(const char* id) const { return getLastStop(findLimitSwitch(id)); }
+    LimitSwitch::Edge getLastEdge(const char* id) const { return getLastEdge(findLimitSwitch(id)); }
+    bool setSwitchAction(const char* id, LimitSwitch::Action action, int8_t direction) {
+        return setSwitchAction(findLimitSwitch(id), action, direction);
+    }
+
+    const EdgeLog& edgeLog() const { return _edgeLog; }  // Every switch edge, from the interrupts
+    String getSwitchesJson() const;  // State, action and last stop report of every switch
+    static int parseAction(const char* name);  // -1 when unknown
+
 private:
     DisplayManager& _display;
-    std::vector<std::shared_ptr<LimitSwitch>> _limitSwitches;  // Using shared_ptr
-    SignalHandlerFunc _signalHandler;
+    StepperManager& _stepper;
+    EdgeLog _edgeLog;
+    SwitchRegistry _switches;
+    volatile uint32_t _triggeredMask = 0;
+    InputSampler _sampler;  // Debounces all switch pins from one register read
     bool _initialized;
-    
-    void onSwitchActivated(const char* switchId);
 };
 
-#endif // CONTROL_SIGNAL_HANDLER_H 
\ No newline at end of file
+#endif // CONTROL_SIGNAL_HANDLER_H
\ No newline at end of file
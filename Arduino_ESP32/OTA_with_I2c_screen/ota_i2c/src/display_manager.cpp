@@ -1,26 +1,56 @@
 #include "display_manager.h"
 #include <Wire.h>
+#include <esp_timer.h>
+#include <ArduinoJson.h>
 #include "memory_manager.h"
 
-DisplayManager::DisplayManager(int width, int height, int resetPin) : _display(width, height, &Wire, resetPin) {}
+// Holds the display lock for the rest of the scope
+class DisplayLock 
+{
+public:
+    explicit DisplayLock(SemaphoreHandle_t lock) : _lock(lock) { if (_lock) xSemaphoreTakeRecursive(_lock, portMAX_DELAY); }
+    ~DisplayLock() { if (_lock) xSemaphoreGiveRecursive(_lock); }
+
+private:
+    SemaphoreHandle_t _lock;
+};
+
+// ESP32 Wire buffer; each transaction repeats the control byte
+static const size_t I2C_CHUNK = 128;
+
+// Bytes a separate window costs over extending one: the address command
+// transaction and the data control byte
+static const int WINDOW_OVERHEAD = 9;
+
+DisplayManager::DisplayManager(int width, int height, int resetPin, uint32_t i2cClock)
+    : _display(width, height, &Wire, resetPin, i2cClock, IDLE_I2C_CLOCK), _i2cClock(i2cClock) {}
 
 bool DisplayManager::init(uint8_t i2cAddress) 
 {
+    if (!_lock) _lock = xSemaphoreCreateRecursiveMutex();
+    DisplayLock lock(_lock);
     if (!_display.begin(SSD1306_SWITCHCAPVCC, i2cAddress)) 
     {
         _initialized = false;
         return false;
     }
+    _address = i2cAddress;
     _setupDisplay();
     _initialized = true;
     return true;
 }
 
-void DisplayManager::_setupDisplay() { _display.clearDisplay(); _display.display(); }
+void DisplayManager::_setupDisplay() 
+{
+    _display.clearDisplay();
+    _display.display();
+    _shown.assign(_display.getBuffer(), _display.getBuffer() + _display.width() * ((_display.height() + 7) / 8));
+    _textValid = false;
+}
 
-void DisplayManager::clear() { _display.clearDisplay(); }
+void DisplayManager::clear() { DisplayLock lock(_lock); _display.clearDisplay(); _textValid = false; }
 
-void DisplayManager::display() { _display.display(); }
+void DisplayManager::display() { DisplayLock lock(_lock); _flush(); }
 
 void DisplayManager::_setupTextDisplay() 
 {
@@ -29,25 +59,324 @@ void DisplayManager::_setupTextDisplay()
     _display.setTextColor(SSD1306_WHITE);
 }
 
+static void copyLine(char* line, const char* text) 
+{
+    strncpy(line, text, DisplayManager::MAX_LINE_LENGTH);
+    line[DisplayManager::MAX_LINE_LENGTH] = '\0';
+}
+
+static bool sameText(uint8_t count, const char (*a)[DisplayManager::MAX_LINE_LENGTH + 1],
+                     const char (*b)[DisplayManager::MAX_LINE_LENGTH + 1]) 
+{
+    for (uint8_t i = 0; i < count; i++) 
+    {
+        if (strcmp(a[i], b[i]) != 0) return false;
+    }
+    return true;
+}
+
 void DisplayManager::displayText(const char* text, int line) 
 {
-    _setupTextDisplay();
-    _display.setCursor(0, line * 10);
-    _display.println(text);
-    _display.display();
+    if (line < 0) line = 0;
+    if (line >= MAX_LINES) line = MAX_LINES - 1;
+    TextFrame frame;
+    frame.count = line + 1;
+    for (int i = 0; i < line; i++) frame.lines[i][0] = '\0';
+    copyLine(frame.lines[line], text);
+    _show(frame);
 }
 
 void DisplayManager::displayLines(const std::vector<String>& lines) 
 {
+    TextFrame frame;
+    frame.count = lines.size() < MAX_LINES ? lines.size() : MAX_LINES;
+    for (uint8_t i = 0; i < frame.count; i++) copyLine(frame.lines[i], lines[i].c_str());
+    _show(frame);
+}
+
+void DisplayManager::_show(const TextFrame& frame) 
+{
+    portENTER_CRITICAL(&_frameLock);
+    _message = frame;
+    _messageShown = true;
+    _lastMessageMs = millis();
+    portEXIT_CRITICAL(&_frameLock);
+    _post(frame);
+}
+
+void DisplayManager::_post(const TextFrame& frame) 
+{
+    portENTER_CRITICAL(&_frameLock);
+    _stats.requested++;
+    if (_async) 
+    {
+        // Replaces a frame the display task has not drawn yet
+        _posted = frame;
+        _postedValid = true;
+    }
+    portEXIT_CRITICAL(&_frameLock);
+    if (_async) return;
+
+    DisplayLock lock(_lock);
+    _draw(frame);
+}
+
+static const char* const MODE_NAMES[] = {"messages", "dashboard"};
+
+const char* DisplayManager::modeName(Mode mode) 
+{
+    return mode <= MODE_DASHBOARD ? MODE_NAMES[mode] : "unknown";
+}
+
+int DisplayManager::parseMode(const char* name) 
+{
+    for (int i = 0; i <= MODE_DASHBOARD; i++) 
+    {
+        if (strcmp(name, MODE_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+void DisplayManager::setMode(Mode mode) 
+{
+    if (mode == _mode) return;
+    _mode = mode;
+    if (mode == MODE_DASHBOARD) 
+    {
+        _dashboardNow = true;  // Show it straight away, over any message
+        return;
+    }
+    portENTER_CRITICAL(&_frameLock);
+    bool shown = _messageShown;
+    TextFrame message = _message;
+    portEXIT_CRITICAL(&_frameLock);
+    if (shown) _post(message);
+}
+
+void DisplayManager::setDashboardInterval(uint32_t ms) 
+{
+    if (ms < MIN_DASHBOARD_INTERVAL_MS) ms = MIN_DASHBOARD_INTERVAL_MS;
+    if (ms > MAX_DASHBOARD_INTERVAL_MS) ms = MAX_DASHBOARD_INTERVAL_MS;
+    _dashboardIntervalMs = ms;
+}
+
+bool DisplayManager::dashboardDue() const 
+{
+    if (_mode != MODE_DASHBOARD) return false;
+    if (_dashboardNow) return true;
+    unsigned long now = millis();
+    if (_messageShown && now - _lastMessageMs < MESSAGE_HOLD_MS) return false;
+    return now - _lastDashboardMs >= _dashboardIntervalMs;
+}
+
+void DisplayManager::postDashboard(const Dashboard& d) 
+{
+    int64_t start = esp_timer_get_time();
+    TextFrame frame;
+    frame.count = 6;
+    snprintf(frame.lines[0], sizeof(frame.lines[0]), "Pos %ld", (long)d.position);
+    snprintf(frame.lines[1], sizeof(frame.lines[1]), "Tgt %ld", (long)d.target);
+    snprintf(frame.lines[2], sizeof(frame.lines[2]), "Spd %.0f %s", d.speed, d.running ? "RUN" : "");
+
+    // One character per configured switch, '#' when closed
+    char* p = frame.lines[3];
+    p += sprintf(p, "SW  ");
+    for (uint32_t used = d.switchesUsed; used && p < frame.lines[3] + 21; used &= used - 1) 
+    {
+        uint32_t bit = used & -used;
+        *p++ = (d.switchesClosed & bit) ? '#' : '.';
+    }
+    *p = '\0';
+    if (d.wifiConnected) snprintf(frame.lines[4], sizeof(frame.lines[4]), "WiFi %d dBm", d.rssi);
+    else snprintf(frame.lines[4], sizeof(frame.lines[4]), "WiFi down");
+    snprintf(frame.lines[5], sizeof(frame.lines[5]), "Heap %lu KB", (unsigned long)(d.freeHeap / 1024));
+
+    _lastDashboardMs = millis();
+    _dashboardNow = false;
+    portENTER_CRITICAL(&_frameLock);
+    _stats.dashboards++;
+    _stats.renderUs += esp_timer_get_time() - start;
+    portEXIT_CRITICAL(&_frameLock);
+    _post(frame);
+}
+
+bool DisplayManager::render() 
+{
+    TextFrame frame;
+    portENTER_CRITICAL(&_frameLock);
+    bool posted = _postedValid;
+    if (posted) frame = _posted;
+    _postedValid = false;
+    portEXIT_CRITICAL(&_frameLock);
+    if (!posted) return false;
+
+    DisplayLock lock(_lock);
+    _draw(frame);
+    return true;
+}
+
+void DisplayManager::_draw(const TextFrame& frame) 
+{
+    if (_textValid && frame.count == _text.count && sameText(frame.count, frame.lines, _text.lines)) 
+    {
+        portENTER_CRITICAL(&_frameLock);
+        _stats.unchanged++;  // Already on screen
+        portEXIT_CRITICAL(&_frameLock);
+        return;
+    }
+    int64_t start = esp_timer_get_time();
     _setupTextDisplay();
     
-    for (size_t i = 0; i < lines.size(); i++) 
+    for (uint8_t i = 0; i < frame.count; i++) 
     {
         _display.setCursor(0, i * 10);
-        _display.println(lines[i].c_str());
+        _display.println(frame.lines[i]);
     }
     
-    _display.display();
+    _text = frame;
+    _textValid = true;
+    _flush();
+    portENTER_CRITICAL(&_frameLock);
+    _stats.rendered++;
+    _stats.renderUs += esp_timer_get_time() - start;
+    portEXIT_CRITICAL(&_frameLock);
+}
+
+DisplayManager::Stats DisplayManager::getStats() const 
+{
+    portENTER_CRITICAL(&_frameLock);
+    Stats copy = _stats;
+    portEXIT_CRITICAL(&_frameLock);
+    return copy;
+}
+
+String DisplayManager::getStatsJson() const 
+{
+    Stats stats = getStats();
+    StaticJsonDocument<512> doc;
+    doc["requested"] = stats.requested;
+    doc["rendered"] = stats.rendered;
+    doc["unchanged"] = stats.unchanged;
+    doc["coalesced"] = stats.requested - stats.rendered - stats.unchanged;
+    doc["transfers"] = stats.transfers;
+    doc["bytes"] = stats.bytes;
+    doc["i2cMs"] = (uint32_t)(stats.i2cUs / 1000);
+    doc["i2cMaxUs"] = stats.maxI2cUs;
+    doc["i2cClock"] = _i2cClock;
+    doc["async"] = (bool)_async;
+    doc["mode"] = modeName(_mode);
+    doc["dashboardIntervalMs"] = (uint32_t)_dashboardIntervalMs;
+    doc["dashboards"] = stats.dashboards;
+    doc["renderMs"] = (uint32_t)(stats.renderUs / 1000);
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
+
+void DisplayManager::_flush() 
+{
+    if (_shown.empty()) return;  // Not initialized
+    const uint8_t* frame = _display.getBuffer();
+    int width = _display.width();
+    int pages = (_display.height() + 7) / 8;
+    if (pages > MAX_PAGES) pages = MAX_PAGES;
+
+    // Changed column range of every page, -1 when the page is unchanged
+    int first[MAX_PAGES], last[MAX_PAGES];
+    bool changed = false;
+    for (int page = 0; page < pages; page++) 
+    {
+        const uint8_t* row = frame + page * width;
+        const uint8_t* shownRow = _shown.data() + page * width;
+        first[page] = last[page] = -1;
+        if (memcmp(row, shownRow, width) == 0) continue;
+        int c0 = 0, c1 = width - 1;
+        while (row[c0] == shownRow[c0]) c0++;
+        while (row[c1] == shownRow[c1]) c1--;
+        first[page] = c0;
+        last[page] = c1;
+        changed = true;
+    }
+    if (!changed) return;
+
+    // Neighbouring changes share a window when the extra bytes cost less
+    // than another window
+    int64_t start = esp_timer_get_time();
+    size_t bytes = 0;
+    _wire->setClock(_i2cClock);
+    int p0 = -1, p1 = 0, c0 = 0, c1 = 0, cost = 0;
+    for (int page = 0; page < pages; page++) 
+    {
+        if (first[page] < 0) continue;
+        if (p0 >= 0) 
+        {
+            int m0 = first[page] < c0 ? first[page] : c0;
+            int m1 = last[page] > c1 ? last[page] : c1;
+            int merged = (m1 - m0 + 1) * (page - p0 + 1);
+            if (merged <= cost + WINDOW_OVERHEAD + (last[page] - first[page] + 1)) 
+            {
+                p1 = page;
+                c0 = m0;
+                c1 = m1;
+                cost = merged;
+                continue;
+            }
+            bytes += _sendWindow(p0, p1, c0, c1);
+        }
+        p0 = p1 = page;
+        c0 = first[page];
+        c1 = last[page];
+        cost = c1 - c0 + 1;
+    }
+    bytes += _sendWindow(p0, p1, c0, c1);
+    _wire->setClock(IDLE_I2C_CLOCK);
+
+    uint32_t elapsed = esp_timer_get_time() - start;
+    portENTER_CRITICAL(&_frameLock);
+    _stats.transfers++;
+    _stats.bytes += bytes;
+    _stats.i2cUs += elapsed;
+    if (elapsed > _stats.maxI2cUs) _stats.maxI2cUs = elapsed;
+    portEXIT_CRITICAL(&_frameLock);
+}
+
+size_t DisplayManager::_sendWindow(int firstPage, int lastPage, int firstColumn, int lastColumn) 
+{
+    const uint8_t window[] = {SSD1306_PAGEADDR, (uint8_t)firstPage, (uint8_t)lastPage,
+                              SSD1306_COLUMNADDR, (uint8_t)firstColumn, (uint8_t)lastColumn};
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x00);  // Command stream
+    _wire->write(window, sizeof(window));
+    _wire->endTransmission();
+
+    // Horizontal addressing walks the window column by column, page by page
+    int width = _display.width();
+    const uint8_t* frame = _display.getBuffer();
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t)0x40);  // Data stream
+    size_t bytesOut = 1;
+    size_t total = 1 + sizeof(window) + 1;
+    for (int page = firstPage; page <= lastPage; page++) 
+    {
+        for (int column = firstColumn; column <= lastColumn; column++) 
+        {
+            if (bytesOut >= I2C_CHUNK) 
+            {
+                _wire->endTransmission();
+                _wire->beginTransmission(_address);
+                _wire->write((uint8_t)0x40);
+                bytesOut = 1;
+                total++;
+            }
+            uint8_t value = frame[page * width + column];
+            _wire->write(value);
+            _shown[page * width + column] = value;
+            bytesOut++;
+            total++;
+        }
+    }
+    _wire->endTransmission();
+    return total;
 }
 
 void DisplayManager::displayMemoryInfo() 
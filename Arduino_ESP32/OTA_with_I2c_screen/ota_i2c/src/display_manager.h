@@ -3,27 +3,133 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <Wire.h>
 #include <vector>
 #include <Arduino.h>
 
+// Text screens on the SSD1306. The text on screen is retained: drawing the
+// same lines again costs nothing, and a change only transfers the 8-pixel
+// pages and column ranges whose bytes differ from what the panel already
+// shows (a full frame is ~1 KB, about 25 ms at 400 kHz).
+//
+// Until startAsync() displayText()/displayLines() draw before returning.
+// After it they only post the frame and return; render(), called from the
+// display task, draws the latest one, so frames posted faster than the task
+// runs are coalesced and the task's period caps the frame rate.
+//
+// In dashboard mode the display task shows a live status screen built from a
+// Dashboard snapshot every dashboard interval; a message interrupts it for
+// MESSAGE_HOLD_MS.
 class DisplayManager 
 {
 public:
-    DisplayManager(int width, int height, int resetPin = -1);
+    enum Mode : uint8_t {
+        MODE_MESSAGES,   // Last message stays up
+        MODE_DASHBOARD
+    };
+    static const uint32_t DEFAULT_I2C_CLOCK = 400000;
+    static const uint32_t IDLE_I2C_CLOCK = 100000;  // Bus speed between transfers, for other devices
+    static const uint8_t MAX_LINES = 7;             // 10-pixel rows on 64 pixels
+    static const size_t MAX_LINE_LENGTH = 63;       // Longer lines are cut; 21 characters fit a row
+    static const uint32_t MESSAGE_HOLD_MS = 3000;
+    static const uint32_t MIN_DASHBOARD_INTERVAL_MS = 50;   // The display task's period
+    static const uint32_t MAX_DASHBOARD_INTERVAL_MS = 10000;
+
+    // Taken from published state (MotionStatus, the switch mask), never by
+    // asking the drivers
+    struct Dashboard {
+        int32_t position;
+        int32_t target;
+        float speed;
+        bool running;
+        uint32_t switchesUsed;     // Bit n = switch handle n
+        uint32_t switchesClosed;
+        bool wifiConnected;
+        int8_t rssi;
+        uint32_t freeHeap;
+    };
+
+    struct Stats {
+        uint32_t requested;   // displayText()/displayLines() calls
+        uint32_t rendered;    // Frames drawn
+        uint32_t unchanged;   // Frames skipped because the same text was on screen
+        uint32_t transfers;   // Frames that changed pixels and went out over I2C
+        uint32_t bytes;       // I2C bytes sent
+        uint64_t i2cUs;       // Time spent in I2C transfers
+        uint32_t maxI2cUs;
+        uint32_t dashboards;  // Dashboard snapshots posted
+        uint64_t renderUs;    // Time spent drawing, I2C included
+    };
+
+    DisplayManager(int width, int height, int resetPin = -1, uint32_t i2cClock = DEFAULT_I2C_CLOCK);
     bool init(uint8_t i2cAddress = 0x3C);
     bool isInitialized() const { return _initialized; }
     void clear();
-    void display();
+    void display();  // Transfers what changed since the last transfer
     
     void displayText(const char* text, int line = 0);
     void displayLines(const std::vector<String>& lines);
     void displayMemoryInfo();
 
+    void startAsync() { _async = true; }  // Call before the display task starts calling render()
+    bool render();  // Draws the latest posted frame; false when none was pending
+
+    void setMode(Mode mode);
+    Mode getMode() const { return _mode; }
+    void setDashboardInterval(uint32_t ms);  // Clamped to [MIN, MAX]_DASHBOARD_INTERVAL_MS
+    uint32_t getDashboardInterval() const { return _dashboardIntervalMs; }
+    bool dashboardDue() const;  // A new snapshot would be shown now
+    void postDashboard(const Dashboard& dashboard);
+    static const char* modeName(Mode mode);
+    static int parseMode(const char* name);  // -1 when unknown
+
+    Stats getStats() const;
+    String getStatsJson() const;
+
+    // I2C clock during transfers: 400 kHz is the SSD1306 rating, most modules
+    // also run at 1 MHz
+    void setI2cClock(uint32_t hz) { _i2cClock = hz; }
+    uint32_t getI2cClock() const { return _i2cClock; }
+
 private:
+    static const int MAX_PAGES = 8;
+
+    struct TextFrame {
+        uint8_t count;
+        char lines[MAX_LINES][MAX_LINE_LENGTH + 1];
+    };
+
     Adafruit_SSD1306 _display;
+    TwoWire* _wire = &Wire;
+    uint8_t _address = 0x3C;
+    uint32_t _i2cClock;
     bool _initialized = false;
+    SemaphoreHandle_t _lock = nullptr;  // Serializes drawing from different tasks
+    TextFrame _text;              // Text last drawn
+    bool _textValid = false;      // False once something else was drawn
+    std::vector<uint8_t> _shown;  // Framebuffer as the panel has it
+
+    volatile bool _async = false;
+    mutable portMUX_TYPE _frameLock = portMUX_INITIALIZER_UNLOCKED;  // Guards _posted and _stats
+    TextFrame _posted;
+    bool _postedValid = false;
+    Stats _stats = {};
+
+    volatile Mode _mode = MODE_MESSAGES;
+    volatile uint32_t _dashboardIntervalMs = 250;
+    unsigned long _lastDashboardMs = 0;
+    volatile bool _dashboardNow = false;
+    volatile unsigned long _lastMessageMs = 0;
+    bool _messageShown = false;  // Ever, so the hold applies only after one
+    TextFrame _message;          // Last message, shown again when the dashboard is turned off
+
     void _setupDisplay();
     void _setupTextDisplay();
+    void _show(const TextFrame& frame);
+    void _post(const TextFrame& frame);
+    void _draw(const TextFrame& frame);
+    void _flush();
+    size_t _sendWindow(int firstPage, int lastPage, int firstColumn, int lastColumn);
 };
 
 #endif // DISPLAY_MANAGER_H 
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "edge_log.h"
+#include <esp_timer.h>
+
+void IRAM_ATTR EdgeLog::record(uint8_t pin, bool level, bool active, int32_t position) {
+    int64_t now = esp_timer_get_time();
+    uint8_t flags = (level ? FLAG_LEVEL : 0) | (active ? FLAG_ACTIVE : 0);
+    portENTER_CRITICAL_ISR(&_lock);
+    _entries[_next % CAPACITY] = {now, position, pin, flags};
+    _next++;
+    portEXIT_CRITICAL_ISR(&_lock);
+}
+
+uint32_t EdgeLog::oldestFrom(uint32_t since) const {
+    uint32_t oldest = _next > CAPACITY ? _next - CAPACITY : 0;
+    return since < oldest ? oldest : (since > _next ? _next : since);
+}
+
+size_t EdgeLog::encode(uint32_t since, uint8_t* out, size_t size) const {
+    if (size < sizeof(Header)) return 0;
+    size_t room = (size - sizeof(Header)) / sizeof(Record);
+    Header header = {{'E', 'D', 'G', 'L'}, VERSION, sizeof(Record), 0, 0, 0, 0};
+    uint8_t* p = out + sizeof(header);
+
+    // At most CAPACITY short copies with the interrupts held off
+    portENTER_CRITICAL(&_lock);
+    uint32_t first = oldestFrom(since);
+    uint32_t count = _next - first;
+    if (count > room) count = room;
+    header.firstSequence = first;
+    header.nextSequence = first + count;
+    header.count = count;
+    int64_t previous = count ? _entries[first % CAPACITY].timeUs : 0;
+    header.firstTimeUs = previous;
+    for (uint32_t seq = first; seq < first + count; seq++) {
+        const Entry& entry = _entries[seq % CAPACITY];
+        int64_t delta = entry.timeUs - previous;
+        previous = entry.timeUs;
+        Record record = {delta > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)delta, entry.position, entry.pin, entry.flags};
+        memcpy(p, &record, sizeof(record));
+        p += sizeof(record);
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    memcpy(out, &header, sizeof(header));
+    return p - out;
+}
+
+size_t EdgeLog::read(uint32_t since, Entry* out, size_t max, uint32_t* firstSequence) const {
+    portENTER_CRITICAL(&_lock);
+    uint32_t first = oldestFrom(since);
+    size_t count = _next - first;
+    if (count > max) count = max;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = _entries[(first + i) % CAPACITY];
+    }
+    portEXIT_CRITICAL(&_lock);
+    if (firstSequence) *firstSequence = first;
+    return count;
+}
+
+uint32_t EdgeLog::nextSequence() const {
+    portENTER_CRITICAL(&_lock);
+    uint32_t next = _next;
+    portEXIT_CRITICAL(&_lock);
+    return next;
+}
+
+void EdgeLog::clear() {
+    portENTER_CRITICAL(&_lock);
+    _next = 0;
+    portEXIT_CRITICAL(&_lock);
+}
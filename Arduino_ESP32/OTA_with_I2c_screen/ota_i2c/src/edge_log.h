@@ -0,0 +1,74 @@
+#ifndef EDGE_LOG_H
+#define EDGE_LOG_H
+
+#include <Arduino.h>
+
+// Every input edge as the switch interrupts saw it: esp_timer time in
+// microseconds, the raw pin level and the motor position at that instant,
+// bounce included. A ring of the last CAPACITY edges; each edge gets a
+// sequence number so a client can fetch only what is new.
+//
+// encode() writes the download format (little endian, packed):
+//   Header   char magic[4] "EDGL", uint8 version, uint8 recordSize,
+//            uint16 count, uint32 firstSequence, uint32 nextSequence,
+//            int64 firstTimeUs
+//   Record   uint32 deltaUs (since the previous record, 0 for the first;
+//            saturates at 0xFFFFFFFF), int32 position, uint8 pin, uint8 flags
+// firstSequence above the requested one means older edges were overwritten.
+//
+// record() is called from the GPIO interrupt; the rest from any task.
+class EdgeLog
+{
+public:
+    static const size_t CAPACITY = 256;
+    static const uint8_t VERSION = 1;
+
+    // Entry::flags
+    static const uint8_t FLAG_LEVEL = 0x01;     // Pin read high
+    static const uint8_t FLAG_ACTIVE = 0x02;    // Switch closed (after polarity)
+
+    struct Entry {
+        int64_t timeUs;
+        int32_t position;
+        uint8_t pin;
+        uint8_t flags;
+    };
+
+    struct __attribute__((packed)) Header {
+        char magic[4];
+        uint8_t version;
+        uint8_t recordSize;
+        uint16_t count;
+        uint32_t firstSequence;
+        uint32_t nextSequence;
+        int64_t firstTimeUs;
+    };
+
+    struct __attribute__((packed)) Record {
+        uint32_t deltaUs;
+        int32_t position;
+        uint8_t pin;
+        uint8_t flags;
+    };
+
+    static const size_t MAX_ENCODED_SIZE = sizeof(Header) + CAPACITY * sizeof(Record);
+
+    void IRAM_ATTR record(uint8_t pin, bool level, bool active, int32_t position);
+
+    // Edges from sequence since onwards (or the oldest still kept); returns the bytes written
+    size_t encode(uint32_t since, uint8_t* out, size_t size) const;
+    // Copies up to max edges from sequence since onwards; returns how many
+    size_t read(uint32_t since, Entry* out, size_t max, uint32_t* firstSequence = nullptr) const;
+
+    uint32_t nextSequence() const;  // Edges recorded so far
+    void clear();
+
+private:
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    Entry _entries[CAPACITY];
+    uint32_t _next = 0;
+
+    uint32_t oldestFrom(uint32_t since) const;  // Call with _lock held
+};
+
+#endif // EDGE_LOG_H
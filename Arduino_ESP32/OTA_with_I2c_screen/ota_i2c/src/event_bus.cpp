@@ -0,0 +1,128 @@
+#include "event_bus.h"
+#include <ArduinoJson.h>
+
+static_assert((EventBus::CAPACITY & (EventBus::CAPACITY - 1)) == 0, "EventBus capacity must be a power of two");
+static_assert(EventBus::TYPE_COUNT <= 32, "Event types are filtered through a 32-bit mask");
+
+static const char* const TYPE_NAMES[EventBus::TYPE_COUNT] = {
+    "input", "limitHit", "motionStarted", "motionStopped", "homing", "ota", "wifi"
+};
+
+EventBus& EventBus::instance() {
+    static EventBus bus;
+    return bus;
+}
+
+const char* EventBus::typeName(Type type) {
+    return type < TYPE_COUNT ? TYPE_NAMES[type] : "unknown";
+}
+
+void IRAM_ATTR EventBus::publish(Type type, uint8_t source, int32_t value, const char* name) {
+    uint32_t ticket = _head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = _slots[ticket & (CAPACITY - 1)];
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = {type, source, value, (uint32_t)micros(), name};
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+}
+
+EventBus::SubscriberId EventBus::subscribe(const char* name, uint32_t mask, Handler handler) {
+    for (SubscriberId id = 0; id < (SubscriberId)MAX_SUBSCRIBERS; id++) {
+        Subscriber& sub = _subscribers[id];
+        if (sub.active) continue;
+        sub.name = name;
+        sub.mask.store(mask, std::memory_order_relaxed);
+        sub.handler = handler;
+        sub.cursor = _head.load(std::memory_order_acquire);
+        sub.stats = Stats();
+        sub.active = true;
+        return id;
+    }
+    Serial.printf("EventBus: no room for subscriber %s\n", name);
+    return -1;
+}
+
+void EventBus::unsubscribe(SubscriberId id) {
+    if (id < 0 || id >= (SubscriberId)MAX_SUBSCRIBERS) return;
+    _subscribers[id].active = false;
+    _subscribers[id].handler = nullptr;
+}
+
+void EventBus::setFilter(SubscriberId id, uint32_t mask) {
+    if (id < 0 || id >= (SubscriberId)MAX_SUBSCRIBERS) return;
+    _subscribers[id].mask.store(mask, std::memory_order_relaxed);
+}
+
+size_t EventBus::dispatch(SubscriberId id, size_t max) {
+    if (id < 0 || id >= (SubscriberId)MAX_SUBSCRIBERS || !_subscribers[id].active) return 0;
+    Subscriber& sub = _subscribers[id];
+    uint32_t mask = sub.mask.load(std::memory_order_relaxed);
+    size_t read = 0;
+
+    while (read < max) {
+        uint32_t head = _head.load(std::memory_order_acquire);
+        if (sub.cursor == head) break;
+        const Slot& slot = _slots[sub.cursor & (CAPACITY - 1)];
+        uint32_t expected = 2 * sub.cursor + 2;
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        int32_t age = (int32_t)(before - expected);
+        if (age < 0) break;  // Claimed but still being written (the publisher was preempted)
+
+        if (age == 0) {
+            Event event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                sub.cursor++;
+                read++;
+                if (mask & (1u << event.type)) {
+                    sub.handler(event);
+                    uint32_t latency = (uint32_t)micros() - event.timeUs;
+                    sub.stats.delivered++;
+                    sub.stats.totalLatencyUs += latency;
+                    if (latency > sub.stats.maxLatencyUs) sub.stats.maxLatencyUs = latency;
+                } else {
+                    sub.stats.filtered++;
+                }
+                continue;
+            }
+        }
+
+        // Lapped: skip to the oldest event still in the ring
+        uint32_t oldest = _head.load(std::memory_order_acquire) - CAPACITY;
+        if ((int32_t)(oldest - sub.cursor) > 0) {
+            sub.stats.dropped += oldest - sub.cursor;
+            sub.cursor = oldest;
+        } else {
+            sub.stats.dropped++;
+            sub.cursor++;
+        }
+    }
+    return read;
+}
+
+EventBus::Stats EventBus::getStats(SubscriberId id) const {
+    if (id < 0 || id >= (SubscriberId)MAX_SUBSCRIBERS) return Stats();
+    return _subscribers[id].stats;
+}
+
+String EventBus::getStatsJson() const {
+    DynamicJsonDocument doc(256 + MAX_SUBSCRIBERS * 224);
+    doc["published"] = published();
+    doc["capacity"] = CAPACITY;
+    JsonArray subscribers = doc.createNestedArray("subscribers");
+    for (const Subscriber& sub : _subscribers) {
+        if (!sub.active) continue;
+        Stats stats = sub.stats;
+        JsonObject entry = subscribers.createNestedObject();
+        entry["name"] = sub.name;
+        entry["mask"] = sub.mask.load(std::memory_order_relaxed);
+        entry["delivered"] = stats.delivered;
+        entry["filtered"] = stats.filtered;
+        entry["dropped"] = stats.dropped;
+        entry["latencyMaxUs"] = stats.maxLatencyUs;
+        entry["latencyAvgUs"] = stats.delivered ? (uint32_t)(stats.totalLatencyUs / stats.delivered) : 0;
+    }
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
@@ -0,0 +1,101 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+
+// Typed events from inputs, motion, homing, OTA and WiFi, fanned out to
+// several subscribers. publish() never blocks and never allocates, so it may
+// be called from any task or ISR: it claims a slot in one ring with an atomic
+// ticket and stamps the slot with a sequence number once the event is in.
+// Each subscriber has its own read cursor and filter and is dispatched from
+// its own task with dispatch(). Nothing waits for a slow subscriber: when the
+// ring laps it, the events it missed are counted as dropped.
+class EventBus
+{
+public:
+    enum Type : uint8_t {
+        INPUT_CHANGED,      // Debounced switch change: source pin, value 1 = active, name = switch ID
+        LIMIT_HIT,          // A switch interrupt stopped the motor: source pin, value = position
+        MOTION_STARTED,     // value = position
+        MOTION_STOPPED,     // value = position
+        HOMING_PHASE,       // value = HomingSequence::Phase, name = phase name
+        OTA_PROGRESS,       // source = OtaState, value = percent or error code
+        WIFI_STATE,         // value 1 = connected
+        TYPE_COUNT
+    };
+
+    enum OtaState : uint8_t {
+        OTA_START,
+        OTA_RUNNING,
+        OTA_END,
+        OTA_ERROR
+    };
+
+    struct Event {
+        Type type;
+        uint8_t source;
+        int32_t value;
+        uint32_t timeUs;        // micros() at publish
+        const char* name;       // Static string or nullptr
+    };
+
+    // Written only by the subscriber's own dispatch()
+    struct Stats {
+        uint32_t delivered;
+        uint32_t filtered;      // Read but not matching the filter
+        uint32_t dropped;       // Overwritten before this subscriber read them
+        uint32_t maxLatencyUs;  // Publish until the handler ran
+        uint64_t totalLatencyUs;
+    };
+
+    using Handler = std::function<void(const Event&)>;
+    typedef int8_t SubscriberId;
+
+    static const size_t CAPACITY = 128;
+    static const uint8_t MAX_SUBSCRIBERS = 8;
+    static const uint32_t ALL = 0xFFFFFFFF;
+    static uint32_t maskOf(Type type) { return 1u << type; }
+
+    static EventBus& instance();
+    EventBus() = default;
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    void IRAM_ATTR publish(Type type, uint8_t source, int32_t value, const char* name = nullptr);
+
+    // Only events published after subscribe() are seen. -1 when full.
+    SubscriberId subscribe(const char* name, uint32_t mask, Handler handler);
+    void unsubscribe(SubscriberId id);
+    void setFilter(SubscriberId id, uint32_t mask);
+
+    // Runs the handler for up to max pending events; returns how many were read
+    size_t dispatch(SubscriberId id, size_t max = CAPACITY);
+
+    uint32_t published() const { return _head.load(std::memory_order_relaxed); }
+    Stats getStats(SubscriberId id) const;
+    String getStatsJson() const;
+    static const char* typeName(Type type);
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq{0};   // 2 * ticket + 1 while written, 2 * ticket + 2 once complete
+        Event event;
+    };
+
+    struct Subscriber {
+        const char* name = nullptr;
+        std::atomic<uint32_t> mask{0};
+        Handler handler;
+        uint32_t cursor = 0;
+        bool active = false;
+        Stats stats = {};
+    };
+
+    Slot _slots[CAPACITY];
+    std::atomic<uint32_t> _head{0};
+    Subscriber _subscribers[MAX_SUBSCRIBERS];
+};
+
+#endif // EVENT_BUS_H
@@ -2,5 +2,10 @@
 
 // Define static members
 bool FlashController::_initialized = false;
+bool FlashController::_useStore = false;
+ConfigStore FlashController::_store;
+bool FlashController::_eepromDirty = false;
+uint32_t FlashController::_eepromChanged = 0;
+volatile uint32_t FlashController::_eepromGeneration = 0;
 FlashController::LogLevel FlashController::_logLevel = FlashController::LogLevel::INFO;
 const char* FlashController::_logPrefix = "FLASH"; 
\ No newline at end of file
@@ -4,26 +4,30 @@
 #include <Arduino.h>
 #include <EEPROM.h>
 #include <ArduinoJson.h>
+#include "config_store.h"
+#include "config_schema.h"
+#include "logger.h"
 
+// Settings are kept in a ConfigStore on the "config" partition: changes are
+// made in RAM and reach flash as one CRC-checked record once they have
+// settled (service(), from the ota task), instead of one commit of the whole
+// EEPROM image per value. Several values changed together go through a
+// Transaction. The first boot with the partition imports the EEPROM contents.
+// Without the partition (a board still on the old partition table, which OTA
+// cannot change) it falls back to EEPROM, committed by service() the same
+// way but without the all-or-nothing guarantee.
+//
+// The values form one ConfigSchema blob at the start of the image: init()
+// validates (or migrates) it in a single pass, get/set<Field> read and write
+// one section of it at the offset the schema derives, and every write
+// reseals the header.
 class FlashController {
 public:
-    // Memory layout constants
-    static const int TOTAL_FLASH_SIZE = 512;  // Total Flash size in bytes
-    
-    // Address ranges for different components
-    static const int PIN_CONFIG_START = 0;     // Pin configuration starts at 0
-    static const int PIN_CONFIG_SIZE = 32;     // Reserve 32 bytes for pin config
-    
-    // Pin configuration addresses
-    static const int LED_PIN_ADDR = PIN_CONFIG_START + PIN_CONFIG_SIZE;
-    static const int LED_PIN_SIZE = 1;
-    
-    static const int STEPPER_STEP_PIN_ADDR = LED_PIN_ADDR + LED_PIN_SIZE;
-    static const int STEPPER_DIR_PIN_ADDR = STEPPER_STEP_PIN_ADDR + 1;
-    static const int STEPPER_ENABLE_PIN_ADDR = STEPPER_DIR_PIN_ADDR + 1;
-    static const int DISPLAY_SDA_PIN_ADDR = STEPPER_ENABLE_PIN_ADDR + 1;
-    static const int DISPLAY_SCL_PIN_ADDR = DISPLAY_SDA_PIN_ADDR + 1;
-    static const int DISPLAY_RESET_PIN_ADDR = DISPLAY_SCL_PIN_ADDR + 1;
+    static const int TOTAL_FLASH_SIZE = ConfigStore::IMAGE_SIZE;  // Image size in bytes; the settings blob is at 0
+
+    typedef ConfigSchema::PinConfig PinConfig;
+
+    static constexpr const char* CONFIG_PARTITION = "config";
 
     // Debug logging levels
     enum class LogLevel {
@@ -36,18 +40,49 @@ public:
 
 private:
     static bool _initialized;
+    static bool _useStore;
+    static ConfigStore _store;
+    static bool _eepromDirty;          // EEPROM fallback: uncommitted changes since
+    static uint32_t _eepromChanged;    // this millis()
+    static volatile uint32_t _eepromGeneration;
     static LogLevel _logLevel;
     static const char* _logPrefix;
 
-    static void log(LogLevel level, const char* format, ...) {
-        if (level <= _logLevel) {
-            char buffer[256];
-            va_list args;
-            va_start(args, format);
-            vsnprintf(buffer, sizeof(buffer), format, args);
-            va_end(args);
-            Serial.printf("[%s] %s\n", _logPrefix, buffer);
+    // Levels above LOG_LEVEL compile to nothing; the rest go through the Logger ring
+    template<typename... Args>
+    static void log(LogLevel level, const char* format, Args... args) {
+        if ((int)level <= LOG_LEVEL && level <= _logLevel) {
+            Logger::write((Logger::Level)level, _logPrefix, format, args...);
+        }
+    }
+
+    static bool readBytes(int address, void* data, size_t length) {
+        if (_useStore) return _store.read(address, data, length);
+        for (size_t i = 0; i < length; i++) {
+            ((uint8_t*)data)[i] = EEPROM.read(address + i);
+        }
+        return true;
+    }
+
+    static bool writeBytes(int address, const void* data, size_t length) {
+        if (_useStore) return _store.write(address, data, length);
+        for (size_t i = 0; i < length; i++) {
+            EEPROM.write(address + i, ((const uint8_t*)data)[i]);
+        }
+        _eepromDirty = true;
+        _eepromChanged = millis();
+        _eepromGeneration++;
+        return true;
+    }
+
+    static bool commitEeprom() {
+        _eepromDirty = false;
+        if (!EEPROM.commit()) {
+            log(LogLevel::ERROR, "EEPROM commit failed");
+            return false;
         }
+        log(LogLevel::DEBUG, "Flash changes committed");
+        return true;
     }
 
 public:
@@ -58,30 +93,164 @@ public:
     static bool init() {
         if (!_initialized) {
             log(LogLevel::INFO, "Initializing Flash controller");
-            EEPROM.begin(TOTAL_FLASH_SIZE);
+            uint8_t image[TOTAL_FLASH_SIZE];
+            _useStore = _store.begin(CONFIG_PARTITION);
+            if (!_useStore) {
+                log(LogLevel::WARN, "No config partition, using EEPROM; flash over serial to update the partition table");
+                EEPROM.begin(TOTAL_FLASH_SIZE);
+            } else if (_store.formatted()) {
+                // First boot with the store: carry the EEPROM settings over
+                EEPROM.begin(TOTAL_FLASH_SIZE);
+                for (int i = 0; i < TOTAL_FLASH_SIZE; i++) {
+                    image[i] = EEPROM.read(i);
+                }
+                EEPROM.end();
+                bool imported = _store.write(0, image, sizeof(image)) && _store.flush();
+                log(LogLevel::INFO, "Importing EEPROM settings: %s", imported ? "ok" : "failed");
+            }
             _initialized = true;
+
+            // One read and one CRC over the blob; anything but a current one is rewritten
+            ConfigSchema::Layout layout;
+            ConfigSchema::Result result = ConfigSchema::DEFAULTED;
+            if (readBytes(0, image, sizeof(image))) {
+                result = ConfigSchema::load(image, sizeof(image), layout);
+            } else {
+                layout = ConfigSchema::defaults();
+            }
+            if (result != ConfigSchema::VALID) {
+                if (!writeBytes(0, &layout, sizeof(layout)) || !flush()) {
+                    log(LogLevel::ERROR, "Cannot store the settings");
+                }
+            }
+            log(LogLevel::INFO, "Settings %s (schema version %u, %u bytes)", ConfigSchema::resultName(result),
+                (unsigned)ConfigSchema::VERSION, (unsigned)sizeof(layout));
         }
         return _initialized;
     }
 
-    static void commit() {
-        if (_initialized) {
-            EEPROM.commit();
-            log(LogLevel::DEBUG, "Flash changes committed");
+    // Writes settled changes to flash; call periodically from one low-priority
+    // task, never from a web handler (async_tcp) or the motion tasks
+    static bool service() {
+        if (!_initialized) return false;
+        if (_useStore) return _store.service();
+        if (_eepromDirty && millis() - _eepromChanged >= ConfigStore::QUIET_MS) return commitEeprom();
+        return true;
+    }
+
+    // Writes pending changes now, e.g. before a restart
+    static bool flush() {
+        if (!_initialized) return false;
+        if (_useStore) return _store.flush();
+        return !_eepromDirty || commitEeprom();
+    }
+
+    // For callers that must not write flash themselves: the next service() flushes
+    static void requestFlush() {
+        if (_useStore) {
+            _store.requestFlush();
+        } else {
+            _eepromChanged = millis() - ConfigStore::QUIET_MS;
+        }
+    }
+
+    static const ConfigStore& store() { return _store; }
+
+    // Changes whenever a stored value does; caches compare it to know they are current
+    static uint32_t generation() {
+        return _useStore ? _store.generation() : _eepromGeneration;
+    }
+
+    static String getStatsJson() {
+        StaticJsonDocument<512> doc;
+        doc["backend"] = _useStore ? "log" : "eeprom";
+        if (_useStore) {
+            ConfigStore::Stats stats = _store.getStats();
+            doc["commits"] = stats.commits;
+            doc["unchanged"] = stats.unchanged;
+            doc["pending"] = stats.pending;
+            doc["flushes"] = stats.flushes;
+            doc["failures"] = stats.failures;
+            doc["records"] = stats.records;
+            doc["compactions"] = stats.compactions;
+            doc["lastFlushUs"] = stats.lastFlushUs;
+            doc["maxFlushUs"] = stats.maxFlushUs;
+            doc["avgFlushUs"] = stats.flushes ? (uint32_t)(stats.totalFlushUs / stats.flushes) : 0;
+            doc["sector"] = stats.sector;
+            doc["sequence"] = stats.sequence;
+            doc["sectorUsed"] = stats.used;
+        } else {
+            doc["pending"] = _eepromDirty;
         }
+        String json;
+        serializeJson(doc, json);
+        return json;
+    }
+
+    // Values written together: visible, and flushed, as one unit. Stages
+    // into a copy of the blob and reseals it on commit. Do not call set()
+    // or another Transaction while one is open.
+    class Transaction {
+    public:
+        Transaction() : _transaction(_store), _ok(readBytes(0, &_blob, sizeof(_blob))) {}
+
+        template<typename Field>
+        void stage(const typename Field::Type& value) {
+            memcpy((uint8_t*)&_blob + Field::OFFSET, &value, Field::SIZE);
+        }
+
+        bool commit() {
+            if (!_initialized || !_ok) return false;
+            ConfigSchema::seal(_blob);
+            if (_useStore) return _transaction.stage(0, _blob) && _transaction.commit();
+            bool changed = false;
+            for (size_t i = 0; i < sizeof(_blob); i++) {
+                uint8_t value = ((const uint8_t*)&_blob)[i];
+                if (EEPROM.read(i) != value) {
+                    EEPROM.write(i, value);
+                    changed = true;
+                }
+            }
+            if (changed) {
+                _eepromDirty = true;
+                _eepromChanged = millis();
+                _eepromGeneration++;
+            }
+            return true;
+        }
+
+    private:
+        ConfigStore::Transaction _transaction;
+        bool _ok;
+        ConfigSchema::Layout _blob;
+    };
+
+    // One schema field, e.g. get<ConfigSchema::Homing>(section)
+    template<typename Field>
+    static bool get(typename Field::Type& value) {
+        if (!_initialized) return false;
+        return readBytes(Field::OFFSET, &value, Field::SIZE);
+    }
+
+    template<typename Field>
+    static bool set(const typename Field::Type& value) {
+        if (!_initialized) return false;
+        Transaction transaction;
+        transaction.stage<Field>(value);
+        return transaction.commit();
     }
 
     // LED pin methods
     static int8_t readLedPin() {
         if (!_initialized) return -1;
         
-        int8_t pin = EEPROM.read(LED_PIN_ADDR);
+        int8_t pin = -1;
+        get<ConfigSchema::LedPin>(pin);
         log(LogLevel::DEBUG, "Read LED pin from Flash: %d", pin);
         
         if (pin <= 0 || pin >= 40) {
             log(LogLevel::WARN, "Invalid LED pin %d, using default", pin);
-            pin = 1;  // Default LED pin
-            writeLedPin(pin);
+            pin = 1;  // Default LED pin; stored only when someone saves one
         }
         return pin;
     }
@@ -91,44 +260,19 @@ public:
         
         if (pin > 0 && pin < 40) {
             log(LogLevel::DEBUG, "Writing LED pin to Flash: %d", pin);
-            EEPROM.write(LED_PIN_ADDR, pin);
-            commit();
-            return true;
+            return set<ConfigSchema::LedPin>(pin);
         }
         log(LogLevel::ERROR, "Invalid LED pin value: %d", pin);
         return false;
     }
 
     // PinManager specific methods
-    struct PinConfig {
-        int8_t stepperStepPin;
-        int8_t stepperDirPin;
-        int8_t stepperEnablePin;
-        int8_t displaySdaPin;
-        int8_t displaySclPin;
-        int8_t displayResetPin;
-        int8_t ledPin;
-
-        void print() const {
-            Serial.printf("PinConfig: stepperStep=%d, stepperDir=%d, stepperEnable=%d, "
-                        "displaySda=%d, displayScl=%d, displayReset=%d, led=%d\n",
-                        stepperStepPin, stepperDirPin, stepperEnablePin,
-                        displaySdaPin, displaySclPin, displayResetPin, ledPin);
-        }
-    };
-
     static bool readPinConfig(PinConfig& config) {
         if (!_initialized) return false;
         
         log(LogLevel::DEBUG, "Reading pin configuration");
         
-        config.stepperStepPin = EEPROM.read(STEPPER_STEP_PIN_ADDR);
-        config.stepperDirPin = EEPROM.read(STEPPER_DIR_PIN_ADDR);
-        config.stepperEnablePin = EEPROM.read(STEPPER_ENABLE_PIN_ADDR);
-        config.displaySdaPin = EEPROM.read(DISPLAY_SDA_PIN_ADDR);
-        config.displaySclPin = EEPROM.read(DISPLAY_SCL_PIN_ADDR);
-        config.displayResetPin = EEPROM.read(DISPLAY_RESET_PIN_ADDR);
-        config.ledPin = EEPROM.read(LED_PIN_ADDR);
+        if (!get<ConfigSchema::Pins>(config)) return false;
 
         log(LogLevel::DEBUG, "Pin config read: stepperStep=%d, stepperDir=%d, stepperEnable=%d, "
             "displaySda=%d, displayScl=%d, displayReset=%d, led=%d",
@@ -143,15 +287,7 @@ public:
         
         log(LogLevel::DEBUG, "Writing pin configuration");
         
-        EEPROM.write(STEPPER_STEP_PIN_ADDR, config.stepperStepPin);
-        EEPROM.write(STEPPER_DIR_PIN_ADDR, config.stepperDirPin);
-        EEPROM.write(STEPPER_ENABLE_PIN_ADDR, config.stepperEnablePin);
-        EEPROM.write(DISPLAY_SDA_PIN_ADDR, config.displaySdaPin);
-        EEPROM.write(DISPLAY_SCL_PIN_ADDR, config.displaySclPin);
-        EEPROM.write(DISPLAY_RESET_PIN_ADDR, config.displayResetPin);
-        EEPROM.write(LED_PIN_ADDR, config.ledPin);
-        
-        commit();
+        if (!set<ConfigSchema::Pins>(config)) return false;
         
         log(LogLevel::DEBUG, "Pin config written: stepperStep=%d, stepperDir=%d, stepperEnable=%d, "
             "displaySda=%d, displayScl=%d, displayReset=%d, led=%d",
@@ -160,36 +296,8 @@ public:
         
         return true;
     }
-
-    // Generic read/write methods
-    template<typename T>
-    static bool read(int address, T& value) {
-        if (!_initialized) return false;
-        if (address < 0 || address + sizeof(T) > TOTAL_FLASH_SIZE) {
-            log(LogLevel::ERROR, "Invalid address range for read: %d, size: %d", 
-                address, sizeof(T));
-            return false;
-        }
-        
-        EEPROM.get(address, value);
-        log(LogLevel::DEBUG, "Read value at address %d", address);
-        return true;
-    }
-
-    template<typename T>
-    static bool write(int address, const T& value) {
-        if (!_initialized) return false;
-        if (address < 0 || address + sizeof(T) > TOTAL_FLASH_SIZE) {
-            log(LogLevel::ERROR, "Invalid address range for write: %d, size: %d", 
-                address, sizeof(T));
-            return false;
-        }
-        
-        EEPROM.put(address, value);
-        commit();
-        log(LogLevel::DEBUG, "Wrote value at address %d", address);
-        return true;
-    }
 };
 
+static_assert(sizeof(ConfigSchema::Layout) <= ConfigStore::IMAGE_SIZE, "Settings blob larger than the image");
+
 #endif // FLASH_CONTROLLER_H 
\ No newline at end of file
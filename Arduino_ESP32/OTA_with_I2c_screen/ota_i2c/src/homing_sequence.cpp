@@ -0,0 +1,270 @@
+#include "homing_sequence.h"
+#include "event_bus.h"
+#include "flash_controller.h"
+#include "logger.h"
+#include "position_memory.h"
+
+const char* const HomingSequence::HOME_SWITCH_ID = "HOME_SWITCH";
+const char* const HomingSequence::END_SWITCH_ID = "END_SWITCH";
+
+static const char* const PHASE_NAMES[HomingSequence::PHASE_COUNT] = {
+    "idle", "fastApproach", "backOff", "slowApproach", "measureTravel", "return", "done", "failed"
+};
+
+HomingSequence::HomingSequence(MotionController& motion, ControlSignalHandler& signals)
+    : _motion(motion), _signals(signals), _requested(defaults()), _settings(defaults()) {
+    _status = {};
+    _status.phase = IDLE;
+    _published = _status;
+}
+
+HomingSequence::Settings HomingSequence::defaults() {
+    // fastSpeed, slowSpeed, backOffSteps, margin, maxTravel, measureTravel
+    return {3200, 400, 400, 50, 200000, true};
+}
+
+const char* HomingSequence::phaseName(Phase phase) {
+    return phase < PHASE_COUNT ? PHASE_NAMES[phase] : "unknown";
+}
+
+bool HomingSequence::begin() {
+    ConfigSchema::HomingSection section;
+    if (FlashController::get<ConfigSchema::Homing>(section) && section.travel > 0) {
+        _storedTravel = section.travel;
+        _status.travel = section.travel;
+        publish();
+        LOG_INFO("Homing: stored travel %ld steps", (long)section.travel);
+    }
+    // StepperManager::init() already put the motor back where it stood
+    PositionMemory::Snapshot snapshot;
+    if (PositionMemory::restored(snapshot) != PositionMemory::NONE &&
+        (snapshot.flags & PositionMemory::Snapshot::HOMED)) {
+        _status.homed = true;
+        publish();
+        LOG_INFO("Homing: still homed from before the reset");
+    }
+    return _storedTravel > 0;
+}
+
+bool HomingSequence::start(const Settings& settings) {
+    if (settings.fastSpeed <= 0 || settings.slowSpeed <= 0 || settings.backOffSteps <= 0 ||
+        settings.margin < 0 || settings.maxTravel <= 0) {
+        LOG_WARN("Homing: invalid settings");
+        return false;
+    }
+    portENTER_CRITICAL(&_lock);
+    bool busy = _startRequested || (_published.phase > IDLE && _published.phase < DONE);
+    if (!busy) {
+        _requested = settings;
+        _startRequested = true;
+    }
+    portEXIT_CRITICAL(&_lock);
+    return !busy;
+}
+
+void HomingSequence::abort() {
+    portENTER_CRITICAL(&_lock);
+    _abortRequested = true;
+    portEXIT_CRITICAL(&_lock);
+}
+
+HomingSequence::Status HomingSequence::status() const {
+    portENTER_CRITICAL(&_lock);
+    Status copy = _published;
+    portEXIT_CRITICAL(&_lock);
+    return copy;
+}
+
+void HomingSequence::publish() {
+    portENTER_CRITICAL(&_lock);
+    _published = _status;
+    portEXIT_CRITICAL(&_lock);
+}
+
+bool HomingSequence::post(MotionCommand::Type type, int32_t value, float real, int32_t value2) {
+    MotionCommand command = {type, value, real, 0.0f, value2};
+    return _motion.post(MotionController::PRODUCER_LOCAL, command);
+}
+
+void HomingSequence::update() {
+    portENTER_CRITICAL(&_lock);
+    bool startRequested = _startRequested;
+    bool abortRequested = _abortRequested;
+    Settings requested = _requested;
+    _startRequested = false;
+    _abortRequested = false;
+    portEXIT_CRITICAL(&_lock);
+
+    bool running = _status.phase > IDLE && _status.phase < DONE;
+    if (abortRequested && running) {
+        post(MotionCommand::STOP);
+        fail("Aborted");
+        return;
+    }
+    if (startRequested && !running) {
+        _settings = requested;
+        _startMs = millis();
+        _status.homed = false;
+        PositionMemory::setHomed(false);
+        _status.error = nullptr;
+        _status.elapsedMs = 0;
+        memset(_status.phaseMs, 0, sizeof(_status.phaseMs));
+        _status.phase = IDLE;
+        _home = _signals.findLimitSwitch(HOME_SWITCH_ID);
+        _end = _signals.findLimitSwitch(END_SWITCH_ID);
+        if (_home == ControlSignalHandler::INVALID_SWITCH ||
+            (_end == ControlSignalHandler::INVALID_SWITCH && (_settings.measureTravel || _storedTravel <= 0))) {
+            fail("Switch not configured");
+            return;
+        }
+        // Old limits are meaningless until the new reference is taken
+        if (!post(MotionCommand::SET_SOFT_LIMITS, 0, 0.0f, 0)) {
+            fail("Motion queue full");
+            return;
+        }
+        enter(_signals.isLimitSwitchTriggered(_home) ? BACK_OFF : FAST_APPROACH);
+        return;
+    }
+    if (!running) return;
+
+    MotionStatus motion = _motion.status();
+    int32_t moved = motion.position - _phaseStartPosition;
+    bool lost = (moved < 0 ? -moved : moved) > _settings.maxTravel;
+    bool atRest = !motion.running && settled();
+
+    switch (_status.phase) {
+        case FAST_APPROACH:
+        case SLOW_APPROACH: {
+            LimitSwitch::Edge edge = _signals.getLastEdge(_home);
+            if (edge.count != _edgeCount && atRest) {
+                if (_status.phase == FAST_APPROACH) {
+                    enter(BACK_OFF);
+                    break;
+                }
+                // The interrupt caught the closing edge; make it position 0
+                int32_t position = motion.position - edge.position;
+                if (!post(MotionCommand::SET_POSITION, position)) {
+                    fail("Motion queue full");
+                    break;
+                }
+                if (_settings.measureTravel || _storedTravel <= 0) {
+                    enter(MEASURE_TRAVEL);
+                } else {
+                    _status.travel = _storedTravel;
+                    enter(RETURN);
+                }
+                // MotionStatus still shows the old frame
+                _phaseStartPosition = position;
+            } else if (lost) {
+                post(MotionCommand::STOP);
+                fail("HOME_SWITCH not found");
+            } else if (atRest) {
+                fail("Motor stopped before HOME_SWITCH");
+            }
+            break;
+        }
+        case BACK_OFF:
+            if (!atRest) break;
+            if (!_signals.isLimitSwitchTriggered(_home)) {
+                enter(SLOW_APPROACH);
+            } else if (millis() - _phaseStartMs > RELEASE_TIMEOUT_MS) {
+                fail("HOME_SWITCH did not release");
+            }
+            break;
+        case MEASURE_TRAVEL: {
+            LimitSwitch::Edge edge = _signals.getLastEdge(_end);
+            if (edge.count != _edgeCount && atRest) {
+                if (edge.position <= 2 * _settings.margin) {
+                    fail("Travel shorter than the margins");
+                    break;
+                }
+                _status.travel = edge.position;
+                saveTravel(edge.position);
+                enter(RETURN);
+            } else if (lost) {
+                post(MotionCommand::STOP);
+                fail("END_SWITCH not found");
+            } else if (atRest) {
+                fail("Motor stopped before END_SWITCH");
+            }
+            break;
+        }
+        case RETURN:
+            if (atRest) {
+                _status.homed = true;
+                PositionMemory::setHomed(true);
+                enter(DONE);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (_status.phase > IDLE && _status.phase < DONE) {
+        _status.elapsedMs = millis() - _startMs;
+        publish();
+    }
+}
+
+void HomingSequence::enter(Phase phase) {
+    unsigned long now = millis();
+    if (_status.phase > IDLE && _status.phase < DONE) {
+        _status.phaseMs[_status.phase] += now - _phaseStartMs;
+    }
+    _status.phase = phase;
+    _status.sequence++;
+    _phaseStartMs = now;
+    _phaseStartPosition = _motion.status().position;
+
+    bool queued = true;
+    switch (phase) {
+        case FAST_APPROACH:
+            _edgeCount = _signals.getLastEdge(_home).count;
+            queued = post(MotionCommand::SEEK, -1, _settings.fastSpeed);
+            break;
+        case BACK_OFF:
+            queued = post(MotionCommand::MOVE_BY, _settings.backOffSteps);
+            break;
+        case SLOW_APPROACH:
+            _edgeCount = _signals.getLastEdge(_home).count;
+            queued = post(MotionCommand::SEEK, -1, _settings.slowSpeed);
+            break;
+        case MEASURE_TRAVEL:
+            _edgeCount = _signals.getLastEdge(_end).count;
+            queued = post(MotionCommand::SEEK, 1, _settings.fastSpeed);
+            break;
+        case RETURN:
+            queued = post(MotionCommand::SET_SOFT_LIMITS, _settings.margin, 0.0f, _status.travel - _settings.margin) &&
+                     post(MotionCommand::MOVE_TO, _settings.margin);
+            break;
+        case DONE:
+        case FAILED:
+            _status.elapsedMs = now - _startMs;
+            if (phase == DONE) {
+                LOG_INFO("Homing done in %lu ms: travel %ld steps", (unsigned long)_status.elapsedMs,
+                         (long)_status.travel);
+            }
+            break;
+        default:
+            break;
+    }
+    publish();
+    EventBus::instance().publish(EventBus::HOMING_PHASE, 0, phase, phaseName(phase));
+    if (!queued) {
+        fail("Motion queue full");
+    }
+}
+
+void HomingSequence::fail(const char* error) {
+    _status.error = error;
+    LOG_WARN("Homing failed: %s", error);
+    enter(FAILED);
+}
+
+void HomingSequence::saveTravel(int32_t travel) {
+    if (travel == _storedTravel) return;  // Spare the flash
+    ConfigSchema::HomingSection section = {travel, 0};
+    if (FlashController::set<ConfigSchema::Homing>(section)) {
+        _storedTravel = travel;
+    }
+}
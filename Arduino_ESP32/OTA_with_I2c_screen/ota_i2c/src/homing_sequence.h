@@ -0,0 +1,109 @@
+#ifndef HOMING_SEQUENCE_H
+#define HOMING_SEQUENCE_H
+
+#include <Arduino.h>
+#include "control_signal_handler.h"
+#include "motion_controller.h"
+
+// Two-phase homing on HOME_SWITCH, then a travel measurement on END_SWITCH:
+//
+//   FAST_APPROACH   seek backward at fastSpeed until HOME_SWITCH stops the motor
+//   BACK_OFF        move forward backOffSteps until the switch has released
+//   SLOW_APPROACH   seek backward at slowSpeed; the position captured by the
+//                   switch interrupt on the closing edge becomes 0
+//   MEASURE_TRAVEL  seek forward at fastSpeed until END_SWITCH stops the motor;
+//                   its closing edge is the travel (skipped with measureTravel
+//                   off when a travel is stored)
+//   RETURN          set soft limits [margin, travel - margin], move to margin
+//
+// The travel is stored in flash. Both switches must stop travel towards
+// themselves from their interrupt (LimitSwitch::ACTION_STOP_DIRECTION).
+// PositionMemory keeps the homed state, so when a trusted position is
+// restored after a reset, begin() reports homed without a new run.
+//
+// update() runs on the signals task and drives the motor through the motion
+// mailbox as PRODUCER_LOCAL. start(), abort() and status() may be called from
+// any task.
+class HomingSequence
+{
+public:
+    enum Phase : uint8_t {
+        IDLE,
+        FAST_APPROACH,
+        BACK_OFF,
+        SLOW_APPROACH,
+        MEASURE_TRAVEL,
+        RETURN,
+        DONE,
+        FAILED,
+        PHASE_COUNT
+    };
+
+    struct Settings {
+        float fastSpeed;        // steps/s
+        float slowSpeed;        // steps/s
+        int32_t backOffSteps;
+        int32_t margin;         // Soft limits this far inside the switches
+        int32_t maxTravel;      // Give up when a switch is not found within this
+        bool measureTravel;     // false: reuse the stored travel if there is one
+    };
+
+    struct Status {
+        Phase phase;
+        uint32_t sequence;                  // Bumped on every phase change
+        uint32_t elapsedMs;                 // Since start(), frozen once finished
+        uint32_t phaseMs[PHASE_COUNT];      // Time spent in each phase
+        int32_t travel;                     // Steps between the switch edges, 0 = unknown
+        bool homed;
+        const char* error;                  // Set in FAILED
+    };
+
+    static const char* const HOME_SWITCH_ID;
+    static const char* const END_SWITCH_ID;
+
+    HomingSequence(MotionController& motion, ControlSignalHandler& signals);
+
+    bool begin();                           // Load the stored travel; false if there is none
+    bool start(const Settings& settings);   // false while a sequence is running
+    void abort();
+    void update();
+    Status status() const;
+
+    static Settings defaults();
+    static const char* phaseName(Phase phase);
+
+private:
+    // Commands take a motion tick or two to show up in MotionStatus
+    static const unsigned long SETTLE_MS = 20;
+    static const unsigned long RELEASE_TIMEOUT_MS = 500;
+
+    MotionController& _motion;
+    ControlSignalHandler& _signals;
+
+    // Requests from other tasks, picked up by update()
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    bool _startRequested = false;
+    bool _abortRequested = false;
+    Settings _requested;
+
+    // Owned by update(), which copies _status to _published under _lock
+    Settings _settings;
+    Status _status;
+    Status _published;
+    unsigned long _startMs = 0;
+    unsigned long _phaseStartMs = 0;
+    int32_t _phaseStartPosition = 0;
+    uint32_t _edgeCount = 0;                // Switch closings seen before the phase started
+    ControlSignalHandler::SwitchHandle _home = ControlSignalHandler::INVALID_SWITCH;  // Resolved on start
+    ControlSignalHandler::SwitchHandle _end = ControlSignalHandler::INVALID_SWITCH;
+    int32_t _storedTravel = 0;
+
+    void enter(Phase phase);
+    void fail(const char* error);
+    bool post(MotionCommand::Type type, int32_t value = 0, float real = 0.0f, int32_t value2 = 0);
+    void publish();
+    bool settled() const { return millis() - _phaseStartMs >= SETTLE_MS; }
+    void saveTravel(int32_t travel);
+};
+
+#endif // HOMING_SEQUENCE_H
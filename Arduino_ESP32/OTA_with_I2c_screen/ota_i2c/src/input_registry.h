@@ -0,0 +1,100 @@
+#ifndef INPUT_REGISTRY_H
+#define INPUT_REGISTRY_H
+
+#include <Arduino.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Fixed-capacity store for input objects (LimitSwitch and the like), built in
+// place in one contiguous array: no heap, and an object never moves, so its
+// address can be handed to an interrupt. add() returns a small integer handle
+// (the slot) that stays valid until remove(). get() and findByPin() are O(1);
+// find() by ID is a linear scan meant for setup and the web API.
+// T needs getId() and getPin(). add() and remove() must not race with other
+// calls; get() on a live handle may come from any task or ISR.
+template<typename T, uint8_t Capacity>
+class InputRegistry
+{
+    static_assert(Capacity <= 32, "InputRegistry tracks slots in a 32-bit mask");
+
+public:
+    typedef int8_t Handle;
+    static const Handle INVALID = -1;
+    static const uint8_t PIN_COUNT = 40;
+
+    InputRegistry() {
+        for (uint8_t pin = 0; pin < PIN_COUNT; pin++) _byPin[pin] = INVALID;
+    }
+    ~InputRegistry() {
+        for (Handle h = 0; h < (Handle)Capacity; h++) remove(h);
+    }
+    InputRegistry(const InputRegistry&) = delete;
+    InputRegistry& operator=(const InputRegistry&) = delete;
+
+    // INVALID when full or the pin is taken
+    template<typename... Args>
+    Handle add(uint8_t pin, Args&&... args) {
+        if (pin >= PIN_COUNT || _byPin[pin] != INVALID) return INVALID;
+        for (Handle h = 0; h < (Handle)Capacity; h++) {
+            if (_used & (1u << h)) continue;
+            new (&_slots[h]) T(pin, std::forward<Args>(args)...);
+            _used |= 1u << h;
+            _byPin[pin] = h;
+            return h;
+        }
+        return INVALID;
+    }
+
+    bool remove(Handle h) {
+        T* item = get(h);
+        if (!item) return false;
+        _byPin[item->getPin()] = INVALID;
+        _used &= ~(1u << h);
+        item->~T();
+        return true;
+    }
+
+    T* IRAM_ATTR get(Handle h) {
+        return valid(h) ? reinterpret_cast<T*>(&_slots[h]) : nullptr;
+    }
+    const T* IRAM_ATTR get(Handle h) const {
+        return valid(h) ? reinterpret_cast<const T*>(&_slots[h]) : nullptr;
+    }
+    bool IRAM_ATTR valid(Handle h) const { return h >= 0 && h < (Handle)Capacity && (_used & (1u << h)); }
+
+    Handle findByPin(uint8_t pin) const { return pin < PIN_COUNT ? _byPin[pin] : INVALID; }
+    Handle find(const char* id) const {
+        for (Handle h = 0; h < (Handle)Capacity; h++) {
+            if ((_used & (1u << h)) && strcmp(get(h)->getId(), id) == 0) return h;
+        }
+        return INVALID;
+    }
+
+    // fn(Handle, T&) for every live entry, in handle order
+    template<typename F>
+    void forEach(F fn) {
+        for (uint32_t pending = _used; pending; pending &= pending - 1) {
+            Handle h = __builtin_ctz(pending);
+            fn(h, *get(h));
+        }
+    }
+    template<typename F>
+    void forEach(F fn) const {
+        for (uint32_t pending = _used; pending; pending &= pending - 1) {
+            Handle h = __builtin_ctz(pending);
+            fn(h, *get(h));
+        }
+    }
+
+    uint8_t size() const { return __builtin_popcount(_used); }
+    uint32_t mask() const { return _used; }  // Bit n = handle n in use
+    static constexpr uint8_t capacity() { return Capacity; }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _slots[Capacity];
+    volatile uint32_t _used = 0;
+    Handle _byPin[PIN_COUNT];
+};
+
+#endif // INPUT_REGISTRY_H
@@ -0,0 +1,51 @@
+#include "input_sampler.h"
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+bool InputSampler::addPin(uint8_t pin, bool activeLow) {
+    if (pin > MAX_PIN) return false;
+    uint64_t bit = 1ULL << pin;
+    _count0 &= ~bit;
+    _count1 &= ~bit;
+    _state &= ~bit;
+    if (activeLow) {
+        _invert |= bit;
+    } else {
+        _invert &= ~bit;
+    }
+    _enabled |= bit;
+    return true;
+}
+
+void InputSampler::removePin(uint8_t pin) {
+    if (pin > MAX_PIN) return;
+    uint64_t bit = ~(1ULL << pin);
+    _enabled &= bit;
+    _state &= bit;
+    _count0 &= bit;
+    _count1 &= bit;
+}
+
+uint64_t InputSampler::readInputs() {
+    return ((uint64_t)(REG_READ(GPIO_IN1_REG) & 0xFF) << 32) | REG_READ(GPIO_IN_REG);
+}
+
+uint64_t InputSampler::sample() {
+    uint64_t raw = (readInputs() ^ _invert) & _enabled;
+    uint64_t delta = raw ^ _state;
+
+    // Count up where the input differs from the state, reset elsewhere; a
+    // counter that wraps to 0 has seen SAMPLES differing samples in a row
+    _count1 = (_count1 ^ _count0) & delta;
+    _count0 = ~_count0 & delta;
+    uint64_t toggle = delta & ~(_count0 | _count1);
+    if (!toggle) return 0;
+
+    _state ^= toggle;
+    uint32_t now = micros();
+    for (uint64_t pending = toggle; pending; pending &= pending - 1) {
+        uint8_t pin = __builtin_ctzll(pending);
+        _events.push({pin, (bool)((_state >> pin) & 1), now});
+    }
+    return toggle;
+}
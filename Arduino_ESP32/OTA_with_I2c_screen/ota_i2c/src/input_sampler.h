@@ -0,0 +1,56 @@
+#ifndef INPUT_SAMPLER_H
+#define INPUT_SAMPLER_H
+
+#include <Arduino.h>
+#include "spsc_queue.h"
+
+// Debounces every registered GPIO input at once. Each sample() reads the two
+// GPIO input registers (GPIO 0-31 and 32-39) and runs all 40 pins through a
+// 2-bit vertical counter: bit n of _count0/_count1 is pin n's count of
+// consecutive samples that differ from its debounced state. A pin changes
+// state on the SAMPLES-th such sample, so the debounce time is SAMPLES times
+// the sampling period, whatever the number of inputs. Each change is queued
+// as an Event.
+// Not thread-safe: sample(), popEvent() and isActive() belong to one task.
+class InputSampler
+{
+public:
+    static const uint8_t MAX_PIN = 39;
+    static const uint8_t SAMPLES = 4;           // Equal samples to accept a new level; fixed by the 2-bit counter
+    static const size_t EVENT_CAPACITY = 64;
+
+    struct Event {
+        uint8_t pin;
+        bool active;                            // Debounced state after the change
+        uint32_t timeUs;                        // When the change was accepted
+    };
+
+    // The pin starts out inactive; an input already active is reported after
+    // SAMPLES samples
+    bool addPin(uint8_t pin, bool activeLow);
+    void removePin(uint8_t pin);
+
+    // Returns a mask of the pins whose debounced state changed
+    uint64_t sample();
+    bool popEvent(Event& event) { return _events.pop(event); }
+
+    bool isActive(uint8_t pin) const { return pin <= MAX_PIN && (_state >> pin) & 1; }
+    uint64_t activeMask() const { return _state; }
+    uint32_t droppedEvents() const { return _events.overflows(); }
+
+private:
+    uint64_t _enabled = 0;
+    uint64_t _invert = 0;                       // Active-low pins
+    uint64_t _state = 0;                        // Debounced, 1 = active
+    uint64_t _count0 = 0;
+    uint64_t _count1 = 0;
+    SpscQueue<Event, EVENT_CAPACITY> _events;
+
+    static uint64_t readInputs();
+};
+
+// sample() counts in two bit planes and accepts on the wrap to 0; another
+// debounce length needs another counter, not just another SAMPLES
+static_assert(InputSampler::SAMPLES == 4, "The 2-bit vertical counter wraps after exactly 4 samples");
+
+#endif // INPUT_SAMPLER_H
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "flash_controller.h"
+#include "logger.h"
 
 class LedControl 
 {
@@ -16,19 +17,15 @@ public:
     
     void init() 
     {
-        Serial.println("LedControl::init() called");
-        Serial.flush();
+        LOG_DEBUG("LedControl::init() called");
         pinMode(_pin, OUTPUT);
-        Serial.printf("LED pin mode %d, output\n", _pin, OUTPUT);
-        Serial.flush();
         setLedOff();  // Start with LED off
-        Serial.printf("LED initialized on pin %d\n", _pin);
-        Serial.flush();
+        LOG_INFO("LED initialized on pin %d", _pin);
     }
     
     void blink(int count, int delayMs) 
     {
-        Serial.printf("LedControl::blink() called with count: %d, delay: %dms\n", count, delayMs);
+        LOG_DEBUG("LedControl::blink() called with count: %d, delay: %dms", count, delayMs);
         for (int i = 0; i < count; i++) 
         {
             setLedOn();
@@ -36,40 +33,47 @@ public:
             setLedOff();
             delay(delayMs);
         }
-        Serial.println("Blink sequence completed");
+        LOG_DEBUG("Blink sequence completed");
     }
 
     void on() 
     {
-        Serial.println("LedControl::on() called");
+        LOG_DEBUG("LedControl::on() called");
         setLedOn();
     }
     
     void off() 
     {
-        Serial.println("LedControl::off() called");
+        LOG_DEBUG("LedControl::off() called");
         setLedOff();
     }
 
-    // Static method to get LED pin from Flash or return default
+    // Static method to get LED pin from Flash or return default; read again
+    // only after a stored setting changed
     static int getLedPin() 
     {
-        Serial.println("LedControl::getLedPin() called");
+        static int cachedPin = -1;
+        static uint32_t cachedGeneration = 0;
+        uint32_t generation = FlashController::generation();
+        if (cachedPin >= 0 && generation == cachedGeneration) return cachedPin;
+
+        LOG_DEBUG("LedControl::getLedPin() reading Flash");
         int pin = FlashController::readLedPin();
         if (pin < 0) {
-            Serial.println("Failed to read LED pin from Flash, using default");
-            pin = DEFAULT_LED_PIN;
-            FlashController::writeLedPin(pin);
+            LOG_WARN("Failed to read LED pin from Flash, using default");
+            return DEFAULT_LED_PIN;
         }
+        cachedPin = pin;
+        cachedGeneration = generation;
         return pin;
     }
 
     // Static method to save LED pin to Flash
     static void saveLedPin(int pin) 
     {
-        Serial.printf("LedControl::saveLedPin() called with pin: %d\n", pin);
+        LOG_DEBUG("LedControl::saveLedPin() called with pin: %d", pin);
         if (!FlashController::writeLedPin(pin)) {
-            Serial.printf("Failed to save LED pin %d to Flash\n", pin);
+            LOG_ERROR("Failed to save LED pin %d to Flash", pin);
         }
     }
 
@@ -1,15 +1,15 @@
 #include "limit_switch.h"
+#include "logger.h"
 
-LimitSwitch::LimitSwitch(uint8_t pin, const char* id, bool activeLow, uint8_t priority)
+LimitSwitch::LimitSwitch(uint8_t pin, const char* id, bool activeLow, uint8_t priority, EdgeLog* edgeLog)
     : _pin(pin), _id(id), _activeLow(activeLow), _priority(priority),
-      _isTriggered(false), _stateChanged(false), _lastDebounceTime(0) {}
+      _isTriggered(false), _edgeLog(edgeLog) {}
 
 bool LimitSwitch::init() {
     if (_pin > 39) return false;  // ESP32 has GPIO 0-39
     
     pinMode(_pin, INPUT_PULLUP);
-    Serial.printf("Setting up interrupt for pin %d, id: %s, priority: %d\n", 
-                 _pin, _id, _priority);
+    LOG_INFO("Setting up interrupt for pin %d, id: %s, priority: %d", _pin, _id, _priority);
     
     // On ESP32, we can use the GPIO number directly for interrupts
     // Set the interrupt priority
@@ -21,29 +21,107 @@ bool LimitSwitch::init() {
 void IRAM_ATTR LimitSwitch::handleInterrupt(void* arg) {
     LimitSwitch* sw = static_cast<LimitSwitch*>(arg);
     if (!sw) return;  // Safety check
-    
-    // Just set the flag - do minimal work in ISR
-    sw->_stateChanged = true;
+    uint32_t edgeUs = micros();
+
+    StepperManager* stepper = sw->_stepper;
+    bool level = digitalRead(sw->_pin);
+    bool active = sw->_activeLow ? !level : level;
+    int32_t position = stepper ? stepper->positionFromIsr(edgeUs) : 0;
+    if (sw->_edgeLog) sw->_edgeLog->record(sw->_pin, level, active, position);
+    if (!stepper || !active) return;
+
+    // First closing edge since the last debounced release: where the motor
+    // was when the switch closed, e.g. as a homing reference
+    if (sw->_edgeArmed) {
+        sw->_edgeArmed = false;
+        sw->_closeEdge.timeUs = edgeUs;
+        sw->_closeEdge.position = position;
+        sw->_closeEdge.count++;
+    }
+
+    // Hand the stop to the motion task straight away; the debounced state
+    // follows later in update()
+    if (sw->_action == ACTION_REPORT || sw->_stopPending) return;
+    StepperManager::HaltRequest request;
+    switch (sw->_action) {
+        case ACTION_FORCE_STOP:
+            request = StepperManager::HALT_FORCE_STOP;
+            break;
+        case ACTION_STOP_DIRECTION:
+            request = StepperManager::HALT_DIRECTION;
+            break;
+        case ACTION_DECELERATE:
+            request = StepperManager::HALT_DECELERATE;
+            break;
+        default:
+            return;
+    }
+    sw->_haltTicket = stepper->requestHaltFromIsr(request, sw->_direction);
+    sw->_edgeUs = edgeUs;
+    sw->_edgePosition = position;
+    sw->_stopAnnounced = false;
+    sw->_stopPending = true;
+    LOG_FROM_ISR(LOG_LEVEL_DEBUG, "Limit switch stop latched at %ld", position);
+}
+
+void LimitSwitch::setAction(Action action, int8_t direction, StepperManager* stepper) {
+    _action = ACTION_REPORT;  // Keep the ISR away while the target changes
+    _stepper = stepper;
+    _direction = direction;
+    _action = action;
 }
 
 void LimitSwitch::update() {
-    if (_stateChanged) {
-        unsigned long currentTime = millis();
-        if (currentTime - _lastDebounceTime > DEBOUNCE_DELAY) {
-            bool currentState = digitalRead(_pin);
-            if (_activeLow) {
-                currentState = !currentState;
-            }
-            
-            if (currentState != _isTriggered) {
-                _isTriggered = currentState;
-                Serial.printf("Switch %s on pin %d changed state to: %d\n", 
-                            _id, _pin, currentState);
-            }
-            _lastDebounceTime = currentTime;
-            _stateChanged = false;  // Only clear the flag after processing
+    if (!_stopPending) return;
+    if (!_stopAnnounced) {
+        uint32_t actionUs;
+        switch (_stepper->getHaltOutcome(_haltTicket, actionUs)) {
+            case StepperManager::HALT_PENDING:
+                return;
+            case StepperManager::HALT_IGNORED:
+                _stopPending = false;  // At rest or moving away; nothing to report
+                return;
+            default:
+                break;
         }
+        _actionUs = actionUs - _edgeUs;
+        _stopAnnounced = true;
+        EventBus::instance().publish(EventBus::LIMIT_HIT, _pin, _edgePosition, _id);
     }
+    if (!_stepper->isRunning()) {
+        int32_t overrun = (int32_t)_stepper->getCurrentPosition() - _edgePosition;
+        _lastStop.stops++;
+        _lastStop.actionUs = _actionUs;
+        _lastStop.stopUs = micros() - _edgeUs;
+        _lastStop.overrunSteps = overrun < 0 ? -overrun : overrun;
+        _stopPending = false;
+        LOG_INFO("Switch %s stopped the motor: engine told %lu us after the edge, at rest after %lu us, %ld steps past it",
+                 _id, (unsigned long)_lastStop.actionUs, (unsigned long)_lastStop.stopUs, (long)_lastStop.overrunSteps);
+    }
+}
+
+bool LimitSwitch::setDebouncedState(bool triggered) {
+    if (triggered == _isTriggered) return false;
+    _isTriggered = triggered;
+    LOG_INFO("Switch %s on pin %d changed state to: %d", _id, _pin, triggered);
+    if (!triggered) {
+        _edgeArmed = true;
+        if (_action == ACTION_STOP_DIRECTION && _stepper) {
+            _stepper->unblockDirection(_direction);
+        }
+    }
+    return triggered;
+}
+
+LimitSwitch::Edge LimitSwitch::getLastEdge() const {
+    // The three fields are written together by the ISR; retry if one came in between
+    Edge edge;
+    do {
+        edge.count = _closeEdge.count;
+        edge.timeUs = _closeEdge.timeUs;
+        edge.position = _closeEdge.position;
+    } while (edge.count != _closeEdge.count);
+    return edge;
 }
 
 bool LimitSwitch::isTriggered() const {
@@ -2,9 +2,37 @@
 #define LIMIT_SWITCH_H
 
 #include <Arduino.h>
+#include "edge_log.h"
+#include "event_bus.h"
+#include "stepper_manager.h"
 
 class LimitSwitch {
 public:
+    // What happens to the motor on the active edge, before any debouncing:
+    // the interrupt latches the stop and the motion task carries it out on
+    // its next tick. Bounce only repeats the same (idempotent) request.
+    enum Action : uint8_t {
+        ACTION_REPORT,          // Nothing; only report the debounced state
+        ACTION_FORCE_STOP,      // Stop at once, without a ramp
+        ACTION_STOP_DIRECTION,  // Stop a move towards the switch and refuse new ones until released
+        ACTION_DECELERATE       // Ramp down at the configured acceleration
+    };
+
+    // Closing edge captured in the ISR
+    struct Edge {
+        uint32_t count;         // Closings seen so far; bounce counts once
+        uint32_t timeUs;
+        int32_t position;       // Motor position at the edge
+    };
+
+    // Last stop the switch caused
+    struct StopReport {
+        uint32_t stops;         // Activations that stopped a running motor
+        uint32_t actionUs;      // Edge until the motion task had told the step engine
+        uint32_t stopUs;        // Edge until the motor was seen at rest (signals task resolution)
+        int32_t overrunSteps;   // Steps taken after the edge
+    };
+
     // Priority levels for different types of switches
     static const uint8_t PRIORITY_CRITICAL = 1;  // Highest priority
     static const uint8_t PRIORITY_HIGH = 2;
@@ -13,14 +41,25 @@ public:
     static const uint8_t PRIORITY_LOWEST = 7;    // Lowest priority
 
     // Constructor
-    LimitSwitch(uint8_t pin, const char* id, bool activeLow = true, uint8_t priority = PRIORITY_NORMAL);
+    // Every edge the interrupt sees goes to edgeLog, if given
+    LimitSwitch(uint8_t pin, const char* id, bool activeLow = true, uint8_t priority = PRIORITY_NORMAL,
+                EdgeLog* edgeLog = nullptr);
     
     // Core functionality
     bool init();
     bool isTriggered() const;
     const char* getId() const;
     uint8_t getPin() const;
-    void update();  // New method to handle state changes
+    void update();  // Completes the report of a stop the interrupt made
+    // Takes a debounced level from the InputSampler; true when the switch has just become triggered
+    bool setDebouncedState(bool triggered);
+
+    // direction is the side of travel the switch guards (>0 forward, <0 backward)
+    void setAction(Action action, int8_t direction, StepperManager* stepper);
+    Action getAction() const { return (Action)_action; }
+    int8_t getDirection() const { return _direction; }
+    StopReport getLastStop() const { return _lastStop; }
+    Edge getLastEdge() const;
     
     // Interrupt handling
     static void IRAM_ATTR handleInterrupt(void* arg);
@@ -31,9 +70,24 @@ private:
     bool _activeLow;
     uint8_t _priority;  // Interrupt priority (1-7)
     volatile bool _isTriggered;
-    volatile bool _stateChanged;  // New flag for state changes
-    volatile unsigned long _lastDebounceTime;
-    static const unsigned long DEBOUNCE_DELAY = 50; // ms
+    EdgeLog* _edgeLog;
+
+    StepperManager* _stepper = nullptr;
+    volatile uint8_t _action = ACTION_REPORT;
+    volatile int8_t _direction = 0;
+
+    // Captured by the ISR on the edge that requested a stop; update()
+    // completes the report once the motor is at rest
+    volatile bool _stopPending = false;
+    volatile uint32_t _haltTicket = 0;
+    volatile uint32_t _edgeUs = 0;
+    volatile int32_t _edgePosition = 0;
+    bool _stopAnnounced = false;  // LIMIT_HIT published for this stop
+    uint32_t _actionUs = 0;
+    StopReport _lastStop = {};
+
+    volatile bool _edgeArmed = true;
+    volatile Edge _closeEdge = {};
 };
 
 #endif // LIMIT_SWITCH_H 
\ No newline at end of file
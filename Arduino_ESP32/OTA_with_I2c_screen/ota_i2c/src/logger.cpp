@@ -0,0 +1,176 @@
+#include "logger.h"
+
+static_assert((Logger::CAPACITY & (Logger::CAPACITY - 1)) == 0, "Logger capacity must be a power of two");
+static_assert(Logger::MESSAGE_SIZE <= 256, "Message lengths are kept in a byte");
+
+namespace {
+    struct Slot {
+        std::atomic<uint32_t> seq{0};   // 2 * ticket + 1 while written, 2 * ticket + 2 once complete
+        Logger::Level level;
+        bool deferred;                  // writeFromIsr(): format and value, no text yet
+        uint8_t length;
+        const char* tag;
+        const char* format;
+        int32_t value;
+        char text[Logger::MESSAGE_SIZE];
+    };
+
+    const size_t LINE_SIZE = Logger::MESSAGE_SIZE + 24;  // Room for the tag and "\r\n"
+
+    Slot slots[Logger::CAPACITY];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> direct{0};      // Printed at once, before startAsync()
+    std::atomic<uint32_t> truncated{0};
+    std::atomic<bool> async{false};
+    uint32_t cursor = 0;                  // drain() only
+    Logger::Stats drainStats = {};        // drain() only
+    Logger::Sink sink;
+
+    size_t clip(int length) {
+        if (length < 0) return 0;
+        if ((size_t)length >= Logger::MESSAGE_SIZE) {
+            truncated.fetch_add(1, std::memory_order_relaxed);
+            return Logger::MESSAGE_SIZE - 1;
+        }
+        return length;
+    }
+
+    // "[tag] text" into line; returns its length without the "\r\n" that follows it
+    size_t compose(char* line, const char* tag, const char* text, size_t length) {
+        size_t used = tag ? snprintf(line, LINE_SIZE - 2 - length, "[%s] ", tag) : 0;
+        if (used > LINE_SIZE - 3 - length) used = LINE_SIZE - 3 - length;
+        memcpy(line + used, text, length);
+        used += length;
+        line[used] = '\r';
+        line[used + 1] = '\n';
+        return used;
+    }
+}
+
+void Logger::write(Level level, const char* tag, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vwrite(level, tag, format, args);
+    va_end(args);
+}
+
+void Logger::vwrite(Level level, const char* tag, const char* format, va_list args) {
+    if (!async.load(std::memory_order_acquire)) {
+        char text[MESSAGE_SIZE];
+        char line[LINE_SIZE];
+        size_t length = clip(vsnprintf(text, sizeof(text), format, args));
+        length = compose(line, tag, text, length);
+        direct.fetch_add(1, std::memory_order_relaxed);
+        Serial.write((const uint8_t*)line, length + 2);
+        return;
+    }
+
+    uint32_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[ticket & (CAPACITY - 1)];
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.level = level;
+    slot.deferred = false;
+    slot.tag = tag;
+    slot.length = clip(vsnprintf(slot.text, sizeof(slot.text), format, args));
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+}
+
+void IRAM_ATTR Logger::writeFromIsr(Level level, const char* format, int32_t value) {
+    uint32_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[ticket & (CAPACITY - 1)];
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.level = level;
+    slot.deferred = true;
+    slot.tag = nullptr;
+    slot.format = format;
+    slot.value = value;
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+}
+
+void Logger::startAsync() {
+    async.store(true, std::memory_order_release);
+}
+
+void Logger::stopAsync() {
+    async.store(false, std::memory_order_release);
+}
+
+bool Logger::isAsync() {
+    return async.load(std::memory_order_acquire);
+}
+
+void Logger::setSink(Sink newSink) {
+    sink = newSink;
+}
+
+size_t Logger::drain(size_t max) {
+    size_t read = 0;
+    uint32_t pending = head.load(std::memory_order_acquire) - cursor;
+    if (pending > drainStats.maxPending) drainStats.maxPending = pending;
+
+    while (read < max) {
+        uint32_t current = head.load(std::memory_order_acquire);
+        if (cursor == current) break;
+        const Slot& slot = slots[cursor & (CAPACITY - 1)];
+        uint32_t expected = 2 * cursor + 2;
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        int32_t age = (int32_t)(before - expected);
+        if (age < 0) break;  // Claimed but still being written (the writer was preempted)
+
+        if (age == 0) {
+            Level level = slot.level;
+            bool deferred = slot.deferred;
+            const char* tag = slot.tag;
+            const char* format = slot.format;
+            int32_t value = slot.value;
+            size_t length = slot.length;
+            char text[MESSAGE_SIZE];
+            if (!deferred) memcpy(text, slot.text, length);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                cursor++;
+                read++;
+                if (deferred) length = clip(snprintf(text, sizeof(text), format, (long)value));
+                char line[LINE_SIZE];
+                length = compose(line, tag, text, length);
+                Serial.write((const uint8_t*)line, length + 2);
+                if (sink) {
+                    line[length] = '\0';
+                    sink(level, line, length);
+                }
+                drainStats.drained++;
+                continue;
+            }
+        }
+
+        // Lapped: skip to the oldest message still in the ring
+        uint32_t oldest = head.load(std::memory_order_acquire) - CAPACITY;
+        if ((int32_t)(oldest - cursor) > 0) {
+            drainStats.dropped += oldest - cursor;
+            cursor = oldest;
+        } else {
+            drainStats.dropped++;
+            cursor++;
+        }
+    }
+    return read;
+}
+
+Logger::Stats Logger::getStats() {
+    Stats stats = drainStats;
+    stats.written = head.load(std::memory_order_relaxed) + direct.load(std::memory_order_relaxed);
+    stats.truncated = truncated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+const char* Logger::levelName(Level level) {
+    switch (level) {
+        case ERROR: return "error";
+        case WARN: return "warn";
+        case INFO: return "info";
+        case DEBUG: return "debug";
+        default: return "unknown";
+    }
+}
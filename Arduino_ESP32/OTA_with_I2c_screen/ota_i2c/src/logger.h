@@ -0,0 +1,85 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <stdarg.h>
+
+// Levels for LOG_LEVEL; set it with -DLOG_LEVEL=<n> in platformio.ini.
+// Calls above it are removed by the compiler together with their arguments.
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_AT(level, tag, ...) \
+    do { if ((level) <= LOG_LEVEL) Logger::write((Logger::Level)(level), tag, __VA_ARGS__); } while (0)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, nullptr, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN, nullptr, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO, nullptr, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, nullptr, __VA_ARGS__)
+#define LOG_FROM_ISR(level, format, value) \
+    do { if ((level) <= LOG_LEVEL) Logger::writeFromIsr((Logger::Level)(level), format, value); } while (0)
+
+// Log lines from any task or ISR without waiting for the UART. write()
+// formats the message straight into a slot of one ring, claimed with an
+// atomic ticket and stamped with a sequence number once complete (the
+// EventBus scheme), and returns; the log task writes the lines out with
+// drain(). At 115200 baud a 60-character line takes 5 ms to send, which
+// Serial.printf() spent in the caller once the 128-byte UART FIFO was full.
+//
+// Until startAsync() (called just before the tasks start) write() prints at
+// once, so setup() output stays in order with its direct Serial prints. When
+// the ring laps the log task, the lines it missed are counted as dropped.
+//
+// ISRs use writeFromIsr() (LOG_FROM_ISR): it calls no formatter, which may
+// run from flash, and only stores the format, a static string with one %ld,
+// and its argument; drain() formats them.
+class Logger
+{
+public:
+    enum Level : uint8_t {
+        ERROR = LOG_LEVEL_ERROR,
+        WARN = LOG_LEVEL_WARN,
+        INFO = LOG_LEVEL_INFO,
+        DEBUG = LOG_LEVEL_DEBUG
+    };
+
+    struct Stats {
+        uint32_t written;       // Messages claimed, including those printed before startAsync()
+        uint32_t drained;       // Lines written out by drain()
+        uint32_t dropped;       // Overwritten before drain() read them
+        uint32_t truncated;     // Cut to MESSAGE_SIZE - 1 characters
+        uint32_t maxPending;    // Deepest backlog drain() has found
+    };
+
+    // Also given each drained line (without "\r\n"), e.g. to stream it to WebSocket clients
+    using Sink = std::function<void(Level level, const char* line, size_t length)>;
+
+    static const size_t CAPACITY = 64;
+    static const size_t MESSAGE_SIZE = 128;
+
+    // tag is a static string printed as "[tag] " before the message, or nullptr
+    static void write(Level level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+    static void vwrite(Level level, const char* tag, const char* format, va_list args);
+    static void IRAM_ATTR writeFromIsr(Level level, const char* format, int32_t value);
+
+    static void startAsync();
+    static void stopAsync();  // Print at once again; lines already queued wait for drain()
+    static bool isAsync();
+
+    // Writes up to max pending lines to Serial and the sink; returns how many were read
+    static size_t drain(size_t max = CAPACITY);
+    static void setSink(Sink sink);  // Before startAsync(); drain() calls it from the log task
+
+    static Stats getStats();
+    static const char* levelName(Level level);
+};
+
+#endif // LOGGER_H
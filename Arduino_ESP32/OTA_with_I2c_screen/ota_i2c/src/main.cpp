@@ -4,6 +4,8 @@
 #include "display_manager.h"
 #include "server_manager.h"
 #include "stepper_manager.h"
+#include "motion_controller.h"
+#include "task_scheduler.h"
 #include "led_control.h"
 #include "git_version.h"
 #include "config.h"
@@ -11,19 +13,44 @@
 #include "main_setup_helpers.h"
 #include "control_signal_handler.h"
 #include "flash_controller.h"
+#include "homing_sequence.h"
+#include "event_bus.h"
+#include "logger.h"
 #include "my_wifi_manager.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_RESET -1
 
-DisplayManager display(SCREEN_WIDTH, SCREEN_HEIGHT, OLED_RESET);
+DisplayManager display(SCREEN_WIDTH, SCREEN_HEIGHT, OLED_RESET, OLED_I2C_CLOCK);
 PinManager pinManager(display);
 StepperManager stepperMotor(display);
-ServerManager serverManager(display, stepperMotor, pinManager);
+MotionController motion(stepperMotor);  // Sole owner of stepperMotor once started
+ControlSignalHandler signalHandler(display, stepperMotor);  // Switch ISRs stop the motor directly
+HomingSequence homing(motion, signalHandler);
+ServerManager serverManager(display, motion, pinManager, signalHandler, homing);
 OTAManager otaManager(display);
 LedControl led;  // Fixed LED initialization
-ControlSignalHandler signalHandler(display);
+EventBus::SubscriberId displayEvents = -1;  // Dispatched by the display task
+EventBus::SubscriberId logEvents = -1;      // Dispatched by the ota task
+const char* switchAlert = nullptr;          // Latest switch to show; display task only
+
+// Published state only: the motion task's status, the switch mask and WiFi
+DisplayManager::Dashboard readDashboard() 
+{
+  MotionStatus status = motion.status();
+  DisplayManager::Dashboard dashboard;
+  dashboard.position = status.position;
+  dashboard.target = status.target;
+  dashboard.speed = status.speed;
+  dashboard.running = status.running;
+  dashboard.switchesUsed = signalHandler.switchMask();
+  dashboard.switchesClosed = signalHandler.triggeredMask();
+  dashboard.wifiConnected = WiFi.status() == WL_CONNECTED;
+  dashboard.rssi = dashboard.wifiConnected ? WiFi.RSSI() : 0;
+  dashboard.freeHeap = ESP.getFreeHeap();
+  return dashboard;
+}
 
 void setup() 
 {
@@ -88,8 +115,10 @@ void setup()
   delay(50);
   
   // Add limit switches with activeLow = false since they are active-high
-  // Using GPIO18 and GPIO19 which are general purpose I/O pins
-  if (!signalHandler.addLimitSwitch(18, "HOME_SWITCH", false)) {
+  // Using GPIO18 and GPIO19 which are general purpose I/O pins. Each one stops
+  // travel towards its end from the interrupt and still allows backing off.
+  if (signalHandler.addLimitSwitch(18, "HOME_SWITCH", false, LimitSwitch::ACTION_STOP_DIRECTION, -1) ==
+      ControlSignalHandler::INVALID_SWITCH) {
     Serial.print("SW1_ERR\r\n");
     Serial.flush();
   } else {
@@ -98,7 +127,8 @@ void setup()
   }
   delay(50);
   
-  if (!signalHandler.addLimitSwitch(19, "END_SWITCH", false)) {
+  if (signalHandler.addLimitSwitch(19, "END_SWITCH", false, LimitSwitch::ACTION_STOP_DIRECTION, 1) ==
+      ControlSignalHandler::INVALID_SWITCH) {
     Serial.print("SW2_ERR\r\n");
     Serial.flush();
   } else {
@@ -111,15 +141,29 @@ void setup()
   Serial.flush();
   delay(50);
 
-  // Register signal handler
-  signalHandler.registerSignalHandler([](const char* switchId) {
-    Serial.printf("SW_ACT:%s\r\n", switchId);
-    Serial.flush();
-    display.displayLines({
-      "Limit Switch",
-      switchId,
-      "Activated!"
-    });
+  // Not fatal: without a stored travel the first homing measures it
+  if (!homing.begin()) {
+    Serial.print("HOME_NONE\r\n");
+  } else {
+    Serial.print("HOME_OK\r\n");
+  }
+  Serial.flush();
+  delay(50);
+
+  // Event subscribers, each dispatched from its own low-priority task: the
+  // display task draws switch alerts so the signals task never waits on the
+  // I2C bus, and the ota task queues every event for the log task
+  displayEvents = EventBus::instance().subscribe("display", EventBus::maskOf(EventBus::INPUT_CHANGED),
+                                                 [](const EventBus::Event& event) {
+    if (event.value) switchAlert = event.name;
+  });
+  logEvents = EventBus::instance().subscribe("logger", EventBus::ALL, [](const EventBus::Event& event) {
+    if (event.type == EventBus::INPUT_CHANGED && event.value) {
+      LOG_INFO("SW_ACT:%s", event.name);
+    } else {
+      LOG_INFO("EVT:%s %u %ld %s", EventBus::typeName(event.type), event.source, (long)event.value,
+               event.name ? event.name : "");
+    }
   });
   Serial.print("HAND_OK\r\n");
   Serial.flush();
@@ -157,20 +201,46 @@ void setup()
   delay(50);
 
   displayFinalConnectionInfo(display);
+
+  // Motion and safety on the APP core, networking on the PRO core next to
+  // the WiFi stack; a higher priority preempts a lower one on the same core.
+  // Fields: name, period (ms), priority, core, stack size
+  TaskScheduler::add({"motion",    1,   5, APP_CPU_NUM, 4096}, []() { motion.poll(); });
+  TaskScheduler::add({"signals",   2,   4, APP_CPU_NUM, 4096}, []() {
+    signalHandler.handle();
+    homing.update();
+  });
+  TaskScheduler::add({"telemetry", 10,  2, PRO_CPU_NUM, 6144}, []() { serverManager.handleClient(); });
+  TaskScheduler::add({"display",   50,  1, APP_CPU_NUM, 4096}, []() {
+    EventBus::instance().dispatch(displayEvents);
+    if (switchAlert) display.displayLines({"Limit Switch", switchAlert, "Activated!"});
+    switchAlert = nullptr;
+    if (display.dashboardDue()) display.postDashboard(readDashboard());
+    display.render();  // Latest frame posted by any task; at most one per period
+  });
+  TaskScheduler::add({"ota",       50,  1, PRO_CPU_NUM, 8192}, []() {
+    otaManager.handle();
+    EventBus::instance().dispatch(logEvents);
+    FlashController::service();  // Settings changed elsewhere reach flash from here only
+    serverManager.serviceWifiReset();
+  });
+  TaskScheduler::add({"log",       20,  1, PRO_CPU_NUM, 4096}, []() { Logger::drain(); });
+  // Before the tasks run, so none of them draws or prints while another does
+  display.startAsync();  // Callers only post frames from now on; the display task draws them
+  Logger::startAsync();   // LOG_* calls only queue lines from now on; the log task prints them
+  if (!TaskScheduler::start()) {
+    Logger::stopAsync();  // The log task may not be running
+    Serial.print("TASK_ERR\r\n");
+    Serial.flush();
+    onFailure("Task Start Failed", display, led);
+  }
+  Serial.print("TASK_OK\r\n");
   Serial.print("DONE\r\n");
   Serial.flush();
 }
 
 void loop() 
 {
-  static unsigned long lastPrint = 0;
-  if (millis() - lastPrint > 1000) {  // Print every second
-    Serial.print("LOOP\r\n");
-    lastPrint = millis();
-  }
-  
-  otaManager.handle();
-  serverManager.handleClient();
-  stepperMotor.run();
-  signalHandler.handle();
-} 
\ No newline at end of file
+  // Everything periodic runs in the TaskScheduler tasks started by setup()
+  vTaskDelete(NULL);
+}
@@ -4,13 +4,17 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include "display_manager.h"
+#include "flash_controller.h"
 #include "led_control.h"
+#include "position_memory.h"
 #include "git_version.h"
 
 // Helper function to handle initialization failures
 void onFailure(const String&& message, DisplayManager& display, LedControl& led) {
     display.displayText(message.c_str());
     led.blink(5, 500);
+    PositionMemory::saveToFlash();
+    FlashController::flush();
     ESP.restart();
 }
 
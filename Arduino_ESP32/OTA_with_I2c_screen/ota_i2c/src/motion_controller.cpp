@@ -0,0 +1,127 @@
+#include "motion_controller.h"
+
+MotionController::MotionController(StepperManager& stepper) : _stepper(stepper), _planner(stepper) {}
+
+bool MotionController::post(Producer producer, const MotionCommand& command) {
+    return producer < PRODUCER_COUNT && _lanes[producer].push(command);
+}
+
+void MotionController::poll() {
+    // A switch that stopped the motor from its interrupt ends the segment
+    // queue at once, not only once the planner finds the motor at rest (a
+    // decelerating stop may still pass the end of the current segment)
+    if (_stepper.serviceHalt()) _planner.clear();
+    MotionCommand command;
+    for (auto& lane : _lanes) {
+        while (lane.pop(command)) {
+            execute(command);
+            _processed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    _planner.update();
+    _stepper.run();
+    publishStatus();
+}
+
+void MotionController::execute(const MotionCommand& command) {
+    switch (command.type) {
+        // Direct moves take over from whatever the segment queue was doing
+        case MotionCommand::MOVE_TO:
+            _planner.clear();
+            _stepper.moveTo(command.value);
+            break;
+        case MotionCommand::MOVE_BY:
+            _planner.clear();
+            _stepper.moveBy(command.value);
+            break;
+        case MotionCommand::JOG:
+            _planner.clear();
+            _stepper.jog(command.value);
+            break;
+        case MotionCommand::STOP:
+            _planner.clear();
+            _stepper.stop();
+            break;
+        case MotionCommand::SET_SPEED:
+            _stepper.setSpeed(command.real);
+            break;
+        case MotionCommand::SET_ACCEL:
+            _stepper.setAcceleration(command.real);
+            break;
+        case MotionCommand::SET_TORQUE:
+            _stepper.setHoldingTorque(command.value != 0);
+            break;
+        case MotionCommand::QUEUE_SEGMENT: {
+            MotionSegment segment = {command.value, command.real, command.accel};
+            _planner.append(segment);
+            break;
+        }
+        case MotionCommand::SET_BLENDING:
+            _planner.setBlending(command.value != 0);
+            break;
+        case MotionCommand::SET_PROFILE:
+            _stepper.setProfile((StepperManager::ProfileMode)command.value, command.real);
+            break;
+        case MotionCommand::SEEK:
+            _planner.clear();
+            _stepper.seek(command.value, command.real);
+            break;
+        case MotionCommand::SET_POSITION:
+            _planner.clear();
+            _stepper.setCurrentPosition(command.value);
+            break;
+        case MotionCommand::SET_SOFT_LIMITS:
+            _stepper.setSoftLimits(command.value, command.value2);
+            break;
+    }
+}
+
+void MotionController::publishStatus() {
+    MotionStatus next;
+    next.position = _stepper.getCurrentPosition();
+    next.target = _stepper.getTargetPosition();
+    next.speed = _stepper.getCurrentSpeed();
+    next.acceleration = _stepper.getCurrentAcceleration();
+    next.measuredAcceleration = _stepper.getMeasuredAcceleration();
+    next.running = _stepper.isRunning();
+    next.holdingTorque = _stepper.isHoldingTorqueEnabled();
+    next.queuedSegments = _planner.size();
+    next.segmentsCompleted = _planner.completed();
+    next.segmentsRejected = _planner.rejected();
+    next.softLimits = _stepper.hasSoftLimits();
+    next.softMin = _stepper.getSoftMin();
+    next.softMax = _stepper.getSoftMax();
+    if (next.running != _status.running) {
+        EventBus::instance().publish(next.running ? EventBus::MOTION_STARTED : EventBus::MOTION_STOPPED, 0,
+                                     next.position);
+    }
+
+    uint32_t seq = _statusSeq.load(std::memory_order_relaxed);
+    _statusSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _status = next;
+    _statusSeq.store(seq + 2, std::memory_order_release);
+}
+
+MotionStatus MotionController::status() const {
+    MotionStatus copy;
+    uint32_t before, after;
+    do {
+        before = _statusSeq.load(std::memory_order_acquire);
+        copy = _status;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = _statusSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return copy;
+}
+
+MotionController::Stats MotionController::stats() const {
+    Stats s;
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        s.depth[i] = _lanes[i].size();
+        s.highWater[i] = _lanes[i].highWater();
+        s.overflows[i] = _lanes[i].overflows();
+    }
+    s.processed = _processed.load(std::memory_order_relaxed);
+    return s;
+}
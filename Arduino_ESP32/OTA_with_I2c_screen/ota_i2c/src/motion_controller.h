@@ -0,0 +1,105 @@
+#ifndef MOTION_CONTROLLER_H
+#define MOTION_CONTROLLER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "event_bus.h"
+#include "motion_planner.h"
+#include "spsc_queue.h"
+#include "stepper_manager.h"
+
+// A stepper command as posted by the web server or another task
+struct MotionCommand {
+    enum Type : uint8_t {
+        MOVE_TO,        // value = absolute position
+        MOVE_BY,        // value = relative steps
+        JOG,            // value = direction (>0 forward, <0 backward)
+        STOP,
+        SET_SPEED,      // real = steps/s
+        SET_ACCEL,      // real = steps/s^2
+        SET_TORQUE,     // value = 0/1
+        QUEUE_SEGMENT,  // value = position, real = speed, accel (0 = defaults)
+        SET_BLENDING,   // value = 0/1
+        SET_PROFILE,    // value = StepperManager::ProfileMode, real = jerk (0 keeps it)
+        SEEK,           // value = direction, real = speed; ignores soft limits
+        SET_POSITION,   // value = new current position (motor at rest)
+        SET_SOFT_LIMITS // value = min, value2 = max; min >= max turns them off
+    };
+    Type type;
+    int32_t value;
+    float real;
+    float accel;
+    int32_t value2;
+};
+
+// Last state published by the motion task, safe to read from any task
+struct MotionStatus {
+    int32_t position;
+    int32_t target;              // End of the move in progress
+    float speed;                 // Estimated, steps/s
+    float acceleration;          // Configured limit, steps/s^2
+    float measuredAcceleration;  // Estimated, steps/s^2
+    bool running;
+    bool holdingTorque;
+    uint8_t queuedSegments;
+    uint32_t segmentsCompleted;
+    uint32_t segmentsRejected;
+    bool softLimits;
+    int32_t softMin;
+    int32_t softMax;
+};
+
+// Owns the StepperManager: every call into it happens in poll(), which only
+// the motion task runs. Other tasks post MotionCommands into a lock-free
+// mailbox and read the published MotionStatus, so they never block on (or
+// race with) the motor.
+//
+// Each producer context has its own single-producer lane. All AsyncWebServer
+// and WebSocket callbacks run on the async_tcp task and share PRODUCER_NETWORK;
+// PRODUCER_LOCAL belongs to the signals task.
+class MotionController
+{
+public:
+    enum Producer : uint8_t {
+        PRODUCER_NETWORK,
+        PRODUCER_LOCAL,
+        PRODUCER_COUNT
+    };
+
+    static const size_t QUEUE_CAPACITY = 32;
+
+    struct Stats {
+        size_t depth[PRODUCER_COUNT];
+        size_t highWater[PRODUCER_COUNT];
+        uint32_t overflows[PRODUCER_COUNT];
+        uint32_t processed;
+    };
+
+    MotionController(StepperManager& stepper);
+
+    // Producer side: never blocks; false when that producer's lane is full
+    bool post(Producer producer, const MotionCommand& command);
+
+    // Consumer side: act on limit switch stops, drain every lane, apply the
+    // commands, advance the segment queue and publish status.
+    // Run periodically by the motion task (see TaskScheduler in main.cpp).
+    void poll();
+
+    MotionStatus status() const;
+    Stats stats() const;
+
+private:
+    StepperManager& _stepper;
+    MotionPlanner _planner;
+    SpscQueue<MotionCommand, QUEUE_CAPACITY> _lanes[PRODUCER_COUNT];
+    std::atomic<uint32_t> _processed{0};
+
+    // Seqlock around _status: odd while the motion task is writing it
+    std::atomic<uint32_t> _statusSeq{0};
+    MotionStatus _status = {};
+
+    void execute(const MotionCommand& command);
+    void publishStatus();
+};
+
+#endif // MOTION_CONTROLLER_H
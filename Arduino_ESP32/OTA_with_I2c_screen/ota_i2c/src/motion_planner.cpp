@@ -0,0 +1,150 @@
+#include "motion_planner.h"
+#include <math.h>
+#include "logger.h"
+
+// Start braking this much travel time early, since update() only runs once
+// per motion tick
+static const float BRAKE_MARGIN_S = 0.002f;
+
+MotionPlanner::MotionPlanner(StepperManager& stepper) : _stepper(stepper) {}
+
+bool MotionPlanner::append(const MotionSegment& segment) {
+    if (_count >= CAPACITY) {
+        _rejected++;
+        return false;
+    }
+    if (_count == 0 && !_active) {
+        _segmentStart = _stepper.getCurrentPosition();
+    }
+
+    MotionSegment& added = _segments[slot(_count)];
+    added = segment;
+    if (added.speed <= 0) added.speed = _stepper.getMaxSpeed();
+    if (added.accel <= 0) added.accel = _stepper.getCurrentAcceleration();
+    _count++;
+    plan();
+
+    // Re-target the move in progress if the new segment extends it
+    if (_active) {
+        int32_t runEnd = findRunEnd();
+        if (runEnd != _runEnd) {
+            _runEnd = runEnd;
+            _stepper.moveToTrapezoid(_runEnd);
+        }
+    }
+    return true;
+}
+
+void MotionPlanner::clear() {
+    _head = 0;
+    _count = 0;
+    _braking = false;
+    if (_active) {
+        _active = false;
+        _stepper.restoreLimits();
+    }
+}
+
+int MotionPlanner::direction(uint8_t index) const {
+    int32_t start = index == 0 ? _segmentStart : _segments[slot(index - 1)].position;
+    int32_t end = _segments[slot(index)].position;
+    return end > start ? 1 : (end < start ? -1 : 0);
+}
+
+void MotionPlanner::plan() {
+    // Backward pass: the last segment ends at rest, and every earlier junction
+    // is limited by both neighbours' speeds and by how much speed the rest of
+    // the queue can shed before it has to stop
+    _exitSpeed[slot(_count - 1)] = 0;
+    for (int i = _count - 2; i >= 0; i--) {
+        float exit = 0;
+        int dir = direction(i);
+        if (_blending && dir != 0 && dir == direction(i + 1)) {
+            const MotionSegment& current = _segments[slot(i)];
+            const MotionSegment& next = _segments[slot(i + 1)];
+            float nextExit = _exitSpeed[slot(i + 1)];
+            float length = fabsf((float)next.position - (float)current.position);
+            exit = sqrtf(nextExit * nextExit + 2.0f * next.accel * length);
+            exit = fminf(exit, fminf(current.speed, next.speed));
+        }
+        _exitSpeed[slot(i)] = exit;
+    }
+}
+
+int32_t MotionPlanner::findRunEnd() const {
+    uint8_t i = 0;
+    while (i + 1 < _count && _exitSpeed[slot(i)] > 0) i++;
+    return _segments[slot(i)].position;
+}
+
+void MotionPlanner::startRun(int32_t position) {
+    _segmentStart = position;
+    _runEnd = findRunEnd();
+    _braking = false;
+    _active = true;
+    applyHeadLimits(_segments[slot(0)].speed);
+    _stepper.moveToTrapezoid(_runEnd);
+}
+
+void MotionPlanner::applyHeadLimits(float speed) {
+    _stepper.applyLimits(speed, _segments[slot(0)].accel);
+}
+
+void MotionPlanner::update() {
+    if (_count == 0) return;
+
+    int32_t position = _stepper.getCurrentPosition();
+    if (!_active) {
+        startRun(position);
+        return;
+    }
+    bool running = _stepper.isRunning();
+
+    // Retire every segment the motor has passed. A run only ends once the
+    // motor has come to rest on its last segment.
+    while (_count > 0) {
+        const MotionSegment& head = _segments[slot(0)];
+        int dir = direction(0);
+        bool runEnd = _exitSpeed[slot(0)] <= 0;
+        bool passed = dir > 0 ? position >= head.position : (dir < 0 ? position <= head.position : true);
+        if (!passed) {
+            if (!running) {
+                // Something else stopped the motor (stop command, limit switch)
+                LOG_INFO("Motion queue aborted at %ld with %u segments left", (long)position, _count);
+                clear();
+                return;
+            }
+            break;
+        }
+        if (runEnd && running) return;
+
+        _segmentStart = head.position;
+        _head = slot(1);
+        _count--;
+        _completed++;
+        _braking = false;
+        if (runEnd) {
+            _active = false;
+            if (_count == 0) {
+                _stepper.restoreLimits();
+            } else {
+                startRun(position);
+            }
+            return;
+        }
+        applyHeadLimits(_segments[slot(0)].speed);
+    }
+    if (_count == 0) return;
+
+    // Look-ahead: slow down in time to cross the next junction at its planned speed
+    const MotionSegment& head = _segments[slot(0)];
+    float exit = _exitSpeed[slot(0)];
+    if (!_braking && exit > 0 && exit < head.speed) {
+        float remaining = fabsf((float)head.position - (float)position);
+        float brakeDistance = (head.speed * head.speed - exit * exit) / (2.0f * head.accel);
+        if (remaining <= brakeDistance + head.speed * BRAKE_MARGIN_S) {
+            applyHeadLimits(exit);
+            _braking = true;
+        }
+    }
+}
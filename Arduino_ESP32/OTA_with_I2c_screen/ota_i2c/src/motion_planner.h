@@ -0,0 +1,63 @@
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+#include <Arduino.h>
+#include "stepper_manager.h"
+
+// One leg of a queued path: move to an absolute position at up to speed
+// (steps/s) with the given acceleration (steps/s^2); 0 uses the defaults.
+struct MotionSegment {
+    int32_t position;
+    float speed;
+    float accel;
+};
+
+// Bounded queue of segments executed back to back. With blending on,
+// consecutive segments in the same direction become one FastAccelStepper
+// move whose target is the end of the run, and the planner only changes the
+// speed limit at each junction, braking ahead of time (look-ahead over the
+// whole queue) where the next segment is slower. The motor therefore only
+// comes to rest where the direction reverses or the queue ends.
+// Not thread-safe: owned and updated by the motion task.
+class MotionPlanner
+{
+public:
+    static const uint8_t CAPACITY = 16;
+
+    MotionPlanner(StepperManager& stepper);
+
+    bool append(const MotionSegment& segment);  // false when the queue is full
+    void clear();                               // Drop queued segments; the caller stops the motor
+    void update();                              // Once per motion tick
+
+    void setBlending(bool enable) { _blending = enable; }
+    bool isBlending() const { return _blending; }
+    bool isActive() const { return _active; }
+    uint8_t size() const { return _count; }
+    uint32_t completed() const { return _completed; }
+    uint32_t rejected() const { return _rejected; }
+
+private:
+    StepperManager& _stepper;
+    MotionSegment _segments[CAPACITY];
+    float _exitSpeed[CAPACITY];   // Planned speed at the end of each slot's segment
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+    bool _blending = true;
+
+    bool _active = false;         // A move towards _runEnd is in progress
+    bool _braking = false;        // Head segment already slowed for its junction
+    int32_t _segmentStart = 0;    // Where the head segment began
+    int32_t _runEnd = 0;          // Target handed to the stepper
+    uint32_t _completed = 0;
+    uint32_t _rejected = 0;
+
+    uint8_t slot(uint8_t index) const { return (_head + index) % CAPACITY; }
+    int direction(uint8_t index) const;
+    int32_t findRunEnd() const;
+    void plan();
+    void startRun(int32_t position);
+    void applyHeadLimits(float speed);
+};
+
+#endif // MOTION_PLANNER_H
@@ -2,6 +2,7 @@
 #include <WiFiManager.h>
 #include <WiFi.h>
 #include <SPIFFS.h>
+#include "event_bus.h"
 
 class MyWiFiManager::Impl {
 public:
@@ -39,9 +40,7 @@ bool MyWiFiManager::autoConnect(const char* apName, const char* apPassword) {
     WiFi.mode(WIFI_AP);
     delay(1000);
     
-    if (apPassword) {
-        return pImpl->wm.autoConnect(apName, apPassword);
-    } else {
-        return pImpl->wm.autoConnect(apName);
-    }
+    bool connected = apPassword ? pImpl->wm.autoConnect(apName, apPassword) : pImpl->wm.autoConnect(apName);
+    EventBus::instance().publish(EventBus::WIFI_STATE, 0, connected);
+    return connected;
 } 
\ No newline at end of file
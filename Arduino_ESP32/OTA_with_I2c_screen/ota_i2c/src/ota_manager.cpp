@@ -1,5 +1,8 @@
 #include "ota_manager.h"
 #include <ArduinoOTA.h>
+#include "event_bus.h"
+#include "flash_controller.h"
+#include "position_memory.h"
 
 OTAManager::OTAManager(DisplayManager& display) : _display(display) {}
 
@@ -27,21 +30,33 @@ bool OTAManager::init(const char* hostname, const char* password) {
 
 void OTAManager::handle() { ArduinoOTA.handle(); }
 
-void OTAManager::onStart() { _display.displayText("OTA Update Start"); }
+void OTAManager::onStart() {
+    _lastPercent = -1;
+    EventBus::instance().publish(EventBus::OTA_PROGRESS, EventBus::OTA_START, 0);
+    _display.displayText("OTA Update Start");
+}
 
 void OTAManager::onProgress(unsigned int progress, unsigned int total) {
+    unsigned int percent = progress / (total / 100);
+    if ((int)percent == _lastPercent) return;  // Called per chunk; only report whole percents
+    _lastPercent = percent;
+    EventBus::instance().publish(EventBus::OTA_PROGRESS, EventBus::OTA_RUNNING, percent);
     char progressStr[32];
-    sprintf(progressStr, "Progress: %u%%", (progress / (total / 100)));
+    sprintf(progressStr, "Progress: %u%%", percent);
     _display.displayText(progressStr);
 }
 
 void OTAManager::onEnd() {
+    EventBus::instance().publish(EventBus::OTA_PROGRESS, EventBus::OTA_END, 100);
     _display.displayLines({"OTA Update Complete", "Gonna reset", "the device"});
+    PositionMemory::saveToFlash();  // The new image may keep its RTC memory elsewhere
+    FlashController::flush();  // Runs on the ota task
     delay(5000);
     ESP.restart();
 }
 
 void OTAManager::onError(ota_error_t error) {
+    EventBus::instance().publish(EventBus::OTA_PROGRESS, EventBus::OTA_ERROR, error);
     char errorStr[32];
     sprintf(errorStr, "Error[%u]: ", error);
     _display.displayText(errorStr);
@@ -15,6 +15,7 @@ public:
 private:
     DisplayManager& _display;
     bool _initialized = false;
+    int _lastPercent = -1;
     
     void onStart();
     void onProgress(unsigned int progress, unsigned int total);
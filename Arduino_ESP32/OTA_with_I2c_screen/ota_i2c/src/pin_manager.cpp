@@ -1,12 +1,40 @@
 #include "pin_manager.h"
 
-// Define the default configuration
-const PinManager::PinConfig PinManager::DEFAULT_CONFIG = {
-    .stepperStepPin = 12,    // Example default values
-    .stepperDirPin = 13,
-    .stepperEnablePin = 14,
-    .displaySdaPin = 21,     // ESP32 default I2C pins
-    .displaySclPin = 22,     // ESP32 default I2C pins
-    .displayResetPin = -1,   // Not used
-    .ledPin = 1             // Default LED pin
-};
+const PinManager::PinConfig PinManager::DEFAULT_CONFIG = ConfigSchema::DEFAULT_PINS;
+
+void PinManager::refresh() {
+    // Read the generation first: a change landing during the reload is picked up next time
+    uint32_t generation = FlashController::generation();
+    portENTER_CRITICAL(&_lock);
+    bool current = _loaded && _generation == generation;
+    portEXIT_CRITICAL(&_lock);
+    if (current) return;
+
+    PinConfig config;
+    if (!FlashController::readPinConfig(config)) {
+        LOG_WARN("Failed to read pin configuration, using defaults");
+        config = DEFAULT_CONFIG;
+    }
+    StaticJsonDocument<256> doc;
+    doc["stepperStepPin"] = config.stepperStepPin;
+    doc["stepperDirPin"] = config.stepperDirPin;
+    doc["stepperEnablePin"] = config.stepperEnablePin;
+    doc["displaySdaPin"] = config.displaySdaPin;
+    doc["displaySclPin"] = config.displaySclPin;
+    doc["displayResetPin"] = config.displayResetPin;
+    doc["ledPin"] = config.ledPin;
+    char json[JSON_SIZE];
+    size_t length = serializeJson(doc, json, sizeof(json));
+
+    portENTER_CRITICAL(&_lock);
+    _config = config;
+    memcpy(_json, json, length + 1);
+    _jsonLength = length;
+    _generation = generation;
+    _loaded = true;
+    _reloads++;
+    portEXIT_CRITICAL(&_lock);
+    LOG_INFO("PinManager: configuration loaded (generation %u): step %d, dir %d, enable %d, sda %d, scl %d, reset %d, led %d",
+             (unsigned)generation, config.stepperStepPin, config.stepperDirPin, config.stepperEnablePin,
+             config.displaySdaPin, config.displaySclPin, config.displayResetPin, config.ledPin);
+}
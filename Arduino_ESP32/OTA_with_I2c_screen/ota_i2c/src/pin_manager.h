@@ -4,66 +4,72 @@
 #include <ArduinoJson.h>
 #include "display_manager.h"
 #include "flash_controller.h"
+#include "logger.h"
 
+// The pin configuration is cached in RAM together with its JSON text. Both
+// are rebuilt only when FlashController::generation() shows that a stored
+// value changed (through saveConfig() or any other writer, such as the LED
+// pin page), so loadConfig() and getConfigJson() are copies.
 class PinManager {
 public:
     using PinConfig = FlashController::PinConfig;
 
     static const PinConfig DEFAULT_CONFIG;
+    static const size_t JSON_SIZE = 192;
 
     PinManager(DisplayManager& display) : display(display) {}
     
     bool init() {
-        Serial.println("PinManager::init() called");
-        return FlashController::init();
+        LOG_DEBUG("PinManager::init() called");
+        if (!FlashController::init()) return false;
+        refresh();
+        return true;
     }
     
     void saveConfig(const PinConfig& config) {
-        Serial.println("PinManager::saveConfig() called");
-        config.print();
+        LOG_DEBUG("PinManager::saveConfig() called");
         if (!FlashController::writePinConfig(config)) {
-            Serial.println("Failed to save pin configuration");
+            LOG_ERROR("Failed to save pin configuration");
         }
     }
     
     PinConfig loadConfig() {
-        Serial.println("PinManager::loadConfig() called");
-        PinConfig config;
-        if (!FlashController::readPinConfig(config)) {
-            Serial.println("Failed to read pin configuration, using defaults");
-            config = DEFAULT_CONFIG;
-            saveConfig(config);
-        }
-        config.print();
+        refresh();
+        portENTER_CRITICAL(&_lock);
+        PinConfig config = _config;
+        portEXIT_CRITICAL(&_lock);
         return config;
     }
     
     String getConfigJson() {
-        PinConfig config = loadConfig();
-        StaticJsonDocument<256> doc;
-        
-        doc["stepperStepPin"] = config.stepperStepPin;
-        doc["stepperDirPin"] = config.stepperDirPin;
-        doc["stepperEnablePin"] = config.stepperEnablePin;
-        doc["displaySdaPin"] = config.displaySdaPin;
-        doc["displaySclPin"] = config.displaySclPin;
-        doc["displayResetPin"] = config.displayResetPin;
-        doc["ledPin"] = config.ledPin;
-        
-        String output;
-        serializeJson(doc, output);
-        return output;
+        refresh();
+        char json[JSON_SIZE];
+        portENTER_CRITICAL(&_lock);
+        memcpy(json, _json, _jsonLength + 1);
+        portEXIT_CRITICAL(&_lock);
+        return String(json);
     }
+
+    uint32_t reloads() const { return _reloads; }  // Times the cache was rebuilt
     
     static bool validatePin(int8_t pin) {
         return pin > 0 && pin < 40;
     }
     
     void setDefaultConfig() {
-        Serial.println("Setting default pin configuration");
+        LOG_INFO("Setting default pin configuration");
         saveConfig(DEFAULT_CONFIG);
     }
 
 private:
     DisplayManager& display;
+    mutable portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;  // Guards the cache
+    bool _loaded = false;
+    uint32_t _generation = 0;
+    uint32_t _reloads = 0;
+    PinConfig _config = {};
+    char _json[JSON_SIZE] = "{}";
+    size_t _jsonLength = 2;
+
+    void refresh();  // Reloads the cache if the stored configuration changed
 }; 
\ No newline at end of file
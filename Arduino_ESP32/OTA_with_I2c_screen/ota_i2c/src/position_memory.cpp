@@ -0,0 +1,151 @@
+#include "position_memory.h"
+#include "config_store.h"
+#include "flash_controller.h"
+#include <stddef.h>
+
+namespace {
+    typedef ConfigSchema::PositionSection Section;
+
+    struct Record {
+        uint32_t magic;
+        PositionMemory::Snapshot snapshot;
+        uint32_t crc;  // Of magic and snapshot
+    };
+    const uint32_t RECORD_MAGIC = 0x31534F50;  // "POS1"
+
+    RTC_NOINIT_ATTR Record rtcRecord;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;  // Guards rtcRecord and homed
+    bool homed = false;
+    PositionMemory::Source restoredSource = PositionMemory::NONE;
+    PositionMemory::Snapshot restoredSnapshot;
+
+    uint32_t recordCrc(const Record& record) {
+        return ConfigStore::crc32(&record, offsetof(Record, crc));
+    }
+
+    bool sealed(const Record& record) {
+        return record.magic == RECORD_MAGIC && record.crc == recordCrc(record);
+    }
+
+    void seal(Record& record) {
+        record.magic = RECORD_MAGIC;
+        record.crc = recordCrc(record);
+    }
+}
+
+PositionMemory::Source PositionMemory::restore(Snapshot& snapshot) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    Source source = NONE;
+    memset(&snapshot, 0, sizeof(snapshot));
+
+    portENTER_CRITICAL(&lock);
+    Record record = rtcRecord;
+    portEXIT_CRITICAL(&lock);
+    if (trusts(reason) && sealed(record) && (record.snapshot.flags & Section::AT_REST)) {
+        snapshot = record.snapshot;
+        source = RTC;
+    }
+
+    // The flash copy belongs to the restart that follows the shutdown that wrote it
+    Snapshot stored;
+    if (FlashController::get<ConfigSchema::Position>(stored) && stored.flags) {
+        if (source == NONE && reason == ESP_RST_SW && (stored.flags & Section::AT_REST)) {
+            snapshot = stored;
+            source = FLASH;
+        }
+        Snapshot empty;
+        memset(&empty, 0, sizeof(empty));
+        if (!FlashController::set<ConfigSchema::Position>(empty) || !FlashController::flush()) {
+            Serial.println("PositionMemory: cannot clear the stored position");
+        }
+    }
+
+    portENTER_CRITICAL(&lock);
+    homed = source != NONE && (snapshot.flags & Section::HOMED);
+    if (source != NONE) {
+        rtcRecord.snapshot = snapshot;
+        seal(rtcRecord);
+    } else {
+        rtcRecord.magic = 0;  // Stale or never written
+    }
+    portEXIT_CRITICAL(&lock);
+    restoredSource = source;
+    restoredSnapshot = snapshot;
+
+    if (source == NONE) {
+        Serial.printf("PositionMemory: nothing restored (reset reason %d)\n", (int)reason);
+    } else {
+        Serial.printf("PositionMemory: position %ld%s from %s (reset reason %d)\n", (long)snapshot.position,
+                      (snapshot.flags & Section::HOMED) ? ", homed," : "", sourceName(source), (int)reason);
+    }
+    return source;
+}
+
+PositionMemory::Source PositionMemory::restored(Snapshot& snapshot) {
+    snapshot = restoredSnapshot;
+    return restoredSource;
+}
+
+void PositionMemory::atRest(int32_t position, bool softLimits, int32_t softMin, int32_t softMax) {
+    portENTER_CRITICAL(&lock);
+    Snapshot& snapshot = rtcRecord.snapshot;
+    snapshot.position = position;
+    snapshot.softMin = softLimits ? softMin : 0;
+    snapshot.softMax = softLimits ? softMax : 0;
+    snapshot.flags = Section::AT_REST | (homed ? Section::HOMED : 0) | (softLimits ? Section::SOFT_LIMITS : 0);
+    memset(snapshot.reserved, 0, sizeof(snapshot.reserved));
+    seal(rtcRecord);
+    portEXIT_CRITICAL(&lock);
+}
+
+void PositionMemory::moving() {
+    portENTER_CRITICAL(&lock);
+    rtcRecord.snapshot.flags &= ~Section::AT_REST;
+    seal(rtcRecord);
+    portEXIT_CRITICAL(&lock);
+}
+
+void PositionMemory::setHomed(bool value) {
+    portENTER_CRITICAL(&lock);
+    homed = value;
+    if (sealed(rtcRecord)) {
+        if (value) {
+            rtcRecord.snapshot.flags |= Section::HOMED;
+        } else {
+            rtcRecord.snapshot.flags &= ~Section::HOMED;
+        }
+        seal(rtcRecord);
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+bool PositionMemory::saveToFlash() {
+    portENTER_CRITICAL(&lock);
+    Record record = rtcRecord;
+    portEXIT_CRITICAL(&lock);
+    Snapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    if (sealed(record) && (record.snapshot.flags & Section::AT_REST)) snapshot = record.snapshot;
+    return FlashController::set<ConfigSchema::Position>(snapshot);
+}
+
+bool PositionMemory::trusts(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_SW:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char* PositionMemory::sourceName(Source source) {
+    switch (source) {
+        case RTC: return "RTC memory";
+        case FLASH: return "flash";
+        default: return "none";
+    }
+}
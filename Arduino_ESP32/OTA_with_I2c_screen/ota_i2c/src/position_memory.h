@@ -0,0 +1,57 @@
+#ifndef POSITION_MEMORY_H
+#define POSITION_MEMORY_H
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include "config_schema.h"
+
+// Where the motor last came to rest, whether that frame was homed and the
+// soft limits, kept across a reset so the axis can go back to work without
+// homing again.
+//
+// The snapshot lives in RTC slow memory (RTC_NOINIT_ATTR, 24 bytes with its
+// magic and CRC-32): StepperManager rewrites it whenever the motor comes to
+// rest somewhere new and clears its AT_REST flag before every move, so a
+// reset in the middle of a move leaves nothing to restore. A controlled
+// shutdown (OTA, WiFi reset, a failed init) also copies it into the settings
+// blob with saveToFlash(), because a new firmware image may place its RTC
+// variables elsewhere. The flash copy is used once, on the boot right after
+// it was written.
+//
+// restore() trusts a snapshot only when the reset cannot have moved the
+// axis behind the firmware's back: a software restart, a panic or a watchdog
+// reset (the step generator stops with the CPU and the motor was at rest).
+// Power-on, brownout (the driver supply dipped too) and the EN pin (someone
+// is at the machine) mean homing again.
+//
+// atRest() and moving() are for the motion task, setHomed() for the homing
+// sequence; all calls may be made from any task.
+class PositionMemory
+{
+public:
+    typedef ConfigSchema::PositionSection Snapshot;
+
+    enum Source : uint8_t {
+        NONE,   // Nothing trusted; home before production
+        RTC,
+        FLASH
+    };
+
+    // Once per boot, after FlashController::init(); consumes the flash copy
+    static Source restore(Snapshot& snapshot);
+    // What restore() returned, for init steps after the stepper's
+    static Source restored(Snapshot& snapshot);
+
+    static void atRest(int32_t position, bool softLimits, int32_t softMin, int32_t softMax);
+    static void moving();
+    static void setHomed(bool homed);
+
+    // Controlled shutdown: copies the snapshot into the settings (an empty
+    // one when the motor is moving); FlashController::flush() writes it
+    static bool saveToFlash();
+
+    static bool trusts(esp_reset_reason_t reason);
+    static const char* sourceName(Source source);
+};
+
+#endif // POSITION_MEMORY_H
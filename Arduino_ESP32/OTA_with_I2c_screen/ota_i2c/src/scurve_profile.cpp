@@ -0,0 +1,206 @@
+#include "scurve_profile.h"
+#include <math.h>
+
+// Longest tick count a single queue entry can hold
+static const uint32_t MAX_ENTRY_TICKS = 65535;
+
+namespace {
+
+// Velocity ramp from rest to cruiseSpeed with jerk limited to jerk and
+// acceleration limited to accel: jerk up, constant acceleration (only when
+// accel is reached), jerk down.
+struct Ramp {
+    float jerk, peakAccel;
+    float t1, t2;            // Duration of the jerk phases and of the constant-acceleration phase
+    float v1, x1, v2, x2;    // Speed and distance at the end of phase 1 and phase 2
+
+    Ramp(float speed, float accel, float j) : jerk(j) {
+        peakAccel = fminf(accel, sqrtf(speed * j));
+        t1 = peakAccel / j;
+        t2 = speed / peakAccel - t1;
+        if (t2 < 0) t2 = 0;
+        v1 = j * t1 * t1 / 2.0f;
+        x1 = j * t1 * t1 * t1 / 6.0f;
+        v2 = v1 + peakAccel * t2;
+        x2 = x1 + v1 * t2 + peakAccel * t2 * t2 / 2.0f;
+    }
+
+    float duration() const { return 2.0f * t1 + t2; }
+
+    float speed(float t) const {
+        if (t < t1) return jerk * t * t / 2.0f;
+        t -= t1;
+        if (t < t2) return v1 + peakAccel * t;
+        t -= t2;
+        return v2 + peakAccel * t - jerk * t * t / 2.0f;
+    }
+
+    float position(float t) const {
+        if (t < t1) return jerk * t * t * t / 6.0f;
+        t -= t1;
+        if (t < t2) return x1 + v1 * t + peakAccel * t * t / 2.0f;
+        t -= t2;
+        return x2 + v2 * t + peakAccel * t * t / 2.0f - jerk * t * t * t / 6.0f;
+    }
+
+    // Symmetric ramp, so the distance is the average speed times the duration
+    float distance(float speed) const { return speed * duration() / 2.0f; }
+};
+
+} // namespace
+
+bool SCurveProfile::plan(uint32_t steps, float maxSpeed, float acceleration, float jerk) {
+    _phase = DONE;
+    _index = 0;
+    _pauseTicks = 0;
+    if (steps == 0 || maxSpeed <= 0 || acceleration <= 0 || jerk <= 0) return false;
+
+    // Highest cruise speed whose two ramps fit in the move and whose ramp fits
+    // in the table; both only grow with the speed, so bisect
+    float speed = maxSpeed;
+    auto fits = [&](float v) {
+        float distance = Ramp(v, acceleration, jerk).distance(v);
+        return 2.0f * distance <= (float)steps && distance < (float)MAX_RAMP_STEPS;
+    };
+    if (!fits(speed)) {
+        float low = 0, high = speed;
+        for (int i = 0; i < 32; i++) {
+            float mid = (low + high) / 2.0f;
+            if (fits(mid)) low = mid; else high = mid;
+        }
+        speed = low;
+    }
+    // A move of a step or two barely ramps at all; still finish it within a second
+    if (speed < 1.0f) speed = 1.0f;
+
+    // Time of every whole step on the way up: Newton on the monotonic position
+    // curve from the previous step's time, falling back to bisection whenever
+    // a Newton step leaves the bracket
+    Ramp ramp(speed, acceleration, jerk);
+    float duration = ramp.duration();
+    uint32_t rampSteps = (uint32_t)ramp.distance(speed);
+    if (rampSteps > MAX_RAMP_STEPS) rampSteps = MAX_RAMP_STEPS;
+    if (2 * rampSteps > steps) rampSteps = steps / 2;
+
+    const float tolerance = 0.25f / TICKS_PER_S;
+    float previous = 0;
+    for (uint32_t k = 1; k <= rampSteps; k++) {
+        float low = previous, high = duration;
+        float t = k == 1 ? cbrtf(6.0f / jerk) : previous + 1.0f / ramp.speed(previous);
+        for (int i = 0; i < 40; i++) {
+            if (t <= low || t >= high) t = (low + high) / 2.0f;
+            float error = ramp.position(t) - (float)k;
+            if (error < 0) low = t; else high = t;
+            float v = ramp.speed(t);
+            float next = v > 0 ? t - error / v : (low + high) / 2.0f;
+            if (fabsf(next - t) < tolerance || high - low < tolerance) {
+                t = next;
+                break;
+            }
+            t = next;
+        }
+        if (t < previous) t = previous;
+        uint32_t ticks = (uint32_t)lroundf((t - previous) * TICKS_PER_S);
+        _intervals[k - 1] = ticks > 0 ? ticks : 1;
+        previous = t;
+    }
+
+    _rampSteps = rampSteps;
+    _cruiseSteps = steps - 2 * rampSteps;
+    _cruiseTicks = (uint32_t)lroundf(TICKS_PER_S / speed);
+    _cruiseSpeed = speed;
+    _phase = rampSteps > 0 ? ACCEL : CRUISE;
+    return true;
+}
+
+uint32_t SCurveProfile::phaseLength(Phase phase) const {
+    switch (phase) {
+    case ACCEL:
+    case DECEL:
+        return _rampSteps;
+    case CRUISE:
+        return _cruiseSteps;
+    default:
+        return 0;
+    }
+}
+
+uint32_t SCurveProfile::intervalAt(Phase phase, uint32_t index) const {
+    switch (phase) {
+    case ACCEL:
+        return _intervals[index];
+    case DECEL:
+        return _intervals[_rampSteps - 1 - index];
+    default:
+        return _cruiseTicks;
+    }
+}
+
+bool SCurveProfile::nextCommand(stepper_command_s& cmd) {
+    // Finish an interval that was too long for one entry with pauses, leaving
+    // the last pause long enough to be accepted
+    if (_pauseTicks > 0) {
+        uint32_t ticks = _pauseTicks;
+        if (ticks > MAX_ENTRY_TICKS) {
+            ticks = _pauseTicks - MIN_CMD_TICKS;
+            if (ticks > MAX_ENTRY_TICKS) ticks = MAX_ENTRY_TICKS;
+        }
+        _pauseTicks -= ticks;
+        cmd.ticks = (uint16_t)ticks;
+        cmd.steps = 0;
+        return true;
+    }
+
+    while (_phase != DONE && _index >= phaseLength(_phase)) {
+        _phase = (Phase)(_phase + 1);
+        _index = 0;
+    }
+    if (_phase == DONE) return false;
+
+    // Group steps until the entry lasts at least MIN_CMD_TICKS, at their
+    // average interval; never across a phase boundary
+    uint32_t left = phaseLength(_phase) - _index;
+    uint32_t total = 0;
+    uint32_t steps = 0;
+    while (steps < left && steps < 255 && total < MIN_CMD_TICKS) {
+        total += intervalAt(_phase, _index + steps);
+        steps++;
+    }
+    _index += steps;
+
+    uint32_t ticks = (total + steps / 2) / steps;
+    if (ticks > MAX_ENTRY_TICKS) {
+        // Only ever a single slow step
+        _pauseTicks = ticks - MAX_ENTRY_TICKS;
+        if (_pauseTicks < MIN_CMD_TICKS) {
+            _pauseTicks += MIN_CMD_TICKS;
+            ticks -= MIN_CMD_TICKS;
+        }
+        ticks = ticks > MAX_ENTRY_TICKS ? MAX_ENTRY_TICKS : ticks;
+    }
+    // A short group left at the end of a phase is stretched to the minimum
+    if (ticks * steps < MIN_CMD_TICKS) ticks = (MIN_CMD_TICKS + steps - 1) / steps;
+    cmd.ticks = (uint16_t)ticks;
+    cmd.steps = (uint8_t)steps;
+    return true;
+}
+
+void SCurveProfile::beginStop() {
+    _pauseTicks = 0;
+    if (_phase == ACCEL) {
+        // Mirror point: ramp down from the speed reached so far
+        _phase = DECEL;
+        _index = _rampSteps - _index;
+    } else if (_phase == CRUISE) {
+        _phase = DECEL;
+        _index = 0;
+    }
+}
+
+uint64_t SCurveProfile::totalTicks() const {
+    uint64_t total = (uint64_t)_cruiseTicks * _cruiseSteps;
+    for (uint16_t i = 0; i < _rampSteps; i++) {
+        total += 2ull * _intervals[i];
+    }
+    return total;
+}
@@ -0,0 +1,51 @@
+#ifndef SCURVE_PROFILE_H
+#define SCURVE_PROFILE_H
+
+#include <Arduino.h>
+#include <FastAccelStepper.h>
+
+// Jerk-limited (S-curve) point-to-point move expressed as step intervals in
+// step-timer ticks (TICKS_PER_S). plan() does all the floating-point work up
+// front and stores the acceleration ramp as a table; the deceleration is the
+// same table played backwards and the cruise is one constant interval.
+// nextCommand() then produces FastAccelStepper queue entries with integer
+// arithmetic only.
+class SCurveProfile
+{
+public:
+    static const uint16_t MAX_RAMP_STEPS = 2048;  // 8 KB of intervals
+
+    // False for an empty move. Lowers the cruise speed when the move is too
+    // short to reach maxSpeed, or when the ramp would not fit in the table.
+    bool plan(uint32_t steps, float maxSpeed, float acceleration, float jerk);
+
+    // Next queue entry (direction left to the caller); false when done
+    bool nextCommand(stepper_command_s& cmd);
+
+    // Skip to the deceleration ramp from the current speed
+    void beginStop();
+
+    bool isDone() const { return _phase == DONE; }
+    uint16_t rampSteps() const { return _rampSteps; }
+    uint32_t cruiseSteps() const { return _cruiseSteps; }
+    float cruiseSpeed() const { return _cruiseSpeed; }
+    uint64_t totalTicks() const;  // Planned duration of the whole move
+
+private:
+    enum Phase : uint8_t { ACCEL, CRUISE, DECEL, DONE };
+
+    uint32_t _intervals[MAX_RAMP_STEPS];  // Ticks from step i to step i+1 on the way up
+    uint16_t _rampSteps = 0;
+    uint32_t _cruiseSteps = 0;
+    uint32_t _cruiseTicks = 0;
+    float _cruiseSpeed = 0;
+
+    Phase _phase = DONE;
+    uint32_t _index = 0;           // Steps done in the current phase
+    uint32_t _pauseTicks = 0;      // Rest of an interval too long for one entry
+
+    uint32_t intervalAt(Phase phase, uint32_t index) const;
+    uint32_t phaseLength(Phase phase) const;
+};
+
+#endif // SCURVE_PROFILE_H
@@ -5,10 +5,31 @@
 #include "led_control.h"
 #include "memory_manager.h"
 #include "pin_manager.h"
+#include "position_memory.h"
 #include "my_wifi_manager.h"
+#include "task_scheduler.h"
+#include "web_ui.h"
 
-ServerManager::ServerManager(DisplayManager& display, StepperManager& stepper, PinManager& pinManager) 
-    : server(80), ws("/ws"), display(display), stepper(stepper), pinManager(pinManager) {}
+// Revalidation tag for the embedded UI: changes with every firmware build and
+// with every edit of web/index.html, so "no-cache" costs a 304 on repeat loads.
+static const char WEB_UI_ETAG[] = "\"" FIRMWARE_GIT_COMMIT_HASH "-" WEB_UI_CONTENT_HASH "\"";
+
+// Errors that mean "try again later" rather than "bad request"
+static const char MOTION_QUEUE_FULL[] = "Motion queue full";
+static const char SEGMENT_QUEUE_FULL[] = "Segment queue full";
+static const char HOMING_REFUSED[] = "Homing running or invalid settings";
+
+// A full segment batch with generous whitespace
+static const size_t MAX_QUEUE_BODY = 2048;
+
+ServerManager::ServerManager(DisplayManager& display, MotionController& motion, PinManager& pinManager, ControlSignalHandler& signals,
+                             HomingSequence& homing) 
+    : server(80), ws("/ws"), display(display), motion(motion), pinManager(pinManager), signals(signals), homing(homing) {}
+
+ServerManager::~ServerManager() {
+    EventBus::instance().unsubscribe(_events);
+    Logger::setSink(nullptr);
+}
 
 bool ServerManager::init() {
     try {
@@ -18,17 +39,24 @@ bool ServerManager::init() {
         });
         server.addHandler(&ws);
 
-        // Setup server routes
-        server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleRoot(request); });
-        server.on("/led", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleLedPage(request); });
-        server.on("/pins", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handlePinPage(request); });
-        server.on("/system", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleSystemPage(request); });
+        // Setup server routes - every page is the same pre-compressed UI, which picks its section from the path
+        server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleWebUi(request); });
+        server.on("/led", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleWebUi(request); });
+        server.on("/pins", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleWebUi(request); });
+        server.on("/system", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleWebUi(request); });
         
         // API endpoints
         server.on("/text", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleText(request); });
         server.on("/version", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleVersion(request); });
         server.on("/memory", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleMemoryStatus(request); });
         server.on("/debug", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleDebug(request); });
+        server.on("/tasks", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleTaskStats(request); });
+        server.on("/switches/edges", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleSwitchEdges(request); });
+        server.on("/switches", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleSwitches(request); });
+        server.on("/switches/action", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleSwitchAction(request); });
+        server.on("/homing", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleHoming(request); });
+        server.on("/homing/start", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleHomingStart(request); });
+        server.on("/homing/abort", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleHomingAbort(request); });
 
         // Stepper motor control endpoints
         server.on("/stepper/move", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleStepperMove(request); });
@@ -36,6 +64,18 @@ bool ServerManager::init() {
         server.on("/stepper/speed", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleStepperSpeed(request); });
         server.on("/stepper/accel", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleStepperAccel(request); });
         server.on("/stepper/torque", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleStepperTorque(request); });
+        server.on("/stepper/profile", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleStepperProfile(request); });
+        server.on("/stepper/queue", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleStepperQueue(request); }, nullptr,
+                  [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+                      this->handleStepperQueueBody(request, data, len, index, total);
+                  });
+        server.on("/stepper/queue", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleStepperQueueGet(request); });
+        server.on("/motion/stats", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleMotionStats(request); });
+        server.on("/events", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleEventStats(request); });
+        server.on("/display/mode", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleDisplayMode(request); });
+        server.on("/display", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleDisplayStats(request); });
+        server.on("/config/flush", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleConfigFlush(request); });
+        server.on("/config", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleConfigStats(request); });
 
         // LED control endpoints
         server.on("/led/pin", HTTP_POST, [this](AsyncWebServerRequest *request) { this->handleLedPinConfig(request); });
@@ -48,6 +88,16 @@ bool ServerManager::init() {
         // System endpoints
         server.on("/system/wifi/reset", HTTP_GET, [this](AsyncWebServerRequest *request) { this->handleWifiReset(request); });
 
+        // Switch changes and homing progress go out on /ws as they happen
+        _events = EventBus::instance().subscribe("websocket",
+                                                 EventBus::maskOf(EventBus::INPUT_CHANGED) |
+                                                     EventBus::maskOf(EventBus::LIMIT_HIT) |
+                                                     EventBus::maskOf(EventBus::HOMING_PHASE),
+                                                 [this](const EventBus::Event& event) { this->forwardEvent(event); });
+        Logger::setSink([this](Logger::Level level, const char* line, size_t length) {
+            this->forwardLog(level, line, length);
+        });
+
         server.begin();
         _initialized = true;
         return true;
@@ -58,95 +108,419 @@ bool ServerManager::init() {
 }
 
 void ServerManager::handleClient() {
-    // Broadcast status updates periodically
+    // Every client is served at its own rate; the snapshot (and the shared
+    // JSON text) is built at most once per call, and only if someone is due.
     unsigned long currentMillis = millis();
-    if (currentMillis - _lastStatusUpdate >= STATUS_UPDATE_INTERVAL) {
-        broadcastStatus();
-        _lastStatusUpdate = currentMillis;
+    TelemetrySnapshot snapshot;
+    bool captured = false;
+    char json[TelemetryEncoder::MAX_JSON_SIZE];
+    size_t jsonLen = 0;
+
+    for (auto& slot : _subscribers) {
+        portENTER_CRITICAL(&_subscribersLock);
+        TelemetrySubscriber sub = slot;
+        portEXIT_CRITICAL(&_subscribersLock);
+        if (sub.clientId == 0 || currentMillis - sub.lastSent < sub.intervalMs) continue;
+
+        AsyncWebSocketClient *client = ws.client(sub.clientId);
+        if (!client) {
+            sub.clientId = 0;
+        } else {
+            sub.lastSent = currentMillis;
+            if (client->canSend()) {  // Else drop this frame rather than queue behind a slow client
+                if (!captured) {
+                    snapshot = captureTelemetry();
+                    captured = true;
+                }
+                if (sub.binary) {
+                    sendBinaryTelemetry(client, sub, snapshot);
+                } else {
+                    if (jsonLen == 0) jsonLen = TelemetryEncoder::encodeJson(snapshot, json, sizeof(json));
+                    client->text(json, jsonLen);
+                }
+            }
+        }
+
+        // A reconnect or a format change made meanwhile wins over this frame's bookkeeping
+        portENTER_CRITICAL(&_subscribersLock);
+        if (slot.generation == sub.generation) slot = sub;
+        portEXIT_CRITICAL(&_subscribersLock);
+    }
+    EventBus::instance().dispatch(_events);
+}
+
+void ServerManager::forwardEvent(const EventBus::Event& event) {
+    if (event.type == EventBus::HOMING_PHASE) {
+        broadcastHomingProgress();
+        return;
+    }
+    if (ws.count() == 0) return;
+    StaticJsonDocument<128> doc;
+    doc["event"] = EventBus::typeName(event.type);
+    doc["id"] = event.name;
+    if (event.type == EventBus::INPUT_CHANGED) {
+        doc["active"] = event.value != 0;
+    } else {
+        doc["position"] = event.value;
+    }
+    char json[128];
+    size_t len = serializeJson(doc, json, sizeof(json));
+    ws.textAll(json, len);
+}
+
+void ServerManager::forwardLog(Logger::Level level, const char* line, size_t) {
+    uint32_t clientIds[MAX_WS_CLIENTS];
+    size_t count = 0;
+    portENTER_CRITICAL(&_subscribersLock);
+    for (const auto& sub : _subscribers) {
+        if (sub.clientId != 0 && sub.logs) clientIds[count++] = sub.clientId;
+    }
+    portEXIT_CRITICAL(&_subscribersLock);
+
+    char json[Logger::MESSAGE_SIZE * 2 + 64];  // Room for escapes
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        AsyncWebSocketClient *client = ws.client(clientIds[i]);
+        if (!client || !client->canSend()) continue;  // A slow client misses lines; the log task never waits
+        if (len == 0) {
+            StaticJsonDocument<96> doc;
+            doc["event"] = "log";
+            doc["level"] = Logger::levelName(level);
+            doc["text"] = line;  // Copied on serialisation only
+            len = serializeJson(doc, json, sizeof(json));
+        }
+        client->text(json, len);
+    }
+}
+
+void ServerManager::broadcastHomingProgress() {
+    HomingSequence::Status status = homing.status();
+    if (status.sequence == _homingSequence) return;
+    _homingSequence = status.sequence;
+    if (ws.count() == 0) return;
+    char json[384];
+    size_t len = encodeHomingStatus(status, json, sizeof(json));
+    ws.textAll(json, len);
+}
+
+size_t ServerManager::encodeHomingStatus(const HomingSequence::Status& status, char* out, size_t size) {
+    StaticJsonDocument<384> doc;
+    doc["event"] = "homing";
+    doc["phase"] = HomingSequence::phaseName(status.phase);
+    doc["homed"] = status.homed;
+    doc["elapsedMs"] = status.elapsedMs;
+    doc["travel"] = status.travel;
+    if (status.error) doc["error"] = status.error;
+    JsonObject phases = doc.createNestedObject("phaseMs");
+    for (int phase = HomingSequence::FAST_APPROACH; phase <= HomingSequence::RETURN; phase++) {
+        phases[HomingSequence::phaseName((HomingSequence::Phase)phase)] = status.phaseMs[phase];
+    }
+    return serializeJson(doc, out, size);
+}
+
+TelemetrySnapshot ServerManager::captureTelemetry() {
+    MotionStatus status = motion.status();
+    TelemetrySnapshot snapshot;
+    snapshot.position = status.position;
+    snapshot.speed = status.speed;
+    snapshot.acceleration = status.acceleration;
+    snapshot.flags = (status.running ? TelemetryEncoder::FLAG_RUNNING : 0) |
+                     (status.holdingTorque ? TelemetryEncoder::FLAG_HOLDING_TORQUE : 0);
+    snapshot.uptimeMs = millis();
+    snapshot.rssi = WiFi.RSSI();
+    snapshot.freeHeap = ESP.getFreeHeap();
+    return snapshot;
+}
+
+void ServerManager::sendBinaryTelemetry(AsyncWebSocketClient *client, TelemetrySubscriber& sub, const TelemetrySnapshot& snapshot) {
+    uint8_t frame[TelemetryEncoder::MAX_FRAME_SIZE];
+    size_t len;
+    if (sub.delta && !sub.needKeyframe && sub.sequence % TelemetryEncoder::KEYFRAME_INTERVAL != 0) {
+        len = TelemetryEncoder::encodeDelta(snapshot, sub.lastFrame, sub.sequence, frame);
+    } else {
+        len = TelemetryEncoder::encodeFull(snapshot, sub.sequence, frame);
+        sub.needKeyframe = false;
     }
+    sub.lastFrame = snapshot;
+    sub.sequence++;
+    client->binary(frame, len);
 }
 
 void ServerManager::broadcastStatus() {
     if (ws.count() == 0) return; // No clients connected
 
-    StaticJsonDocument<512> doc;
-    doc["position"] = stepper.getCurrentPosition();
-    doc["speed"] = stepper.getCurrentSpeed();
-    doc["acceleration"] = stepper.getCurrentAcceleration();
-    doc["isRunning"] = stepper.isRunning();
-    doc["holdingTorque"] = stepper.isHoldingTorqueEnabled();
-    doc["uptime"] = millis() / 1000;
-    doc["rssi"] = WiFi.RSSI();
-    doc["freeHeap"] = ESP.getFreeHeap();
+    char json[TelemetryEncoder::MAX_JSON_SIZE];
+    size_t len = TelemetryEncoder::encodeJson(captureTelemetry(), json, sizeof(json));
+    ws.textAll(json, len);
+}
+
+ServerManager::TelemetrySubscriber* ServerManager::findSubscriber(uint32_t clientId) {
+    for (auto& sub : _subscribers) {
+        if (sub.clientId == clientId) return &sub;
+    }
+    return nullptr;
+}
 
-    String jsonString;
-    serializeJson(doc, jsonString);
-    ws.textAll(jsonString);
+void ServerManager::addSubscriber(AsyncWebSocketClient *client) {
+    // New clients get the legacy JSON stream until they ask for something else
+    TelemetrySubscriber fresh = {};
+    fresh.clientId = client->id();
+    fresh.intervalMs = STATUS_UPDATE_INTERVAL;
+    fresh.lastSent = millis();
+    portENTER_CRITICAL(&_subscribersLock);
+    TelemetrySubscriber* sub = findSubscriber(0);
+    if (sub) {
+        fresh.generation = sub->generation + 1;
+        *sub = fresh;
+    }
+    portEXIT_CRITICAL(&_subscribersLock);
+    if (!sub) LOG_WARN("WebSocket client #%u: no telemetry slot free", client->id());
 }
 
 void ServerManager::onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
     switch (type) {
         case WS_EVT_CONNECT:
-            Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
+            LOG_INFO("WebSocket client #%u connected from %s", client->id(), client->remoteIP().toString().c_str());
+            addSubscriber(client);
             break;
-        case WS_EVT_DISCONNECT:
-            Serial.printf("WebSocket client #%u disconnected\n", client->id());
+        case WS_EVT_DISCONNECT: {
+            LOG_INFO("WebSocket client #%u disconnected", client->id());
+            portENTER_CRITICAL(&_subscribersLock);
+            TelemetrySubscriber* sub = findSubscriber(client->id());
+            if (sub) {
+                sub->clientId = 0;
+                sub->generation++;
+            }
+            portEXIT_CRITICAL(&_subscribersLock);
             break;
-        case WS_EVT_DATA:
-            // Handle incoming WebSocket data if needed
+        }
+        case WS_EVT_DATA: {
+            // Commands are small single-frame text messages; ignore fragments
+            AwsFrameInfo *info = (AwsFrameInfo*)arg;
+            if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                handleWebSocketMessage(client, data, len);
+            }
             break;
+        }
         case WS_EVT_PONG:
         case WS_EVT_ERROR:
             break;
     }
 }
 
-void ServerManager::handleText(AsyncWebServerRequest *request) {
-    if (request->hasParam("text", true)) {
-        String text = request->getParam("text", true)->value();
-        display.displayText(text.c_str());
-        request->send(200, "text/plain", "Text displayed: " + text);
+void ServerManager::handleWebSocketMessage(AsyncWebSocketClient *client, uint8_t *data, size_t len) {
+    StaticJsonDocument<1536> doc;  // Room for a full {"cmd":"queue"} batch
+    if (deserializeJson(doc, data, len)) {
+        client->text("{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+
+    const char* cmd = doc["cmd"] | "";
+    if (strcmp(cmd, "telemetry") == 0) {
+        handleTelemetryRequest(client, doc);
+        return;
+    }
+    if (strcmp(cmd, "log") == 0) {
+        handleLogRequest(client, doc);
+        return;
+    }
+
+    // Commands carrying an "id" are acknowledged; without one they are
+    // fire-and-forget, which suits sliders streaming many updates per second
+    const char* error = executeStepperCommand(cmd, doc);
+    if (doc.containsKey("id")) {
+        sendAck(client, doc["id"] | 0UL, error);
+    } else if (error) {
+        char out[96];
+        size_t outLen = snprintf(out, sizeof(out), "{\"error\":\"%s\"}", error);
+        client->text(out, outLen);
+    }
+}
+
+const char* ServerManager::executeStepperCommand(const char* cmd, JsonDocument& doc) {
+    bool queued;
+    if (strcmp(cmd, "move") == 0) {
+        if (!doc.containsKey("position")) return "Missing position";
+        long position = doc["position"];
+        queued = postMotion(MotionCommand::MOVE_TO, position);
+        if (queued) _targetPosition = position;
+    } else if (strcmp(cmd, "moveBy") == 0) {
+        if (!doc.containsKey("steps")) return "Missing steps";
+        long steps = doc["steps"];
+        queued = postMotion(MotionCommand::MOVE_BY, steps);
+        if (queued) _targetPosition += steps;
+    } else if (strcmp(cmd, "jog") == 0) {
+        int direction = doc["dir"] | 0;
+        if (direction == 0) return "Missing dir";
+        queued = postMotion(MotionCommand::JOG, direction);
+    } else if (strcmp(cmd, "jogStop") == 0 || strcmp(cmd, "stop") == 0) {
+        queued = postMotion(MotionCommand::STOP);
+    } else if (strcmp(cmd, "speed") == 0) {
+        if (!doc.containsKey("speed")) return "Missing speed";
+        queued = postMotion(MotionCommand::SET_SPEED, 0, doc["speed"]);
+    } else if (strcmp(cmd, "accel") == 0) {
+        if (!doc.containsKey("accel")) return "Missing accel";
+        queued = postMotion(MotionCommand::SET_ACCEL, 0, doc["accel"]);
+    } else if (strcmp(cmd, "torque") == 0) {
+        if (!doc.containsKey("enable")) return "Missing enable";
+        queued = postMotion(MotionCommand::SET_TORQUE, doc["enable"] ? 1 : 0);
+    } else if (strcmp(cmd, "profile") == 0) {
+        int mode = parseProfileMode(doc["mode"] | "");
+        if (mode < 0) return "Missing or unknown mode";
+        queued = postMotion(MotionCommand::SET_PROFILE, mode, doc["jerk"] | 0.0f);
+    } else if (strcmp(cmd, "home") == 0) {
+        return startHoming(doc);
+    } else if (strcmp(cmd, "homeAbort") == 0) {
+        homing.abort();
+        return nullptr;
+    } else if (strcmp(cmd, "queue") == 0) {
+        return queueSegments(doc);
+    } else if (strcmp(cmd, "display") == 0) {
+        return setDisplayMode(doc);
     } else {
-        request->send(400, "text/plain", "Missing 'text' parameter");
+        return "Unknown command";
     }
+    return queued ? nullptr : MOTION_QUEUE_FULL;
 }
 
-void ServerManager::handleRoot(AsyncWebServerRequest *request) {
-    String html = generateHeader();
-    html += "<h1>Stepper Motor Control</h1>";
-    html += generateStepperControlForms();
-    html += generateFooter();
-    request->send(200, "text/html", html);
+int ServerManager::parseProfileMode(const char* mode) {
+    if (strcmp(mode, "trapezoid") == 0) return StepperManager::PROFILE_TRAPEZOID;
+    if (strcmp(mode, "scurve") == 0) return StepperManager::PROFILE_SCURVE;
+    return -1;
 }
 
-void ServerManager::handleLedPage(AsyncWebServerRequest *request) {
-    String html = generateHeader();
-    html += "<h1>LED Control</h1>";
-    html += generateLedControlForms();
-    html += generateFooter();
-    request->send(200, "text/html", html);
+bool ServerManager::postMotion(MotionCommand::Type type, int32_t value, float real) {
+    // Every caller runs on the async_tcp task, the network lane's only producer
+    MotionCommand command = {type, value, real, 0.0f, 0};
+    return motion.post(MotionController::PRODUCER_NETWORK, command);
 }
 
-void ServerManager::handlePinPage(AsyncWebServerRequest *request) {
-    String html = generateHeader();
-    html += "<h1>Pin Configuration</h1>";
-    html += generatePinConfigForm();
-    html += generateFooter();
-    request->send(200, "text/html", html);
+const char* ServerManager::queueSegments(JsonDocument& doc) {
+    JsonArray segments = doc["segments"];
+    if (segments.isNull() || segments.size() == 0) return "Missing segments";
+    for (JsonObject segment : segments) {
+        if (!segment.containsKey("position")) return "Missing position";
+        if (!segment["position"].is<int32_t>()) return "Position out of range";
+    }
+
+    // Reject the whole batch up front rather than queue half of it. Commands
+    // still in the mailbox may be segments too, so count them as well.
+    MotionStatus status = motion.status();
+    size_t pending = motion.stats().depth[MotionController::PRODUCER_NETWORK];
+    if (segments.size() + status.queuedSegments + pending > MotionPlanner::CAPACITY) return SEGMENT_QUEUE_FULL;
+
+    if (doc.containsKey("blend") && !postMotion(MotionCommand::SET_BLENDING, doc["blend"] ? 1 : 0)) return MOTION_QUEUE_FULL;
+    for (JsonObject segment : segments) {
+        MotionCommand command = {MotionCommand::QUEUE_SEGMENT, segment["position"].as<int32_t>(),
+                                 segment["speed"] | 0.0f, segment["accel"] | 0.0f, 0};
+        if (!motion.post(MotionController::PRODUCER_NETWORK, command)) return MOTION_QUEUE_FULL;
+    }
+    return nullptr;
 }
 
-void ServerManager::handleSystemPage(AsyncWebServerRequest *request) {
-    String html = generateHeader();
-    html += "<h1>System Information</h1>";
-    html += "<div class='form-group'>";
-    html += "<h2>System Status</h2>";
-    html += "<p>Uptime: <span id='uptime'>0</span> seconds</p>";
-    html += "<p>WiFi Signal: <span id='rssi'>0</span> dBm</p>";
-    html += "<p>Free Heap: <span id='heap'>0</span> bytes</p>";
-    html += "</div>";
-    html += generateWifiControlForm();
-    html += generateFooter();
-    request->send(200, "text/html", html);
+const char* ServerManager::startHoming(JsonDocument& doc) {
+    HomingSequence::Settings settings = HomingSequence::defaults();
+    settings.fastSpeed = doc["fast"] | settings.fastSpeed;
+    settings.slowSpeed = doc["slow"] | settings.slowSpeed;
+    settings.backOffSteps = doc["backOff"] | settings.backOffSteps;
+    settings.margin = doc["margin"] | settings.margin;
+    settings.maxTravel = doc["maxTravel"] | settings.maxTravel;
+    settings.measureTravel = doc["measure"] | settings.measureTravel;
+    return homing.start(settings) ? nullptr : HOMING_REFUSED;
+}
+
+const char* ServerManager::setDisplayMode(JsonDocument& doc) {
+    int mode = DisplayManager::parseMode(doc["mode"] | "");
+    if (mode < 0 && !doc.containsKey("interval")) return "Missing or unknown mode";
+    if (doc.containsKey("interval")) display.setDashboardInterval(doc["interval"] | 0UL);
+    if (mode >= 0) display.setMode((DisplayManager::Mode)mode);
+    return nullptr;
+}
+
+void ServerManager::sendAck(AsyncWebSocketClient *client, unsigned long id, const char* error) {
+    char out[96];
+    size_t len;
+    if (error) {
+        len = snprintf(out, sizeof(out), "{\"ack\":%lu,\"ok\":false,\"error\":\"%s\"}", id, error);
+    } else {
+        len = snprintf(out, sizeof(out), "{\"ack\":%lu,\"ok\":true}", id);
+    }
+    client->text(out, len);
+}
+
+void ServerManager::handleTelemetryRequest(AsyncWebSocketClient *client, JsonDocument& doc) {
+    // {"cmd":"telemetry","format":"json"|"binary","rate":<Hz>,"delta":true|false}
+    long rate = doc["rate"] | 4;
+    rate = constrain(rate, 1, (long)MAX_TELEMETRY_RATE_HZ);
+    bool binary = strcmp(doc["format"] | "json", "binary") == 0;
+    bool delta = binary && (doc["delta"] | false);
+
+    // All fields change together, so the telemetry task never sees half a switch
+    portENTER_CRITICAL(&_subscribersLock);
+    TelemetrySubscriber* sub = findSubscriber(client->id());
+    if (sub) {
+        sub->binary = binary;
+        sub->delta = delta;
+        sub->intervalMs = 1000 / rate;
+        sub->needKeyframe = true;
+        sub->sequence = 0;
+        sub->generation++;
+    }
+    portEXIT_CRITICAL(&_subscribersLock);
+    if (!sub) {
+        client->text("{\"error\":\"No telemetry slot\"}");
+        return;
+    }
+
+    StaticJsonDocument<128> reply;
+    JsonObject telemetry = reply.createNestedObject("telemetry");
+    telemetry["format"] = binary ? "binary" : "json";
+    telemetry["rate"] = rate;
+    telemetry["delta"] = delta;
+    telemetry["version"] = (int)TelemetryEncoder::PROTOCOL_VERSION;
+    char out[128];
+    size_t outLen = serializeJson(reply, out, sizeof(out));
+    client->text(out, outLen);
+}
+
+void ServerManager::handleLogRequest(AsyncWebSocketClient *client, JsonDocument& doc) {
+    // {"cmd":"log","enable":true|false}
+    bool logs = doc["enable"] | true;
+    portENTER_CRITICAL(&_subscribersLock);
+    TelemetrySubscriber* sub = findSubscriber(client->id());
+    if (sub) {
+        sub->logs = logs;
+        sub->generation++;
+    }
+    portEXIT_CRITICAL(&_subscribersLock);
+    if (!sub) {
+        client->text("{\"error\":\"No telemetry slot\"}");
+        return;
+    }
+    client->text(logs ? "{\"log\":true}" : "{\"log\":false}");
+}
+
+void ServerManager::handleText(AsyncWebServerRequest *request) {
+    if (request->hasParam("text", true)) {
+        String text = request->getParam("text", true)->value();
+        display.displayText(text.c_str());
+        request->send(200, "text/plain", "Text displayed: " + text);
+    } else {
+        request->send(400, "text/plain", "Missing 'text' parameter");
+    }
+}
+
+void ServerManager::handleWebUi(AsyncWebServerRequest *request) {
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == WEB_UI_ETAG) {
+        response = request->beginResponse(304);
+    } else {
+        response = request->beginResponse_P(200, "text/html", WEB_UI_GZ, WEB_UI_GZ_LEN);
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", WEB_UI_ETAG);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
 }
 
 void ServerManager::handleMemoryStatus(AsyncWebServerRequest *request) {
@@ -169,9 +543,121 @@ void ServerManager::handleDebug(AsyncWebServerRequest *request) {
     debugInfo += "IP Address: " + WiFi.localIP().toString() + "\n";
     debugInfo += "MAC Address: " + WiFi.macAddress() + "\n";
     debugInfo += "RSSI: " + String(WiFi.RSSI()) + " dBm\n";
+    MotionStatus status = motion.status();
+    debugInfo += "Speed: " + String(status.speed, 1) + " steps/s\n";
+    debugInfo += "Acceleration: " + String(status.measuredAcceleration, 0) + " steps/s^2\n";
     request->send(200, "text/plain", debugInfo);
 }
 
+void ServerManager::handleTaskStats(AsyncWebServerRequest *request) {
+    request->send(200, "application/json", TaskScheduler::getStatsJson());
+    if (request->hasParam("reset")) {
+        TaskScheduler::resetStats();  // Start a fresh measurement window
+    }
+}
+
+void ServerManager::handleEventStats(AsyncWebServerRequest *request) {
+    request->send(200, "application/json", EventBus::instance().getStatsJson());
+}
+
+void ServerManager::handleDisplayStats(AsyncWebServerRequest *request) {
+    request->send(200, "application/json", display.getStatsJson());
+}
+
+void ServerManager::handleConfigStats(AsyncWebServerRequest *request) {
+    request->send(200, "application/json", FlashController::getStatsJson());
+}
+
+void ServerManager::handleConfigFlush(AsyncWebServerRequest *request) {
+    FlashController::requestFlush();  // Written by the ota task; never from here
+    request->send(202, "application/json", FlashController::getStatsJson());
+}
+
+void ServerManager::handleDisplayMode(AsyncWebServerRequest *request) {
+    // Same fields as the WebSocket "display" command, as form parameters
+    StaticJsonDocument<128> doc;
+    if (request->hasParam("mode", true)) doc["mode"] = request->getParam("mode", true)->value();
+    if (request->hasParam("interval", true)) doc["interval"] = request->getParam("interval", true)->value().toInt();
+    const char* error = setDisplayMode(doc);
+    if (error) {
+        sendJsonResponse(request, 400, false, error);
+        return;
+    }
+    sendJsonResponse(request, 200, true);
+}
+
+void ServerManager::handleHoming(AsyncWebServerRequest *request) {
+    char json[384];
+    encodeHomingStatus(homing.status(), json, sizeof(json));  // NUL-terminated; the response copies it
+    request->send(200, "application/json", String(json));
+}
+
+void ServerManager::handleHomingStart(AsyncWebServerRequest *request) {
+    // Same optional fields as the WebSocket "home" command, as form parameters
+    StaticJsonDocument<256> doc;
+    static const char* const FIELDS[] = {"fast", "slow", "backOff", "margin", "maxTravel"};
+    for (const char* field : FIELDS) {
+        if (request->hasParam(field, true)) doc[field] = request->getParam(field, true)->value().toFloat();
+    }
+    if (request->hasParam("measure", true)) doc["measure"] = request->getParam("measure", true)->value() != "false";
+    const char* error = startHoming(doc);
+    if (error) {
+        sendJsonResponse(request, 409, false, error);
+        return;
+    }
+    sendJsonResponse(request, 200, true);
+}
+
+void ServerManager::handleHomingAbort(AsyncWebServerRequest *request) {
+    homing.abort();
+    sendJsonResponse(request, 200, true);
+}
+
+void ServerManager::handleSwitchEdges(AsyncWebServerRequest *request) {
+    // Binary edge log (format in edge_log.h); ?since=<nextSequence of the last download>
+    uint32_t since = 0;
+    if (request->hasParam("since")) {
+        since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+    }
+    uint8_t* buffer = (uint8_t*)malloc(EdgeLog::MAX_ENCODED_SIZE);
+    if (!buffer) {
+        sendJsonResponse(request, 503, false, "Out of memory");
+        return;
+    }
+    size_t len = signals.edgeLog().encode(since, buffer, EdgeLog::MAX_ENCODED_SIZE);
+    AsyncResponseStream *response = request->beginResponseStream("application/octet-stream");
+    response->write(buffer, len);
+    free(buffer);
+    request->send(response);
+}
+
+void ServerManager::handleSwitches(AsyncWebServerRequest *request) {
+    request->send(200, "application/json", signals.getSwitchesJson());
+}
+
+void ServerManager::handleSwitchAction(AsyncWebServerRequest *request) {
+    if (!request->hasParam("id", true) || !request->hasParam("action", true)) {
+        sendJsonResponse(request, 400, false, "Missing id or action parameter");
+        return;
+    }
+    int action = ControlSignalHandler::parseAction(request->getParam("action", true)->value().c_str());
+    if (action < 0) {
+        sendJsonResponse(request, 400, false, "Unknown action");
+        return;
+    }
+    int direction = request->hasParam("direction", true) ? request->getParam("direction", true)->value().toInt() : 0;
+    if (action == LimitSwitch::ACTION_STOP_DIRECTION && direction == 0) {
+        sendJsonResponse(request, 400, false, "stopDirection needs a direction");
+        return;
+    }
+    if (!signals.setSwitchAction(request->getParam("id", true)->value().c_str(), (LimitSwitch::Action)action,
+                                 direction > 0 ? 1 : (direction < 0 ? -1 : 0))) {
+        sendJsonResponse(request, 404, false, "Unknown switch");
+        return;
+    }
+    sendJsonResponse(request, 200, true);
+}
+
 void ServerManager::sendJsonResponse(AsyncWebServerRequest *request, int code, bool success, const char* error) {
     StaticJsonDocument<128> doc;
     doc["success"] = success;
@@ -199,8 +685,11 @@ void ServerManager::sendJsonResponse(AsyncWebServerRequest *request, int code, b
 void ServerManager::handleStepperMove(AsyncWebServerRequest *request) {
     if (request->hasParam("position", true)) {
         long position = request->getParam("position", true)->value().toInt();
+        if (!postMotion(MotionCommand::MOVE_TO, position)) {
+            sendJsonResponse(request, 503, false, MOTION_QUEUE_FULL);
+            return;
+        }
         _targetPosition = position;  // Store the target position
-        stepper.moveTo(position);
         sendJsonResponse(request, 200, true, "targetPosition", position);
     } else {
         sendJsonResponse(request, 400, false, "Missing position parameter");
@@ -208,14 +697,20 @@ void ServerManager::handleStepperMove(AsyncWebServerRequest *request) {
 }
 
 void ServerManager::handleStepperStop(AsyncWebServerRequest *request) {
-    stepper.stop();
+    if (!postMotion(MotionCommand::STOP)) {
+        sendJsonResponse(request, 503, false, MOTION_QUEUE_FULL);
+        return;
+    }
     sendJsonResponse(request, 200, true);
 }
 
 void ServerManager::handleStepperSpeed(AsyncWebServerRequest *request) {
     if (request->hasParam("speed", true)) {
         float speed = request->getParam("speed", true)->value().toFloat();
-        stepper.setSpeed(speed);
+        if (!postMotion(MotionCommand::SET_SPEED, 0, speed)) {
+            sendJsonResponse(request, 503, false, MOTION_QUEUE_FULL);
+            return;
+        }
         sendJsonResponse(request, 200, true, "speed", speed);
     } else {
         sendJsonResponse(request, 400, false, "Missing speed parameter");
@@ -225,7 +720,10 @@ void ServerManager::handleStepperSpeed(AsyncWebServerRequest *request) {
 void ServerManager::handleStepperAccel(AsyncWebServerRequest *request) {
     if (request->hasParam("accel", true)) {
         float accel = request->getParam("accel", true)->value().toFloat();
-        stepper.setAcceleration(accel);
+        if (!postMotion(MotionCommand::SET_ACCEL, 0, accel)) {
+            sendJsonResponse(request, 503, false, MOTION_QUEUE_FULL);
+            return;
+        }
         sendJsonResponse(request, 200, true, "accel", accel);
     } else {
         sendJsonResponse(request, 400, false, "Missing accel parameter");
@@ -235,11 +733,89 @@ void ServerManager::handleStepperAccel(AsyncWebServerRequest *request) {
 void ServerManager::handleStepperTorque(AsyncWebServerRequest *request) {
     if (request->hasParam("enable", true)) {
         bool enable = request->getParam("enable", true)->value() == "true";
-        stepper.setHoldingTorque(enable);
+        if (!postMotion(MotionCommand::SET_TORQUE, enable ? 1 : 0)) {
+            sendJsonResponse(request, 503, false, MOTION_QUEUE_FULL);
+            return;
+        }
     }
     request->redirect("/");  // Always redirect back to main page
 }
 
+void ServerManager::handleStepperProfile(AsyncWebServerRequest *request) {
+    int mode = request->hasParam("mode", true) ? parseProfileMode(request->getParam("mode", true)->value().c_str()) : -1;
+    if (mode < 0) {
+        sendJsonResponse(request, 400, false, "Missing or unknown mode parameter");
+        return;
+    }
+    float jerk = request->hasParam("jerk", true) ? request->getParam("jerk", true)->value().toFloat() : 0.0f;
+    if (!postMotion(MotionCommand::SET_PROFILE, mode, jerk)) {
+        sendJsonResponse(request, 503, false, MOTION_QUEUE_FULL);
+        return;
+    }
+    sendJsonResponse(request, 200, true, "mode", request->getParam("mode", true)->value().c_str());
+}
+
+void ServerManager::handleStepperQueueBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    // The body may arrive in several chunks; collect it for handleStepperQueue()
+    if (total > MAX_QUEUE_BODY) return;
+    if (index == 0) request->_tempObject = malloc(total + 1);
+    char *body = (char*)request->_tempObject;
+    if (!body) return;
+    memcpy(body + index, data, len);
+    if (index + len == total) body[total] = '\0';
+}
+
+void ServerManager::handleStepperQueue(AsyncWebServerRequest *request) {
+    if (!request->_tempObject) {
+        sendJsonResponse(request, 400, false, "Missing or oversized JSON body");
+        return;
+    }
+    DynamicJsonDocument doc(MAX_QUEUE_BODY);
+    if (deserializeJson(doc, (const char*)request->_tempObject)) {
+        sendJsonResponse(request, 400, false, "Invalid JSON");
+        return;
+    }
+    const char* error = queueSegments(doc);
+    if (error) {
+        bool busy = error == MOTION_QUEUE_FULL || error == SEGMENT_QUEUE_FULL;
+        sendJsonResponse(request, busy ? 503 : 400, false, error);
+        return;
+    }
+    sendJsonResponse(request, 200, true, "queued", (int)doc["segments"].size());
+}
+
+void ServerManager::handleStepperQueueGet(AsyncWebServerRequest *request) {
+    MotionStatus status = motion.status();
+    StaticJsonDocument<192> doc;
+    doc["queued"] = status.queuedSegments;
+    doc["capacity"] = (int)MotionPlanner::CAPACITY;
+    doc["completed"] = status.segmentsCompleted;
+    doc["rejected"] = status.segmentsRejected;
+    doc["running"] = status.running;
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void ServerManager::handleMotionStats(AsyncWebServerRequest *request) {
+    static const char* const LANE_NAMES[MotionController::PRODUCER_COUNT] = {"network", "local"};
+    MotionController::Stats stats = motion.stats();
+
+    StaticJsonDocument<384> doc;
+    doc["capacity"] = (int)MotionController::QUEUE_CAPACITY;
+    doc["processed"] = stats.processed;
+    JsonObject lanes = doc.createNestedObject("lanes");
+    for (int i = 0; i < MotionController::PRODUCER_COUNT; i++) {
+        JsonObject lane = lanes.createNestedObject(LANE_NAMES[i]);
+        lane["depth"] = (unsigned long)stats.depth[i];
+        lane["highWater"] = (unsigned long)stats.highWater[i];
+        lane["overflows"] = stats.overflows[i];
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
 void ServerManager::handleLedPinConfig(AsyncWebServerRequest *request) {
     if (request->hasParam("pin", true)) {
         int newPin = request->getParam("pin", true)->value().toInt();
@@ -271,17 +847,26 @@ void ServerManager::handleWifiReset(AsyncWebServerRequest *request) {
     html += "<p>You will need to reconnect to the ESP32-Setup access point after the reset.</p>";
     html += "</body></html>";
     request->send(200, "text/html", html);
-    
-    // Give time for the response to be sent and received
-    delay(2000);
-    
+
+    // The reset writes flash and restarts; the ota task does it once the
+    // response has had time to go out (async_tcp only sends it after we return)
+    FlashController::requestFlush();
+    _wifiResetRequested = millis();
+    _wifiResetPending = true;
+}
+
+void ServerManager::serviceWifiReset() {
+    if (!_wifiResetPending || millis() - _wifiResetRequested < WIFI_RESET_DELAY_MS) return;
+    _wifiResetPending = false;
+
     // Now do the actual reset
     Serial.println("Starting WiFi reset...");
     MyWiFiManager::instance().resetSettings();
     Serial.println("WiFi reset complete, forcing restart...");
-    
-    // Final delay to ensure everything is complete
-    delay(2000);
+
+    // Settings and the resting position survive the restart
+    PositionMemory::saveToFlash();
+    FlashController::flush();
     
     // Force restart using multiple methods
     Serial.println("Forcing restart...");
@@ -344,164 +929,3 @@ void ServerManager::handlePinConfig(AsyncWebServerRequest *request) {
 void ServerManager::handlePinConfigGet(AsyncWebServerRequest *request) {
     request->send(200, "application/json", pinManager.getConfigJson());
 }
-
-String ServerManager::generateHeader() {
-    String html = "<html><head>";
-    html += "<title>ESP32 Stepper Motor Control</title>";
-    html += "<style>";
-    html += "  body { font-family: Arial, sans-serif; margin: 20px; }";
-    html += "  .nav { background-color: #f0f0f0; padding: 10px; margin-bottom: 20px; }";
-    html += "  .nav a { margin-right: 15px; text-decoration: none; color: #333; }";
-    html += "  .nav a:hover { color: #0066cc; }";
-    html += "  .status-value { font-weight: bold; }";
-    html += "  .speed-value { color: #0066cc; }";
-    html += "  .status-running { color: blue; }";
-    html += "  .status-stopped { color: green; }";
-    html += "  .form-group { margin-bottom: 15px; }";
-    html += "  .form-group label { display: block; margin-bottom: 5px; }";
-    html += "  .form-group input[type='number'] { width: 100px; }";
-    html += "</style>";
-    html += "<script>";
-    html += "let ws = new WebSocket('ws://' + window.location.hostname + '/ws');";
-    html += "ws.onmessage = function(event) {";
-    html += "  const data = JSON.parse(event.data);";
-    html += "  if (document.getElementById('current-position')) {";
-    html += "    document.getElementById('current-position').textContent = data.position;";
-    html += "    document.getElementById('speed').textContent = data.speed.toFixed(1);";
-    html += "    document.getElementById('accel').textContent = data.acceleration.toFixed(1);";
-    html += "    const statusElem = document.getElementById('status');";
-    html += "    statusElem.textContent = data.isRunning ? 'Running' : 'Stopped';";
-    html += "    statusElem.className = data.isRunning ? 'status-running' : 'status-stopped';";
-    html += "  }";
-    html += "  if (document.getElementById('uptime')) {";
-    html += "    document.getElementById('uptime').textContent = data.uptime;";
-    html += "    document.getElementById('rssi').textContent = data.rssi;";
-    html += "    document.getElementById('heap').textContent = data.freeHeap;";
-    html += "  }";
-    html += "};";
-    
-    // Add form submission handling
-    html += "function submitForm(form) {";
-    html += "  event.preventDefault();";
-    html += "  fetch(form.action, {";
-    html += "    method: form.method,";
-    html += "    body: new FormData(form)";
-    html += "  })";
-    html += "  .then(response => response.json())";
-    html += "  .then(data => {";
-    html += "    if (data.success) {";
-    html += "      if (data.targetPosition !== undefined) {";
-    html += "        document.getElementsByName('position')[0].value = data.targetPosition;";
-    html += "      }";
-    html += "      if (data.speed !== undefined) {";
-    html += "        document.getElementsByName('speed')[0].value = data.speed;";
-    html += "      }";
-    html += "      if (data.accel !== undefined) {";
-    html += "        document.getElementsByName('accel')[0].value = data.accel;";
-    html += "      }";
-    html += "    }";
-    html += "  });";
-    html += "  return false;";
-    html += "}";
-    html += "</script>";
-    html += "</head><body>";
-    html += "<div class='nav'>";
-    html += "<a href='/'>Stepper Control</a>";
-    html += "<a href='/led'>LED Control</a>";
-    html += "<a href='/pins'>Pin Configuration</a>";
-    html += "<a href='/system'>System Info</a>";
-    html += "</div>";
-    return html;
-}
-
-String ServerManager::generateStepperControlForms() {
-    String html = "<h2>Stepper Motor Control</h2>";
-    
-    // Status display
-    html += "<div class='form-group'>";
-    html += "<h3>Current Status</h3>";
-    html += "<p>Position: <span id='current-position' class='status-value'>" + String(stepper.getCurrentPosition()) + "</span> steps</p>";
-    html += "<p>Current Speed: <span id='speed' class='speed-value'>" + String(stepper.getCurrentSpeed(), 1) + "</span> steps/sec</p>";
-    html += "<p>Acceleration: <span id='accel' class='status-value'>" + String(stepper.getCurrentAcceleration(), 1) + "</span> steps/sec²</p>";
-    html += "<p>Microstepping: 1/" + String(stepper.getMicrosteps()) + " (800 steps/rev)</p>";
-    html += "<p>Status: <span id='status' class='" + String(stepper.isRunning() ? "status-running" : "status-stopped") + "'>" + String(stepper.isRunning() ? "Running" : "Stopped") + "</span></p>";
-    html += "</div>";
-    
-    // Move form
-    html += "<form action=\"/stepper/move\" method=\"POST\" onsubmit=\"return submitForm(this);\">";
-    html += "Target Position: <input name=\"position\" type=\"number\" value=\"" + String(stepper.getCurrentPosition()) + "\">";
-    html += "<button type=\"button\" onclick=\"document.getElementsByName('position')[0].value = parseInt(document.getElementsByName('position')[0].value) + 800\">+1 Rev</button>";
-    html += "<button type=\"button\" onclick=\"document.getElementsByName('position')[0].value = parseInt(document.getElementsByName('position')[0].value) - 800\">-1 Rev</button>";
-    html += "<input type=\"submit\" value=\"Move\">";
-    html += "</form>";
-
-    // Speed form
-    html += "<form action=\"/stepper/speed\" method=\"POST\" onsubmit=\"return submitForm(this);\">";
-    html += "Speed (steps/sec): <input name=\"speed\" type=\"number\" value=\"" + String(stepper.getCurrentSpeed()) + "\">";
-    html += "<button type=\"button\" onclick=\"document.getElementsByName('speed')[0].value = parseInt(document.getElementsByName('speed')[0].value) + 400\">+400</button>";
-    html += "<button type=\"button\" onclick=\"document.getElementsByName('speed')[0].value = parseInt(document.getElementsByName('speed')[0].value) - 400\">-400</button>";
-    html += "<input type=\"submit\" value=\"Set Speed\">";
-    html += "</form>";
-
-    // Acceleration form
-    html += "<form action=\"/stepper/accel\" method=\"POST\" onsubmit=\"return submitForm(this);\">";
-    html += "Acceleration (steps/sec²): <input name=\"accel\" type=\"number\" value=\"" + String(stepper.getCurrentAcceleration()) + "\">";
-    html += "<input type=\"submit\" value=\"Set Acceleration\">";
-    html += "</form>";
-
-    // Stop form
-    html += "<form action=\"/stepper/stop\" method=\"POST\" onsubmit=\"return submitForm(this);\">";
-    html += "<input type=\"submit\" value=\"Stop Motor\">";
-    html += "</form>";
-
-    // Holding Torque form
-    html += "<form action=\"/stepper/torque\" method=\"POST\">";
-    html += "<label>Holding Torque: <input type=\"checkbox\" name=\"enable\" value=\"true\" " + String(stepper.isHoldingTorqueEnabled() ? "checked" : "") + " onchange=\"this.form.submit()\">";
-    html += "<input type=\"hidden\" name=\"enable\" value=\"false\">";  // This will be sent when checkbox is unchecked
-    html += "</label></form>";
-
-    return html;
-}
-
-String ServerManager::generateLedControlForms() {
-    String html = "<h2>LED Configuration</h2>";
-    html += "<form action=\"/led/pin\" method=\"POST\">";
-    html += "LED Pin (1-39): <input name=\"pin\" type=\"number\" min=\"1\" max=\"39\" value=\"" + String(LedControl::getLedPin()) + "\">";
-    html += "<input type=\"submit\" value=\"Update LED Pin\">";
-    html += "</form>";
-    
-    html += "<h2>LED Test</h2>";
-    html += "<form action=\"/led/test\" method=\"GET\">";
-    html += "<input type=\"submit\" value=\"Test LED\">";
-    html += "</form>";
-    
-    return html;
-}
-
-String ServerManager::generatePinConfigForm() {
-    PinManager::PinConfig config = pinManager.loadConfig();
-    String html = "<h2>Pin Configuration</h2>";
-    html += "<form action='/pin-config' method='POST'>";
-    html += "<label>Stepper Step Pin: <input type='number' name='stepperStepPin' value='" + String(config.stepperStepPin) + "'></label><br>";
-    html += "<label>Stepper Direction Pin: <input type='number' name='stepperDirPin' value='" + String(config.stepperDirPin) + "'></label><br>";
-    html += "<label>Stepper Enable Pin: <input type='number' name='stepperEnablePin' value='" + String(config.stepperEnablePin) + "'></label><br>";
-    html += "<label>Display SDA Pin: <input type='number' name='displaySdaPin' value='" + String(config.displaySdaPin) + "'></label><br>";
-    html += "<label>Display SCL Pin: <input type='number' name='displaySclPin' value='" + String(config.displaySclPin) + "'></label><br>";
-    html += "<label>Display Reset Pin: <input type='number' name='displayResetPin' value='" + String(config.displayResetPin) + "'></label><br>";
-    html += "<label>LED Pin: <input type='number' name='ledPin' value='" + String(config.ledPin) + "'></label><br>";
-    html += "<input type='submit' value='Save Configuration'>";
-    html += "</form>";
-    return html;
-}
-
-String ServerManager::generateWifiControlForm() {
-    String html = "<h2>WiFi Configuration</h2>";
-    html += "<form action=\"/system/wifi/reset\" method=\"GET\">";
-    html += "<input type=\"submit\" value=\"Reset WiFi\" style=\"color: red;\">";
-    html += "</form>";
-    return html;
-}
-
-String ServerManager::generateFooter() {
-    return "</body></html>";
-} 
\ No newline at end of file
@@ -3,9 +3,14 @@
 
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
+#include "control_signal_handler.h"
 #include "display_manager.h"
-#include "stepper_manager.h"
+#include "event_bus.h"
+#include "logger.h"
+#include "homing_sequence.h"
+#include "motion_controller.h"
 #include "pin_manager.h"
+#include "telemetry_encoder.h"
 
 class ServerManager 
 {
@@ -21,15 +26,14 @@ public:
     // TODO: Add method to check if current config is valid before saving
     // TODO: Consider adding a way to backup/restore pin configuration
 
-    ServerManager(DisplayManager& display, StepperManager& stepper, PinManager& pinManager);
+    ServerManager(DisplayManager& display, MotionController& motion, PinManager& pinManager, ControlSignalHandler& signals,
+                  HomingSequence& homing);
+    ~ServerManager();
     bool init();
     bool isInitialized() const { return _initialized; }
     void handleClient();
     void handleText(AsyncWebServerRequest *request);
-    void handleRoot(AsyncWebServerRequest *request);
-    void handleLedPage(AsyncWebServerRequest *request);
-    void handlePinPage(AsyncWebServerRequest *request);
-    void handleSystemPage(AsyncWebServerRequest *request);
+    void handleWebUi(AsyncWebServerRequest *request);
     void handleMemoryStatus(AsyncWebServerRequest *request);
     void handleVersion(AsyncWebServerRequest *request);
     void handleDebug(AsyncWebServerRequest *request);
@@ -38,50 +42,114 @@ public:
     void handleStepperSpeed(AsyncWebServerRequest *request);
     void handleStepperAccel(AsyncWebServerRequest *request);
     void handleStepperTorque(AsyncWebServerRequest *request);
+    void handleStepperProfile(AsyncWebServerRequest *request);
+    void handleMotionStats(AsyncWebServerRequest *request);
+    void handleStepperQueue(AsyncWebServerRequest *request);
+    void handleStepperQueueBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+    void handleStepperQueueGet(AsyncWebServerRequest *request);
+    void handleTaskStats(AsyncWebServerRequest *request);
+    void handleSwitches(AsyncWebServerRequest *request);
+    void handleSwitchEdges(AsyncWebServerRequest *request);
+    void handleSwitchAction(AsyncWebServerRequest *request);
+    void handleEventStats(AsyncWebServerRequest *request);
+    void handleDisplayStats(AsyncWebServerRequest *request);
+    void handleDisplayMode(AsyncWebServerRequest *request);
+    void handleConfigStats(AsyncWebServerRequest *request);
+    void handleConfigFlush(AsyncWebServerRequest *request);
+    void handleHoming(AsyncWebServerRequest *request);
+    void handleHomingStart(AsyncWebServerRequest *request);
+    void handleHomingAbort(AsyncWebServerRequest *request);
     void handleLedTest(AsyncWebServerRequest *request);
     void handleLedPinConfig(AsyncWebServerRequest *request);
     void handleWifiReset(AsyncWebServerRequest *request);
+    void serviceWifiReset();  // ota task: carries out a reset handleWifiReset() accepted
     void handlePinConfig(AsyncWebServerRequest *request);
     void handlePinConfigGet(AsyncWebServerRequest *request);
     
     // WebSocket methods
-    void broadcastStatus();
+    void broadcastStatus();  // Legacy JSON status to every client, immediately
     void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
 
+#ifdef NATIVE_BUILD
+    // Host build only: let benchmarks drive routes and the WebSocket directly
+    bool dispatch(AsyncWebServerRequest& request, const uint8_t* body = nullptr, size_t len = 0) { return server.dispatch(request, body, len); }
+    AsyncWebSocket& webSocket() { return ws; }
+#endif
+
 private:
     AsyncWebServer server;
     AsyncWebSocket ws;
     DisplayManager& display;
-    StepperManager& stepper;
+    MotionController& motion;  // Stepper access goes through its mailbox only
     PinManager& pinManager;
+    ControlSignalHandler& signals;
+    HomingSequence& homing;
+    uint32_t _homingSequence = 0;  // Last homing phase change sent to /ws
+    EventBus::SubscriberId _events = -1;  // Dispatched by handleClient()
     bool _initialized = false;
     unsigned long _lastStatusUpdate = 0;
-    const unsigned long STATUS_UPDATE_INTERVAL = 250; // Update every 250ms
+    const unsigned long STATUS_UPDATE_INTERVAL = 250; // Default (legacy JSON) rate: every 250ms
+    static const uint8_t MAX_WS_CLIENTS = 8;
+    static const uint16_t MAX_TELEMETRY_RATE_HZ = 100;
+
+    // Per-client telemetry format and rate, negotiated with {"cmd":"telemetry",...}.
+    // async_tcp (connect, disconnect, requests), the telemetry task and the
+    // log task all use the slots: each works on a copy taken under
+    // _subscribersLock, and the telemetry task writes its progress back
+    // only if the slot's generation did not change in between.
+    struct TelemetrySubscriber {
+        uint32_t clientId;        // 0 marks a free slot
+        uint32_t generation;      // Bumped by every async_tcp change to the slot
+        bool binary;
+        bool delta;
+        bool needKeyframe;
+        bool logs;                // Log lines requested with {"cmd":"log"}
+        unsigned long intervalMs;
+        unsigned long lastSent;
+        uint16_t sequence;
+        TelemetrySnapshot lastFrame;
+    };
+    TelemetrySubscriber _subscribers[MAX_WS_CLIENTS] = {};
+    portMUX_TYPE _subscribersLock = portMUX_INITIALIZER_UNLOCKED;
     
     // WebSocket status tracking
     bool _wsConnected = false;
     unsigned long _lastWsReconnectAttempt = 0;
     const unsigned long WS_RECONNECT_INTERVAL = 5000; // Try to reconnect every 5 seconds
     
-    // Speed calculation variables
-    long _lastPosition = 0;
-    unsigned long _lastPositionTime = 0;
-    float _calculatedSpeed = 0.0f;
     long _targetPosition = 0;  // Track the last set target position
 
+    // Set by handleWifiReset() on async_tcp, carried out by serviceWifiReset()
+    volatile bool _wifiResetPending = false;
+    volatile unsigned long _wifiResetRequested = 0;
+    static const unsigned long WIFI_RESET_DELAY_MS = 2000;  // Lets the response reach the browser
+
+    // Telemetry helpers
+    TelemetrySnapshot captureTelemetry();
+    TelemetrySubscriber* findSubscriber(uint32_t clientId);  // Under _subscribersLock
+    void addSubscriber(AsyncWebSocketClient *client);
+    void sendBinaryTelemetry(AsyncWebSocketClient *client, TelemetrySubscriber& sub, const TelemetrySnapshot& snapshot);
+    void handleWebSocketMessage(AsyncWebSocketClient *client, uint8_t *data, size_t len);
+    void handleTelemetryRequest(AsyncWebSocketClient *client, JsonDocument& doc);
+    void handleLogRequest(AsyncWebSocketClient *client, JsonDocument& doc);
+
+    // WebSocket command channel: returns nullptr on success, else an error message
+    const char* executeStepperCommand(const char* cmd, JsonDocument& doc);
+    static int parseProfileMode(const char* mode);  // -1 when unknown
+    bool postMotion(MotionCommand::Type type, int32_t value = 0, float real = 0.0f);
+    const char* queueSegments(JsonDocument& doc);  // {"segments":[...],"blend":bool}, all or nothing
+    const char* startHoming(JsonDocument& doc);    // Settings fields are optional
+    const char* setDisplayMode(JsonDocument& doc); // {"mode":"messages"|"dashboard","interval":<ms>}
+    size_t encodeHomingStatus(const HomingSequence::Status& status, char* out, size_t size);
+    void broadcastHomingProgress();
+    void forwardEvent(const EventBus::Event& event);
+    void forwardLog(Logger::Level level, const char* line, size_t length);  // Logger sink, log task
+    void sendAck(AsyncWebSocketClient *client, unsigned long id, const char* error);
+
     // Helper methods
     void sendJsonResponse(AsyncWebServerRequest *request, int code, bool success, const char* error = nullptr);
     template<typename T>
     void sendJsonResponse(AsyncWebServerRequest *request, int code, bool success, const char* key, T value, const char* error = nullptr);
-
-    // HTML generation methods
-    String generateHeader();
-    String generateTextDisplayForm();
-    String generateStepperControlForms();
-    String generateLedControlForms();
-    String generateWifiControlForm();
-    String generatePinConfigForm();
-    String generateFooter();
 };
 
 #endif // SERVER_MANAGER_H 
\ No newline at end of file
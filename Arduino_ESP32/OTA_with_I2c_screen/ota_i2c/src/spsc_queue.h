@@ -0,0 +1,63 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+// Fixed-capacity, wait-free single-producer/single-consumer ring buffer.
+// Exactly one context may call push() and exactly one (other) context may
+// call pop(); neither ever blocks or allocates. Capacity must be a power of
+// two; all Capacity slots are usable.
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    // Producer side. Returns false (and drops nothing already queued) when full.
+    bool push(const T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= Capacity) {
+            _overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _items[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+
+        size_t depth = head + 1 - _tail.load(std::memory_order_relaxed);
+        if (depth > _highWater.load(std::memory_order_relaxed)) {
+            _highWater.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side.
+    bool pop(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        item = _items[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Safe to call from any context; the value may be stale by the time it is used.
+    // The tail is read first: the head read after it is never behind it, only
+    // possibly further ahead than the queue can hold by then.
+    size_t size() const {
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t count = _head.load(std::memory_order_acquire) - tail;
+        return count < Capacity ? count : Capacity;
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+    size_t highWater() const { return _highWater.load(std::memory_order_relaxed); }
+    uint32_t overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+    std::atomic<size_t> _highWater{0};
+    std::atomic<uint32_t> _overflows{0};
+};
+
+#endif // SPSC_QUEUE_H
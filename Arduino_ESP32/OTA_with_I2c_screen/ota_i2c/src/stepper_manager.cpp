@@ -1,6 +1,8 @@
 #include "stepper_manager.h"
 #include <FastAccelStepper.h>
 #include <Arduino.h>
+#include "logger.h"
+#include "position_memory.h"
 
 StepperManager::StepperManager(DisplayManager& display) :
     _display(display),
@@ -26,6 +28,17 @@ bool StepperManager::init() {
         // Set default speed and acceleration
         _stepper->setSpeedInHz(_currentSpeed);
         _stepper->setAcceleration(_currentAcceleration);
+
+        // Carry on from where the motor stood before the reset, if that can be trusted
+        PositionMemory::Snapshot snapshot;
+        if (PositionMemory::restore(snapshot) != PositionMemory::NONE) 
+        {
+            _stepper->setCurrentPosition(snapshot.position);
+            if (snapshot.flags & PositionMemory::Snapshot::SOFT_LIMITS) 
+            {
+                setSoftLimits(snapshot.softMin, snapshot.softMax);
+            }
+        }
         
         _display.displayText("Stepper initialized");
         return true;
@@ -39,17 +52,231 @@ bool StepperManager::init() {
 
 void StepperManager::moveTo(long position) 
 {
-    if (_stepper) 
+    if (!_stepper) return;
+    endSeek();
+    position = clampToSoftLimits(position);
+    if (_profileMode == PROFILE_SCURVE && !isRunning()) 
     {
-        _stepper->moveTo(position);
+        if (!refuseMove(position - _stepper->getCurrentPosition())) 
+        {
+            startSCurve(position);
+        }
+        return;
     }
+    moveToTrapezoid(position);
+}
+
+void StepperManager::moveToTrapezoid(long position) 
+{
+    if (!_stepper) return;
+    position = clampToSoftLimits(position);
+    if (refuseMove(position - _stepper->getCurrentPosition()) || refuseBusy()) return;
+    beginMove();
+    _stepper->moveTo(position);
+}
+
+void StepperManager::moveBy(long steps) 
+{
+    if (!_stepper) return;
+    endSeek();
+    if (_profileMode == PROFILE_TRAPEZOID && !_softLimitsEnabled) 
+    {
+        if (refuseMove(steps) || refuseBusy()) return;
+        beginMove();
+        _stepper->move(steps);
+        return;
+    }
+    // Relative to the move in progress, like FastAccelStepper's move()
+    bool retarget = !_scurveActive && _stepper->isRunning();
+    moveTo((retarget ? _stepper->targetPos() : _stepper->getCurrentPosition()) + steps);
+}
+
+void StepperManager::jog(int direction) 
+{
+    if (!_stepper || direction == 0) return;
+    endSeek();
+    if (_softLimitsEnabled) 
+    {
+        moveToTrapezoid(direction > 0 ? _softMax : _softMin);
+        return;
+    }
+    runContinuous(direction);
+}
+
+void StepperManager::seek(int direction, float speed) 
+{
+    if (!_stepper || direction == 0) return;
+    applyLimits(speed, _currentAcceleration);
+    _seeking = true;
+    runContinuous(direction);
+}
+
+void StepperManager::runContinuous(int direction) 
+{
+    if (refuseMove(direction) || refuseBusy()) return;
+    beginMove();
+    if (direction > 0) 
+    {
+        _stepper->runForward();
+    } 
+    else 
+    {
+        _stepper->runBackward();
+    }
+}
+
+void StepperManager::endSeek() 
+{
+    if (_seeking) 
+    {
+        restoreLimits();
+    }
+}
+
+void StepperManager::beginMove() 
+{
+    // Also before the first saveRest(): what init() restored says at rest too
+    PositionMemory::moving();
+    _restSaved = false;
 }
 
-void StepperManager::run() { /* FastAccelStepper handles running automatically */ }
+void StepperManager::saveRest() 
+{
+    long position = _stepper->getCurrentPosition();
+    if (_restSaved && position == _restPosition && _restSoftLimits == _softLimitsEnabled &&
+        _restSoftMin == _softMin && _restSoftMax == _softMax) return;
+    PositionMemory::atRest(position, _softLimitsEnabled, _softMin, _softMax);
+    _restSaved = true;
+    _restPosition = position;
+    _restSoftLimits = _softLimitsEnabled;
+    _restSoftMin = _softMin;
+    _restSoftMax = _softMax;
+}
+
+bool StepperManager::refuseBusy() 
+{
+    if (!_scurveActive) return false;
+    LOG_WARN("Stepper busy with an S-curve move");
+    return true;
+}
+
+long StepperManager::clampToSoftLimits(long position) 
+{
+    if (!_softLimitsEnabled) return position;
+    long clamped = position < _softMin ? _softMin : (position > _softMax ? _softMax : position);
+    if (clamped != position) 
+    {
+        LOG_INFO("Target %ld clamped to soft limit %ld", position, clamped);
+    }
+    return clamped;
+}
+
+void StepperManager::setCurrentPosition(long position) 
+{
+    if (!_stepper) return;
+    if (isRunning()) 
+    {
+        LOG_WARN("Cannot set the position while moving");
+        return;
+    }
+    _stepper->setCurrentPosition(position);
+    _velocity.reset();  // Old samples are in the old coordinates
+}
+
+void StepperManager::setSoftLimits(long minPosition, long maxPosition) 
+{
+    _softLimitsEnabled = minPosition < maxPosition;
+    _softMin = minPosition;
+    _softMax = maxPosition;
+}
+
+bool StepperManager::refuseMove(long direction) 
+{
+    if (direction == 0 || !isDirectionBlocked(direction)) return false;
+    LOG_WARN("Move %s refused: limit switch active", direction > 0 ? "forward" : "backward");
+    return true;
+}
+
+void StepperManager::run() 
+{
+    if (!_stepper) return;
+    // The position is the step interrupt's own count, so the fixed-rate
+    // samples are exact and only the timestamp carries task jitter
+    uint32_t now = micros();
+    int32_t position = _stepper->getCurrentPosition();
+    int32_t speed = _stepper->getCurrentSpeedInMilliHz() / 1000;
+    _velocity.addSample(now, position);
+    portENTER_CRITICAL(&_haltMux);
+    _sampleUs = now;
+    _samplePosition = position;
+    _sampleSpeed = speed;
+    portEXIT_CRITICAL(&_haltMux);
+
+    // FastAccelStepper runs trapezoid moves by itself
+    if (_scurveActive) 
+    {
+        feedSCurve();
+    }
+    else if (!_stepper->isRunning()) 
+    {
+        saveRest();  // Also catches SET_POSITION and soft limit changes
+    }
+}
+
+void StepperManager::startSCurve(long position) 
+{
+    if (!_stepper) return;
+    long distance = position - _stepper->getCurrentPosition();
+    if (distance == 0) return;
+    if (!_scurve.plan(distance > 0 ? distance : -distance, _currentSpeed, _currentAcceleration, _jerk)) 
+    {
+        LOG_WARN("S-curve: cannot plan move");
+        return;
+    }
+    _scurveForward = distance > 0;
+    _scurveTarget = position;
+    _hasPendingCommand = false;
+    beginMove();
+    _scurveActive = true;
+    feedSCurve();
+}
+
+void StepperManager::feedSCurve() 
+{
+    // Integer-only: the profile hands out precomputed intervals
+    while (!_stepper->isQueueFull()) 
+    {
+        if (!_hasPendingCommand) 
+        {
+            if (!_scurve.nextCommand(_pendingCommand)) break;
+            _pendingCommand.count_up = _scurveForward;
+            _hasPendingCommand = true;
+        }
+        int8_t result = _stepper->addQueueEntry(&_pendingCommand);
+        if (result > 0) return;  // Full, or the engine is busy (dir pin, enable pin): keep the entry for the next tick
+        _hasPendingCommand = false;
+        if (result < 0) 
+        {
+            // Let what is queued play out rather than leave a gap mid-move
+            LOG_WARN("S-curve: queue entry rejected (%d)", result);
+            _scurveActive = false;
+            return;
+        }
+    }
+    if (!_hasPendingCommand && _scurve.isDone() && _stepper->isQueueEmpty()) 
+    {
+        _scurveActive = false;
+    }
+}
 
 void StepperManager::stop() 
 {
-    if (_stepper) 
+    if (_scurveActive) 
+    {
+        _hasPendingCommand = false;
+        _scurve.beginStop();
+    } 
+    else if (_stepper) 
     {
         _stepper->stopMove();
     }
@@ -73,11 +300,32 @@ void StepperManager::setAcceleration(float acceleration)
     }
 }
 
+void StepperManager::applyLimits(float speed, float acceleration) 
+{
+    _seeking = false;
+    if (_stepper) 
+    {
+        _stepper->setSpeedInHz(speed);
+        _stepper->setAcceleration(acceleration);
+        _stepper->applySpeedAcceleration();
+    }
+}
+
+void StepperManager::restoreLimits() 
+{
+    applyLimits(_currentSpeed, _currentAcceleration);
+}
+
+float StepperManager::getMaxSpeed() const 
+{
+    return _currentSpeed;
+}
+
 bool StepperManager::isRunning() 
 {
     if (_stepper) 
     {
-        return _stepper->isRunning();
+        return _scurveActive || _stepper->isRunning();
     }
     return false;
 }
@@ -91,27 +339,21 @@ long StepperManager::getCurrentPosition()
     return 0;
 }
 
-float StepperManager::getCurrentSpeed() 
+long StepperManager::getTargetPosition() 
 {
-    if (!_stepper) return 0.0f;
+    if (!_stepper) return 0;
+    if (_scurveActive) return _scurveTarget;
+    return _stepper->isRunning() ? _stepper->targetPos() : _stepper->getCurrentPosition();
+}
 
-    // Get current position and time
-    long currentPosition = _stepper->getCurrentPosition();
-    unsigned long currentTime = millis();
-    
-    // Calculate speed if we have previous position data
-    if (_lastPositionTime > 0) {
-        float timeDelta = (currentTime - _lastPositionTime) / 1000.0f; // Convert to seconds
-        if (timeDelta > 0) {
-            _calculatedSpeed = (currentPosition - _lastPosition) / timeDelta; // steps per second
-        }
-    }
-    
-    // Update last position and time
-    _lastPosition = currentPosition;
-    _lastPositionTime = currentTime;
-    
-    return _calculatedSpeed;
+float StepperManager::getCurrentSpeed() const 
+{
+    return _velocity.speed();
+}
+
+float StepperManager::getMeasuredAcceleration() const 
+{
+    return _velocity.acceleration();
 }
 
 float StepperManager::getCurrentAcceleration() 
@@ -144,4 +386,119 @@ void StepperManager::setHoldingTorque(bool enable)
 bool StepperManager::isHoldingTorqueEnabled() const 
 {
     return _holdingTorqueEnabled;
+}
+
+uint32_t IRAM_ATTR StepperManager::requestHaltFromIsr(HaltRequest request, int direction) 
+{
+    // Plain RAM only: blockBit() and the stepper may be in flash
+    portENTER_CRITICAL_ISR(&_haltMux);
+    if (request == HALT_DIRECTION && direction != 0) 
+    {
+        _blockedDirections |= direction > 0 ? BLOCK_FORWARD : BLOCK_BACKWARD;
+    }
+    _haltRequests |= request;
+    uint32_t ticket = ++_haltTicket;
+    portEXIT_CRITICAL_ISR(&_haltMux);
+    return ticket;
+}
+
+int32_t IRAM_ATTR StepperManager::positionFromIsr(uint32_t atUs) 
+{
+    portENTER_CRITICAL_ISR(&_haltMux);
+    int32_t elapsed = (int32_t)(atUs - _sampleUs);
+    int32_t position = _samplePosition;
+    int32_t speed = _sampleSpeed;
+    portEXIT_CRITICAL_ISR(&_haltMux);
+    // A stalled motion task must not turn into a wild guess
+    if (elapsed > MAX_EXTRAPOLATION_US) elapsed = MAX_EXTRAPOLATION_US;
+    if (elapsed < -MAX_EXTRAPOLATION_US) elapsed = -MAX_EXTRAPOLATION_US;
+    int32_t travel = speed * elapsed;  // steps * 1e6, rounded to the nearest step
+    return position + (travel + (travel < 0 ? -500000 : 500000)) / 1000000;
+}
+
+bool StepperManager::serviceHalt() 
+{
+    if (!_stepper || !_haltRequests) return false;
+    portENTER_CRITICAL(&_haltMux);
+    uint8_t requests = _haltRequests;
+    uint32_t ticket = _haltTicket;
+    _haltRequests = 0;
+    portEXIT_CRITICAL(&_haltMux);
+
+    bool running = _scurveActive || _stepper->isRunning();
+    bool force = (requests & HALT_FORCE_STOP) != 0;
+    if (running && !force && (requests & HALT_DIRECTION)) 
+    {
+        int moving;
+        if (_scurveActive) 
+        {
+            moving = _scurveForward ? 1 : -1;
+        } 
+        else 
+        {
+            // Just started moves have no speed yet, so fall back to the target
+            int32_t speed = _stepper->getCurrentSpeedInMilliHz();
+            moving = speed != 0 ? speed : _stepper->targetPos() - _stepper->getCurrentPosition();
+        }
+        force = moving != 0 && isDirectionBlocked(moving);
+    }
+    if (force) 
+    {
+        _stepper->forceStop();
+        _scurveActive = false;
+        _hasPendingCommand = false;
+    } 
+    else if (requests & HALT_DECELERATE) 
+    {
+        stop();
+    } 
+    else 
+    {
+        running = false;
+    }
+
+    uint32_t actionUs = micros();
+    portENTER_CRITICAL(&_haltMux);
+    if (running) 
+    {
+        _haltFirstTicket = _haltDone + 1;
+        _haltLastTicket = ticket;
+        _haltActionUs = actionUs;
+    }
+    _haltDone = ticket;
+    portEXIT_CRITICAL(&_haltMux);
+    return running;
+}
+
+StepperManager::HaltOutcome StepperManager::getHaltOutcome(uint32_t ticket, uint32_t& actionUs) 
+{
+    portENTER_CRITICAL(&_haltMux);
+    bool done = (int32_t)(_haltDone - ticket) >= 0;
+    bool stopped = (int32_t)(ticket - _haltFirstTicket) >= 0 && (int32_t)(_haltLastTicket - ticket) >= 0;
+    actionUs = _haltActionUs;
+    portEXIT_CRITICAL(&_haltMux);
+    if (!done) return HALT_PENDING;
+    return stopped ? HALT_STOPPED : HALT_IGNORED;
+}
+
+void StepperManager::unblockDirection(int direction) 
+{
+    if (direction == 0) return;
+    portENTER_CRITICAL(&_haltMux);
+    _blockedDirections &= ~blockBit(direction);
+    portEXIT_CRITICAL(&_haltMux);
+}
+
+bool StepperManager::isDirectionBlocked(int direction) const 
+{
+    return direction != 0 && (_blockedDirections & blockBit(direction)) != 0;
+}
+
+void StepperManager::setProfile(ProfileMode mode, float jerk) 
+{
+    _profileMode = mode;
+    if (jerk > 0) 
+    {
+        _jerk = jerk;
+    }
 } 
\ No newline at end of file
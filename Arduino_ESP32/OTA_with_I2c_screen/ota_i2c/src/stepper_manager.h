@@ -3,24 +3,84 @@
 
 #include <FastAccelStepper.h>
 #include "display_manager.h"
+#include "scurve_profile.h"
+#include "velocity_estimator.h"
 
 class StepperManager 
 {
 public:
+    enum ProfileMode : uint8_t {
+        PROFILE_TRAPEZOID,  // FastAccelStepper's own ramp generator
+        PROFILE_SCURVE      // Jerk-limited, fed into the raw command queue by run()
+    };
+
     StepperManager(DisplayManager& display);
     bool init();
     void moveTo(long position);
+    void moveToTrapezoid(long position);  // Always the ramp generator (segment planner)
+    void moveBy(long steps);
+    void jog(int direction);  // Run continuously forward (>0) or backward (<0) until stop(), or to a soft limit
+    // Run towards direction at speed regardless of soft limits (homing); the
+    // next moveTo/moveBy/jog goes back to the configured speed
+    void seek(int direction, float speed);
+    // Once per motion tick: samples the position for the velocity estimate and
+    // keeps an S-curve move's queue filled
     void run();
     void stop();
     void setSpeed(float speed);
     void setAcceleration(float acceleration);
+    // Change speed/acceleration of the move in progress without touching the
+    // configured defaults; restoreLimits() goes back to them
+    void applyLimits(float speed, float acceleration);
+    void restoreLimits();
+    float getMaxSpeed() const;
     bool isRunning();
     long getCurrentPosition();
-    float getCurrentSpeed();
+    long getTargetPosition();              // Where the move in progress ends; the position when at rest
+    float getCurrentSpeed() const;         // Estimated from the samples taken in run()
+    float getMeasuredAcceleration() const;
     float getCurrentAcceleration();
     int getMicrosteps();
     void setHoldingTorque(bool enable);
     bool isHoldingTorqueEnabled() const;
+    // S-curve moves start from rest; while one runs, other moves are refused
+    // and stop() ramps it down along the same curve
+    void setProfile(ProfileMode mode, float jerk);
+    ProfileMode getProfileMode() const { return _profileMode; }
+    float getJerk() const { return _jerk; }
+
+    // Only while stopped, e.g. to make a homing reference position 0
+    void setCurrentPosition(long position);
+    // Targets outside [min, max] are clamped; min >= max turns the limits off
+    void setSoftLimits(long minPosition, long maxPosition);
+    bool hasSoftLimits() const { return _softLimitsEnabled; }
+    long getSoftMin() const { return _softMin; }
+    long getSoftMax() const { return _softMax; }
+
+    // Limit switch interrupt path. The FastAccelStepper calls are not in
+    // IRAM, so the ISR only latches a request; serviceHalt() carries it out
+    // on the next motion tick, at most one period after the edge.
+    // direction is the side a switch guards (>0 forward, <0 backward).
+    enum HaltRequest : uint8_t {
+        HALT_FORCE_STOP = 0x01,     // Stop at once, without a ramp
+        HALT_DECELERATE = 0x02,     // Ramp down (an S-curve move along its own curve)
+        HALT_DIRECTION = 0x04       // Block direction; force stop a move towards it
+    };
+    enum HaltOutcome : uint8_t {
+        HALT_PENDING,               // Not acted on yet
+        HALT_STOPPED,               // The motor was running and has been told to stop
+        HALT_IGNORED                // The motor was at rest or moving away
+    };
+    // Returns a ticket for getHaltOutcome()
+    uint32_t IRAM_ATTR requestHaltFromIsr(HaltRequest request, int direction = 0);
+    // Extrapolated from the position and speed run() sampled last
+    int32_t IRAM_ATTR positionFromIsr(uint32_t atUs);
+    // Motion task, before run(); true if it stopped a running motor
+    bool serviceHalt();
+    // actionUs is the micros() at which the step engine was told
+    HaltOutcome getHaltOutcome(uint32_t ticket, uint32_t& actionUs);
+    void unblockDirection(int direction);                 // Once the switch is released
+    bool isDirectionBlocked(int direction) const;
 
 private:
     DisplayManager& _display;
@@ -32,12 +92,57 @@ private:
     static const int MICROSTEPS = 4;   // 1/4 microstepping (800 steps/rev)
     float _currentSpeed;               // Target speed
     float _currentAcceleration;        // Current acceleration
-    
-    // Speed calculation variables
-    long _lastPosition = 0;
-    unsigned long _lastPositionTime = 0;
-    float _calculatedSpeed = 0.0f;
+    VelocityEstimator _velocity;
     bool _holdingTorqueEnabled = false;
+
+    ProfileMode _profileMode = PROFILE_TRAPEZOID;
+    float _jerk = 2000000;             // steps/s^3
+    SCurveProfile _scurve;
+    bool _scurveActive = false;        // Entries still to queue or playing
+    bool _scurveForward = true;
+    long _scurveTarget = 0;
+    bool _hasPendingCommand = false;   // _pendingCommand did not fit in the queue yet
+    stepper_command_s _pendingCommand;
+
+    // Latched by the limit switch ISR; acted on by serviceHalt()
+    portMUX_TYPE _haltMux = portMUX_INITIALIZER_UNLOCKED;
+    volatile uint8_t _haltRequests = 0;        // HaltRequest bits
+    volatile uint32_t _haltTicket = 0;         // Requests latched so far
+    uint32_t _haltDone = 0;                    // Requests acted on so far
+    uint32_t _haltFirstTicket = 0;             // Requests covered by the last stop of a running motor
+    uint32_t _haltLastTicket = 0;
+    uint32_t _haltActionUs = 0;
+    volatile uint8_t _blockedDirections = 0;   // BLOCK_FORWARD | BLOCK_BACKWARD
+    // Last position sample of run(), for positionFromIsr()
+    uint32_t _sampleUs = 0;
+    int32_t _samplePosition = 0;
+    int32_t _sampleSpeed = 0;                  // steps/s
+    static const int32_t MAX_EXTRAPOLATION_US = 4000;
+    static const uint8_t BLOCK_FORWARD = 0x01;
+    static const uint8_t BLOCK_BACKWARD = 0x02;
+
+    // Last snapshot given to PositionMemory; cleared by every move
+    bool _restSaved = false;
+    long _restPosition = 0;
+    bool _restSoftLimits = false;
+    long _restSoftMin = 0;
+    long _restSoftMax = 0;
+
+    bool _seeking = false;             // seek() lowered the speed limit
+    bool _softLimitsEnabled = false;
+    long _softMin = 0;
+    long _softMax = 0;
+
+    static uint8_t blockBit(int direction) { return direction > 0 ? BLOCK_FORWARD : BLOCK_BACKWARD; }
+    bool refuseMove(long direction);
+    bool refuseBusy();
+    long clampToSoftLimits(long position);
+    void runContinuous(int direction);
+    void endSeek();
+    void beginMove();   // Before the step engine is started
+    void saveRest();    // From run(), with the motor stopped
+    void startSCurve(long position);
+    void feedSCurve();
 };
 
 #endif // STEPPER_MANAGER_H 
\ No newline at end of file
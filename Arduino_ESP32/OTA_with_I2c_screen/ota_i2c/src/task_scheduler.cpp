@@ -0,0 +1,114 @@
+#include "task_scheduler.h"
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+
+TaskScheduler::Task TaskScheduler::_tasks[TaskScheduler::MAX_TASKS];
+uint8_t TaskScheduler::_count = 0;
+bool TaskScheduler::_started = false;
+
+bool TaskScheduler::add(const TaskConfig& config, TaskBody body) {
+    if (_started || _count >= MAX_TASKS || config.periodMs == 0 || !body) {
+        Serial.printf("TaskScheduler: cannot add task %s\n", config.name);
+        return false;
+    }
+    Task& task = _tasks[_count++];
+    task.config = config;
+    task.body = body;
+    task.handle = nullptr;
+    task.resetRequested = false;
+    task.stats = {};
+    return true;
+}
+
+bool TaskScheduler::start() {
+    if (_started) return false;
+    for (uint8_t i = 0; i < _count; i++) {
+        Task& task = _tasks[i];
+        if (xTaskCreatePinnedToCore(taskEntry, task.config.name, task.config.stackSize, &task,
+                                    task.config.priority, &task.handle, task.config.core) != pdPASS) {
+            Serial.printf("TaskScheduler: failed to start task %s\n", task.config.name);
+            return false;
+        }
+        Serial.printf("TaskScheduler: %s every %u ms, priority %u, core %d\n", task.config.name,
+                      (unsigned)task.config.periodMs, (unsigned)task.config.priority, (int)task.config.core);
+    }
+    _started = true;
+    return true;
+}
+
+void TaskScheduler::resetStats() {
+    // Each task clears its own counters so the stats keep a single writer
+    for (uint8_t i = 0; i < _count; i++) {
+        _tasks[i].resetRequested = true;
+    }
+}
+
+void TaskScheduler::taskEntry(void* arg) {
+    Task& task = *static_cast<Task*>(arg);
+    const TickType_t period = pdMS_TO_TICKS(task.config.periodMs);
+    const int64_t periodUs = (int64_t)task.config.periodMs * 1000;
+    TickType_t lastWake = xTaskGetTickCount();
+    int64_t lastStart = -1;
+
+    for (;;) {
+        int64_t start = esp_timer_get_time();
+        task.body();
+        int64_t end = esp_timer_get_time();
+
+        // Period jitter: how far the time between two releases strayed from the period
+        int64_t jitter = lastStart < 0 ? 0 : start - lastStart - periodUs;
+        lastStart = start;
+        record(task, (uint32_t)(jitter < 0 ? -jitter : jitter), (uint32_t)(end - start));
+
+        vTaskDelayUntil(&lastWake, period);
+    }
+}
+
+void TaskScheduler::record(Task& task, uint32_t jitterUs, uint32_t execUs) {
+    TaskStats& stats = task.stats;
+    if (task.resetRequested) {
+        task.resetRequested = false;
+        stats = {};
+    }
+    stats.runs++;
+    stats.lastJitterUs = jitterUs;
+    stats.lastExecUs = execUs;
+    stats.totalJitterUs += jitterUs;
+    stats.totalExecUs += execUs;
+    if (jitterUs > stats.maxJitterUs) stats.maxJitterUs = jitterUs;
+    if (execUs > stats.maxExecUs) stats.maxExecUs = execUs;
+    if (execUs > task.config.periodMs * 1000) stats.overruns++;
+}
+
+String TaskScheduler::getStatsJson() {
+    DynamicJsonDocument doc(256 + _count * 256);
+    JsonArray tasks = doc.createNestedArray("tasks");
+    for (uint8_t i = 0; i < _count; i++) {
+        const TaskConfig& config = _tasks[i].config;
+        TaskStats stats = _tasks[i].stats;
+        JsonObject task = tasks.createNestedObject();
+        task["name"] = config.name;
+        task["periodMs"] = config.periodMs;
+        task["priority"] = (unsigned)config.priority;
+        task["core"] = (int)config.core;
+        task["runs"] = stats.runs;
+        task["overruns"] = stats.overruns;
+        task["jitterMaxUs"] = stats.maxJitterUs;
+        task["jitterAvgUs"] = stats.runs ? (uint32_t)(stats.totalJitterUs / stats.runs) : 0;
+        task["execMaxUs"] = stats.maxExecUs;
+        task["execAvgUs"] = stats.runs ? (uint32_t)(stats.totalExecUs / stats.runs) : 0;
+    }
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
+
+#ifdef NATIVE_BUILD
+void TaskScheduler::reset() {
+    for (uint8_t i = 0; i < _count; i++) {
+        _tasks[i] = Task();
+    }
+    _count = 0;
+    _started = false;
+}
+#endif
@@ -0,0 +1,71 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Runs each registered job as its own periodic FreeRTOS task with an explicit
+// period, priority and core, and records how far each interval between runs
+// strayed from the period (jitter) and how long the job ran (worst-case
+// execution time).
+class TaskScheduler
+{
+public:
+    using TaskBody = std::function<void()>;
+
+    struct TaskConfig {
+        const char* name;
+        uint32_t periodMs;
+        UBaseType_t priority;
+        BaseType_t core;        // PRO_CPU_NUM, APP_CPU_NUM or tskNO_AFFINITY
+        uint32_t stackSize;
+    };
+
+    // Written only by the task itself; readers may see a run half-accounted
+    struct TaskStats {
+        uint32_t runs;
+        uint32_t overruns;      // Runs that took longer than the period
+        uint32_t lastJitterUs;
+        uint32_t maxJitterUs;
+        uint32_t lastExecUs;
+        uint32_t maxExecUs;     // Worst-case execution time
+        uint64_t totalJitterUs;
+        uint64_t totalExecUs;
+    };
+
+    static const uint8_t MAX_TASKS = 8;
+
+    // Register before start(); returns false when full or after start()
+    static bool add(const TaskConfig& config, TaskBody body);
+    static bool start();
+    static bool isStarted() { return _started; }
+
+    static uint8_t count() { return _count; }
+    static const TaskConfig& getConfig(uint8_t index) { return _tasks[index].config; }
+    static TaskStats getStats(uint8_t index) { return _tasks[index].stats; }
+    static void resetStats();
+    static String getStatsJson();
+
+#ifdef NATIVE_BUILD
+    // Host build only: forget every task once NativeTasks::stopAll() has joined them
+    static void reset();
+#endif
+
+private:
+    struct Task {
+        TaskConfig config;
+        TaskBody body;
+        TaskHandle_t handle;
+        volatile bool resetRequested;
+        TaskStats stats;
+    };
+
+    static Task _tasks[MAX_TASKS];
+    static uint8_t _count;
+    static bool _started;
+
+    static void taskEntry(void* arg);
+    static void record(Task& task, uint32_t jitterUs, uint32_t execUs);
+};
+
+#endif // TASK_SCHEDULER_H
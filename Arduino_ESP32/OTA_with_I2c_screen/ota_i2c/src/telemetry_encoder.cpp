@@ -0,0 +1,63 @@
+#include "telemetry_encoder.h"
+#include <ArduinoJson.h>
+
+static uint8_t* writeHeader(uint8_t* out, uint8_t type, uint16_t sequence) {
+    TelemetryEncoder::FrameHeader header = {type, TelemetryEncoder::PROTOCOL_VERSION, sequence};
+    memcpy(out, &header, sizeof(header));
+    return out + sizeof(header);
+}
+
+template<typename T>
+static uint8_t* writeField(uint8_t* out, const T& value) {
+    memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+template<typename T>
+static bool fieldChanged(const T& a, const T& b) {
+    return memcmp(&a, &b, sizeof(T)) != 0;
+}
+
+size_t TelemetryEncoder::encodeFull(const TelemetrySnapshot& snapshot, uint16_t sequence, uint8_t* out) {
+    FullFrame frame;
+    frame.header = {FRAME_FULL, PROTOCOL_VERSION, sequence};
+    frame.position = snapshot.position;
+    frame.speed = snapshot.speed;
+    frame.acceleration = snapshot.acceleration;
+    frame.flags = snapshot.flags;
+    frame.uptimeMs = snapshot.uptimeMs;
+    frame.rssi = snapshot.rssi;
+    frame.freeHeap = snapshot.freeHeap;
+    memcpy(out, &frame, sizeof(frame));
+    return sizeof(frame);
+}
+
+size_t TelemetryEncoder::encodeDelta(const TelemetrySnapshot& snapshot, const TelemetrySnapshot& previous,
+                                     uint16_t sequence, uint8_t* out) {
+    uint8_t* p = writeHeader(out, FRAME_DELTA, sequence);
+    uint8_t* mask = p++;
+    *mask = 0;
+
+    if (fieldChanged(snapshot.position, previous.position)) { *mask |= FIELD_POSITION; p = writeField(p, snapshot.position); }
+    if (fieldChanged(snapshot.speed, previous.speed)) { *mask |= FIELD_SPEED; p = writeField(p, snapshot.speed); }
+    if (fieldChanged(snapshot.acceleration, previous.acceleration)) { *mask |= FIELD_ACCELERATION; p = writeField(p, snapshot.acceleration); }
+    if (fieldChanged(snapshot.flags, previous.flags)) { *mask |= FIELD_FLAGS; p = writeField(p, snapshot.flags); }
+    if (fieldChanged(snapshot.uptimeMs, previous.uptimeMs)) { *mask |= FIELD_UPTIME; p = writeField(p, snapshot.uptimeMs); }
+    if (fieldChanged(snapshot.rssi, previous.rssi)) { *mask |= FIELD_RSSI; p = writeField(p, snapshot.rssi); }
+    if (fieldChanged(snapshot.freeHeap, previous.freeHeap)) { *mask |= FIELD_FREE_HEAP; p = writeField(p, snapshot.freeHeap); }
+
+    return p - out;
+}
+
+size_t TelemetryEncoder::encodeJson(const TelemetrySnapshot& snapshot, char* out, size_t size) {
+    StaticJsonDocument<256> doc;
+    doc["position"] = snapshot.position;
+    doc["speed"] = snapshot.speed;
+    doc["acceleration"] = snapshot.acceleration;
+    doc["isRunning"] = (snapshot.flags & FLAG_RUNNING) != 0;
+    doc["holdingTorque"] = (snapshot.flags & FLAG_HOLDING_TORQUE) != 0;
+    doc["uptime"] = snapshot.uptimeMs / 1000;
+    doc["rssi"] = snapshot.rssi;
+    doc["freeHeap"] = snapshot.freeHeap;
+    return serializeJson(doc, out, size);
+}
@@ -0,0 +1,72 @@
+#ifndef TELEMETRY_ENCODER_H
+#define TELEMETRY_ENCODER_H
+
+#include <Arduino.h>
+
+// Snapshot of everything published on /ws, captured once per telemetry tick
+struct TelemetrySnapshot {
+    int32_t position;
+    float speed;
+    float acceleration;
+    uint8_t flags;
+    uint32_t uptimeMs;
+    int8_t rssi;
+    uint32_t freeHeap;
+};
+
+// Encoders for the /ws status stream.
+//
+// Binary frames (WS_BINARY) start with a 4-byte header:
+//   uint8 type, uint8 version, uint16 sequence (little endian)
+// FRAME_FULL carries a FullFrame body. FRAME_DELTA carries a one-byte field
+// mask followed by only the changed fields, in FullFrame order and with the
+// same sizes. A delta always refers to the previous frame sent to the same
+// client; clients get a full frame on subscribe and every KEYFRAME_INTERVAL.
+class TelemetryEncoder {
+public:
+    static const uint8_t PROTOCOL_VERSION = 1;
+    static const uint8_t FRAME_FULL = 0x01;
+    static const uint8_t FRAME_DELTA = 0x02;
+    static const uint16_t KEYFRAME_INTERVAL = 64;
+
+    // TelemetrySnapshot::flags
+    static const uint8_t FLAG_RUNNING = 0x01;
+    static const uint8_t FLAG_HOLDING_TORQUE = 0x02;
+
+    // Delta field mask bits
+    static const uint8_t FIELD_POSITION = 0x01;
+    static const uint8_t FIELD_SPEED = 0x02;
+    static const uint8_t FIELD_ACCELERATION = 0x04;
+    static const uint8_t FIELD_FLAGS = 0x08;
+    static const uint8_t FIELD_UPTIME = 0x10;
+    static const uint8_t FIELD_RSSI = 0x20;
+    static const uint8_t FIELD_FREE_HEAP = 0x40;
+
+    struct __attribute__((packed)) FrameHeader {
+        uint8_t type;
+        uint8_t version;
+        uint16_t sequence;
+    };
+
+    struct __attribute__((packed)) FullFrame {
+        FrameHeader header;
+        int32_t position;
+        float speed;
+        float acceleration;
+        uint8_t flags;
+        uint32_t uptimeMs;
+        int8_t rssi;
+        uint32_t freeHeap;
+    };
+
+    static const size_t MAX_FRAME_SIZE = sizeof(FullFrame) + 1;
+    static const size_t MAX_JSON_SIZE = 256;
+
+    static size_t encodeFull(const TelemetrySnapshot& snapshot, uint16_t sequence, uint8_t* out);
+    static size_t encodeDelta(const TelemetrySnapshot& snapshot, const TelemetrySnapshot& previous,
+                              uint16_t sequence, uint8_t* out);
+    // Legacy text format; field names match the original broadcastStatus()
+    static size_t encodeJson(const TelemetrySnapshot& snapshot, char* out, size_t size);
+};
+
+#endif // TELEMETRY_ENCODER_H
@@ -0,0 +1,64 @@
+#include "velocity_estimator.h"
+
+bool VelocityEstimator::addSample(uint32_t timeUs, int32_t position) {
+    if (_count > 0) {
+        const Sample& newest = _samples[(_next + WINDOW - 1) % WINDOW];
+        if (timeUs - newest.timeUs < SAMPLE_INTERVAL_US) return false;
+    }
+    _samples[_next] = {timeUs, position};
+    _next = (_next + 1) % WINDOW;
+    if (_count < WINDOW) _count++;
+    fit();
+    return true;
+}
+
+void VelocityEstimator::reset() {
+    _next = 0;
+    _count = 0;
+    _speed = 0.0f;
+    _acceleration = 0.0f;
+}
+
+void VelocityEstimator::fit() {
+    // Time in ms and position in steps, both relative to the newest sample,
+    // keep the sums small enough for single-precision float (the ESP32 FPU)
+    const Sample& newest = _samples[(_next + WINDOW - 1) % WINDOW];
+    if (_count < 2) {
+        _speed = 0.0f;
+        _acceleration = 0.0f;
+        return;
+    }
+
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0;  // Sums of t^k
+    float p0 = 0, p1 = 0, p2 = 0;                  // Sums of p * t^k
+    for (uint8_t i = 0; i < _count; i++) {
+        const Sample& sample = _samples[(_next + WINDOW - 1 - i) % WINDOW];
+        float t = -(float)(newest.timeUs - sample.timeUs) / 1000.0f;
+        float p = (float)(sample.position - newest.position);
+        float t2 = t * t;
+        s0 += 1.0f;
+        s1 += t;
+        s2 += t2;
+        s3 += t2 * t;
+        s4 += t2 * t2;
+        p0 += p;
+        p1 += p * t;
+        p2 += p * t2;
+    }
+
+    if (_count < 3) {
+        // Two samples: a straight line
+        _speed = (s0 * p1 - s1 * p0) / (s0 * s2 - s1 * s1) * 1000.0f;
+        _acceleration = 0.0f;
+        return;
+    }
+
+    // p = c0 + c1 t + c2 t^2; Cramer's rule on the normal equations. Only c1
+    // (speed at t = 0) and c2 (half the acceleration) are needed.
+    float det = s0 * (s2 * s4 - s3 * s3) - s1 * (s1 * s4 - s3 * s2) + s2 * (s1 * s3 - s2 * s2);
+    if (det == 0.0f) return;
+    float c1 = (s0 * (p1 * s4 - s3 * p2) - p0 * (s1 * s4 - s3 * s2) + s2 * (s1 * p2 - p1 * s2)) / det;
+    float c2 = (s0 * (s2 * p2 - p1 * s3) - s1 * (s1 * p2 - p1 * s2) + p0 * (s1 * s3 - s2 * s2)) / det;
+    _speed = c1 * 1000.0f;
+    _acceleration = 2.0f * c2 * 1000000.0f;
+}
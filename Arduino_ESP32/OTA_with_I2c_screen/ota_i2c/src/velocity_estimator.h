@@ -0,0 +1,42 @@
+#ifndef VELOCITY_ESTIMATOR_H
+#define VELOCITY_ESTIMATOR_H
+
+#include <Arduino.h>
+
+// Speed and acceleration of the motor from a ring buffer of (timestamp,
+// position) samples. The position is the step count FastAccelStepper keeps
+// in its step interrupt, sampled at a fixed rate by the motion task. Each
+// sample refits a quadratic to the window by least squares, so speed and
+// acceleration are those at the newest sample rather than half a window ago.
+// The getters only return the last fit.
+// Not thread-safe: owned by the motion task, which publishes the results.
+class VelocityEstimator
+{
+public:
+    static const uint8_t WINDOW = 32;               // Samples in the fit
+    static const uint32_t SAMPLE_INTERVAL_US = 1000;
+
+    // Returns false (and ignores the sample) until SAMPLE_INTERVAL_US has passed
+    bool addSample(uint32_t timeUs, int32_t position);
+    void reset();
+
+    float speed() const { return _speed; }                // steps/s
+    float acceleration() const { return _acceleration; } // steps/s^2
+    uint8_t size() const { return _count; }
+
+private:
+    struct Sample {
+        uint32_t timeUs;
+        int32_t position;
+    };
+
+    Sample _samples[WINDOW];
+    uint8_t _next = 0;
+    uint8_t _count = 0;
+    float _speed = 0.0f;
+    float _acceleration = 0.0f;
+
+    void fit();
+};
+
+#endif // VELOCITY_ESTIMATOR_H
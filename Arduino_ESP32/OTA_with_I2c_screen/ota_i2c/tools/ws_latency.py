@@ -0,0 +1,109 @@
+"""Round-trip latency of stepper commands: REST POST vs. the /ws command channel.
+
+Usage: python tools/ws_latency.py <device-ip> [count]
+
+Sends `count` small relative moves both ways and prints min/median/p95/max.
+Uses only the standard library, so it runs anywhere Python 3 does.
+"""
+import base64
+import json
+import os
+import socket
+import statistics
+import struct
+import sys
+import time
+import urllib.parse
+import urllib.request
+
+
+class WebSocket:
+    def __init__(self, host, path="/ws", port=80):
+        self.sock = socket.create_connection((host, port), timeout=5)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall((
+            f"GET {path} HTTP/1.1\r\nHost: {host}\r\nUpgrade: websocket\r\n"
+            f"Connection: Upgrade\r\nSec-WebSocket-Key: {key}\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n").encode())
+        response = b""
+        while b"\r\n\r\n" not in response:
+            response += self.sock.recv(1024)
+        if b" 101 " not in response.split(b"\r\n")[0]:
+            raise RuntimeError("WebSocket upgrade failed: " + response.decode(errors="replace"))
+        self.buffer = response.split(b"\r\n\r\n", 1)[1]
+
+    def send_text(self, text):
+        payload = text.encode()
+        mask = os.urandom(4)
+        header = bytes([0x81])
+        if len(payload) < 126:
+            header += bytes([0x80 | len(payload)])
+        else:
+            header += bytes([0x80 | 126]) + struct.pack(">H", len(payload))
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.sock.sendall(header + mask + masked)
+
+    def _read(self, n):
+        while len(self.buffer) < n:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("socket closed")
+            self.buffer += chunk
+        data, self.buffer = self.buffer[:n], self.buffer[n:]
+        return data
+
+    def recv(self):
+        b0, b1 = self._read(2)
+        length = b1 & 0x7F
+        if length == 126:
+            length = struct.unpack(">H", self._read(2))[0]
+        elif length == 127:
+            length = struct.unpack(">Q", self._read(8))[0]
+        return b0 & 0x0F, self._read(length)
+
+    def wait_ack(self, request_id):
+        while True:
+            opcode, payload = self.recv()
+            if opcode != 0x1:
+                continue  # binary telemetry, pings
+            message = json.loads(payload)
+            if message.get("ack") == request_id:
+                return message
+
+
+def summarize(name, samples):
+    ms = sorted(s * 1000 for s in samples)
+    p95 = ms[min(len(ms) - 1, int(len(ms) * 0.95))]
+    print(f"{name:<24} min {ms[0]:7.2f}  median {statistics.median(ms):7.2f}  "
+          f"p95 {p95:7.2f}  max {ms[-1]:7.2f} ms")
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    host = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 100
+
+    rest = []
+    for i in range(count):
+        body = urllib.parse.urlencode({"position": i % 2 * 8}).encode()
+        start = time.perf_counter()
+        urllib.request.urlopen(f"http://{host}/stepper/move", data=body, timeout=5).read()
+        rest.append(time.perf_counter() - start)
+
+    ws = WebSocket(host)
+    websocket = []
+    for i in range(count):
+        start = time.perf_counter()
+        ws.send_text(json.dumps({"id": i + 1, "cmd": "move", "position": i % 2 * 8}))
+        ws.wait_ack(i + 1)
+        websocket.append(time.perf_counter() - start)
+
+    summarize("REST POST /stepper/move", rest)
+    summarize("WS move + ack", websocket)
+
+
+if __name__ == "__main__":
+    main()